@@ -0,0 +1,341 @@
+//=============================================================================
+// Code construction: reliabilities of the bit channels of polar codes
+// and frozen sets (info bit masks) for polar and SubRM codes.
+//
+// Copyright 2019 and onwards Kirill Shabunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=============================================================================
+
+#define CODE_DESIGN_C
+
+//-----------------------------------------------------------------------------
+// Includes.
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "std_defs.h"
+#include "code_design.h"
+
+//-----------------------------------------------------------------------------
+// Internal defines.
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Three-segment approximation of the phi function:
+// exp(GA_C2 * x^2 + GA_C1 * x) for x < GA_X0 (Chung's curve is far off
+// for the small means of the long codes),
+// exp(GA_A * x^GA_G + GA_B) for x < GA_X1 (Chung),
+// sqrt(pi / x) * exp(-x / 4) * (1 - 10 / (7 * x)) above.
+#define GA_C2 0.0564
+#define GA_C1 (-0.48560)
+#define GA_X0 0.867861
+#define GA_A (-0.4527)
+#define GA_B 0.0218
+#define GA_G 0.86
+#define GA_X1 10.0
+
+// # of bisection steps for the inverse of phi.
+#define GA_INV_STEPS 64
+
+//-----------------------------------------------------------------------------
+// Internal typedefs.
+
+typedef struct {
+   double r;
+   int i;
+} rel_item;
+
+typedef struct {
+   double lnpe; // ln of the error probability of the node.
+   int k; // Dimension of the node.
+   int i; // Index in the border node mask.
+} node_item;
+
+//-----------------------------------------------------------------------------
+// Global data.
+
+// For srm_design_mask().
+static int ntp;
+static node_item *nodes;
+
+// For polar_mc_errors().
+static double **lbuf;
+static double *errs;
+
+//-----------------------------------------------------------------------------
+// Internal functions.
+
+// ln(phi(x)), phi(x) = 1 - E[tanh(L / 2)] for L ~ N(x, 2x).
+static double ln_phi(double x) {
+   if (x <= 0.0) return 0.0;
+   if (x < GA_X0) return GA_C2 * x * x + GA_C1 * x;
+   if (x < GA_X1) return GA_A * pow(x, GA_G) + GA_B;
+   return 0.5 * log(M_PI / x) - x / 4.0 + log(1.0 - 10.0 / (7.0 * x));
+}
+
+// Inverse of ln_phi().
+static double ln_phi_inv(double y, double x_max) {
+   double lo, hi, mid;
+   int i;
+
+   if (y >= 0.0) return 0.0;
+   // The root of GA_C2 * x^2 + GA_C1 * x = y on the decreasing branch.
+   if (y > ln_phi(GA_X0)) return (-GA_C1 - sqrt(GA_C1 * GA_C1 + 4.0 * GA_C2 * y)) / (2.0 * GA_C2);
+   if (y >= ln_phi(GA_X1)) return pow((y - GA_B) / GA_A, 1.0 / GA_G);
+   lo = GA_X1;
+   hi = MAX(x_max, GA_X1);
+   for (i = 0; i < GA_INV_STEPS; i++) {
+      mid = 0.5 * (lo + hi);
+      if (ln_phi(mid) > y) lo = mid;
+      else hi = mid;
+   }
+   return 0.5 * (lo + hi);
+}
+
+// Mean LLR of y_1 xor y_2 for the mean x of both.
+static double ga_xor(double x) {
+   double lp = ln_phi(x);
+   double p = exp(lp);
+   // 1 - (1 - p)^2 = p * (2 - p).
+   return ln_phi_inv(lp + log(2.0 - p), x);
+}
+
+static void polar_ga_p(int m, double x, double *mean) {
+   int n2;
+
+   if (m == 0) {
+      mean[0] = x;
+      return;
+   }
+   n2 = 1 << (m - 1);
+   polar_ga_p(m - 1, ga_xor(x), mean);
+   polar_ga_p(m - 1, 2.0 * x, mean + n2);
+}
+
+// ln(e^a + e^b).
+static double ln_sum(double a, double b) {
+   if (a < b) return b + log1p(exp(a - b));
+   return a + log1p(exp(b - a));
+}
+
+// Border nodes of SubRM(r, m) in the order of calc_srm_k().
+static void srm_ga_p(int m, int r, double x) {
+   double *mean;
+   double s;
+   int n = 1 << m;
+   int i;
+
+   if (r == 0) {
+      // Repetition: the sum of n LLRs.
+      nodes[ntp].lnpe = ln_q_func(sqrt(n * x / 2.0));
+      nodes[ntp].k = 1;
+      nodes[ntp].i = ntp;
+      ntp++;
+      return;
+   }
+   if (m == r) {
+      // Union bound of the bits of the (m, m) node.
+      mean = (double *)malloc(n * sizeof(double));
+      if (mean == NULL) {
+         nodes[ntp].lnpe = 0.0;
+      }
+      else {
+         polar_ga_p(m, x, mean);
+         s = -HUGE_VAL;
+         for (i = 0; i < n; i++) s = ln_sum(s, ln_q_func(sqrt(mean[i] / 2.0)));
+         nodes[ntp].lnpe = s;
+         free(mean);
+      }
+      nodes[ntp].k = n;
+      nodes[ntp].i = ntp;
+      ntp++;
+      return;
+   }
+   srm_ga_p(m - 1, r - 1, ga_xor(x));
+   srm_ga_p(m - 1, r, 2.0 * x);
+}
+
+static int srm_border_node_num_p(int m, int r) {
+   if ((r == 0) || (m == r)) return 1;
+   return srm_border_node_num_p(m - 1, r - 1) + srm_border_node_num_p(m - 1, r);
+}
+
+// Descending reliability, the later bits first for the equal ones.
+static int rel_cmp(const void *a, const void *b) {
+   const rel_item *ra = (const rel_item *)a, *rb = (const rel_item *)b;
+   if (ra->r != rb->r) return (ra->r < rb->r) - (ra->r > rb->r);
+   return rb->i - ra->i;
+}
+
+static int node_cmp(const void *a, const void *b) {
+   const node_item *na = (const node_item *)a, *nb = (const node_item *)b;
+   if (na->lnpe != nb->lnpe) return (na->lnpe > nb->lnpe) - (na->lnpe < nb->lnpe);
+   return na->i - nb->i;
+}
+
+// y_1 xor y_2 in terms of LLRs (exact).
+static double llr_xor(double a, double b) {
+   double r = MIN(fabs(a), fabs(b));
+   if ((a < 0.0) != (b < 0.0)) r = -r;
+   return r + log1p(exp(-fabs(a + b))) - log1p(exp(-fabs(a - b)));
+}
+
+// Genie-aided SC for the all-zero codeword: all the decisions are 0,
+// so the u branch gets y_1 + y_2.
+static void polar_genie_p(int m, int offset) {
+   int n2 = (1 << m) / 2;
+   double *l1, *l2, *lc;
+   int j;
+
+   if (m == 0) {
+      if (lbuf[0][0] < 0.0) errs[offset] += 1.0;
+      else if (lbuf[0][0] == 0.0) errs[offset] += 0.5;
+      return;
+   }
+   l1 = lbuf[m];
+   l2 = l1 + n2;
+   lc = lbuf[m - 1];
+   for (j = 0; j < n2; j++) lc[j] = llr_xor(l1[j], l2[j]);
+   polar_genie_p(m - 1, offset);
+   for (j = 0; j < n2; j++) lc[j] = l1[j] + l2[j];
+   polar_genie_p(m - 1, offset + n2);
+}
+
+//-----------------------------------------------------------------------------
+// Functions.
+
+double design_sigma(double ebno_db, double rate) {
+   return 1.0 / sqrt(2.0 * rate * exp(log(10.0) * ebno_db / 10.0));
+}
+
+double ln_q_func(double x) {
+   // erfc() underflows at about x = 38.
+   if (x < 30.0) return log(0.5 * erfc(x / sqrt(2.0)));
+   return -x * x / 2.0 - log(x * sqrt(2.0 * M_PI));
+}
+
+void polar_ga_means(
+   int m,
+   double sg, // Noise sigma.
+   double *mean // 2^m items.
+)
+{
+   // LLR of the channel output is N(2 / sg^2, 4 / sg^2).
+   polar_ga_p(m, 2.0 / (sg * sg), mean);
+}
+
+int polar_mc_errors(
+   int m,
+   double sg, // Noise sigma.
+   int trials, // # of simulated words.
+   unsigned int seed, // Seed of the pseudorandom numbers generator.
+   double *pe // 2^m items.
+)
+{
+   int n = 1 << m;
+   uint8 *mem_buf;
+   double v1, v2, r;
+   int i, t;
+
+   mem_buf = (uint8 *)malloc((m + 1) * sizeof(double *) + 2 * n * sizeof(double));
+   if (mem_buf == NULL) return 1;
+   lbuf = (double **)mem_buf;
+   // A single buffer for all levels below the root: 2^i items for level i.
+   for (i = 0; i < m; i++) {
+      lbuf[i] = (double *)(mem_buf + (m + 1) * sizeof(double *)) + (1 << i) - 1;
+   }
+   lbuf[m] = (double *)(mem_buf + (m + 1) * sizeof(double *)) + n;
+   errs = pe;
+   memset(pe, 0, n * sizeof(double));
+
+   srand(seed);
+   for (t = 0; t < trials; t++) {
+      // 0 is sent as -1: LLR = 2 * (1 - noise) / sg^2.
+      for (i = 0; i < n; i += 2) {
+         do {
+            v1 = 2.0 * rand() / RAND_MAX - 1.0;
+            v2 = 2.0 * rand() / RAND_MAX - 1.0;
+            r = v1 * v1 + v2 * v2;
+         } while ((r >= 1.0) || (r == 0.0));
+         r = sqrt((-2.0 * log(r)) / r);
+         lbuf[m][i] = 2.0 * (1.0 - v1 * r * sg) / (sg * sg);
+         if (i + 1 < n) lbuf[m][i + 1] = 2.0 * (1.0 - v2 * r * sg) / (sg * sg);
+      }
+      polar_genie_p(m, 0);
+   }
+   for (i = 0; i < n; i++) pe[i] /= trials;
+
+   free(mem_buf);
+   return 0;
+}
+
+int polar_design_mask(
+   int m,
+   int k,
+   double *rel, // Reliabilities (2^m items).
+   uint32 *mask // Output mask (2^m items).
+)
+{
+   int n = 1 << m;
+   rel_item *ri;
+   int i;
+
+   ri = (rel_item *)malloc(n * sizeof(rel_item));
+   if (ri == NULL) return 1;
+   for (i = 0; i < n; i++) {
+      ri[i].r = rel[i];
+      ri[i].i = i;
+   }
+   qsort(ri, n, sizeof(rel_item), rel_cmp);
+   memset(mask, 0, n * sizeof(uint32));
+   for (i = 0; i < MIN(k, n); i++) mask[ri[i].i] = 1;
+
+   free(ri);
+   return 0;
+}
+
+int srm_border_node_num(int m, int r) {
+   return srm_border_node_num_p(m, r);
+}
+
+int srm_design_mask(
+   int m,
+   int r,
+   int k,
+   double sg, // Noise sigma.
+   uint32 *node_table // Output mask (srm_border_node_num() items).
+)
+{
+   int nn = srm_border_node_num(m, r);
+   int i, k1 = 0;
+
+   nodes = (node_item *)malloc(nn * sizeof(node_item));
+   if (nodes == NULL) return -1;
+   ntp = 0;
+   srm_ga_p(m, r, 2.0 / (sg * sg));
+
+   qsort(nodes, nn, sizeof(node_item), node_cmp);
+   memset(node_table, 0, nn * sizeof(uint32));
+   for (i = 0; i < nn; i++) {
+      if (k1 + nodes[i].k > k) continue;
+      node_table[nodes[i].i] = 1;
+      k1 += nodes[i].k;
+   }
+
+   free(nodes);
+   return k1;
+}
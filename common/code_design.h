@@ -0,0 +1,82 @@
+//=============================================================================
+// Code construction: reliabilities of the bit channels of polar codes
+// and frozen sets (info bit masks) for polar and SubRM codes.
+//
+// Copyright 2019 and onwards Kirill Shabunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=============================================================================
+
+#ifndef CODE_DESIGN_H
+#define CODE_DESIGN_H
+
+//-----------------------------------------------------------------------------
+// Includes.
+
+#include "typedefs.h"
+
+//-----------------------------------------------------------------------------
+// Prototypes.
+
+// Noise sigma for the given Eb/N0 (dB) and code rate (as in the simulators).
+double design_sigma(double ebno_db, double rate);
+
+// Natural log of the Gaussian Q function.
+double ln_q_func(double x);
+
+// Gaussian approximation (GA) of the density evolution for the polar code
+// of length 2^m, AWGN channel with BPSK.
+// mean[i] - mean LLR of the bit i in the decoding order (info_bits_mask order).
+void polar_ga_means(
+   int m,
+   double sg, // Noise sigma.
+   double *mean // 2^m items.
+);
+
+// Error probabilities of the bit channels of the polar code of length 2^m,
+// Monte-Carlo simulation of the genie-aided SC decoder.
+// pe[i] - error rate of the bit i in the decoding order.
+// Returns 0 or 1 if short of memory.
+int polar_mc_errors(
+   int m,
+   double sg, // Noise sigma.
+   int trials, // # of simulated words.
+   unsigned int seed, // Seed of the pseudorandom numbers generator.
+   double *pe // 2^m items.
+);
+
+// Info bits mask of the polar code: k bits with the largest rel[].
+// Returns 0 or 1 if short of memory.
+int polar_design_mask(
+   int m,
+   int k,
+   double *rel, // Reliabilities (2^m items).
+   uint32 *mask // Output mask (2^m items).
+);
+
+// # of border nodes of SubRM(r, m) code (border_node_mask length).
+int srm_border_node_num(int m, int r);
+
+// Border node mask of SubRM(r, m) tr0 code of dimension up to k, GA.
+// The nodes are added from the most reliable one while the dimension
+// doesn't exceed k.
+// Returns the code dimension or -1 if short of memory.
+int srm_design_mask(
+   int m,
+   int r,
+   int k,
+   double sg, // Noise sigma.
+   uint32 *node_table // Output mask (srm_border_node_num() items).
+);
+
+#endif // #ifndef CODE_DESIGN_H
@@ -16,7 +16,9 @@
 // limitations under the License.
 //=============================================================================
 
+#include <stdlib.h>
 #include <string.h>
+#include "crc.h"
 
 int *calc_crc(
   const int *x,
@@ -51,4 +53,145 @@ int is_valid_crc(
     s += x[info_len + j] ^ crc[j];
   }
   return (s == 0);
-}
\ No newline at end of file
+}
+//-----------------------------------------------------------------------------
+// Table-driven CRC engine.
+//
+// calc_crc() returns the remainder of x(z) / g(z), x[0] being the highest power.
+// For x = (h | t), where t is the last crc_len bits, it is
+// (h(z) * z^crc_len mod g(z)) xor t(z), and the first part is the usual
+// MSB-first CRC register fed with h.
+// The register is left-aligned in 64 bits, so any crc_len <= 64 is handled
+// the same way.
+
+#define CRC_BIT(ce, s, b) { \
+  uint64 top_ = ((s) >> 63) ^ (uint64)(b); \
+  (s) <<= 1; \
+  if (top_) (s) ^= (ce)->poly; \
+}
+
+#define CRC_STEP8(ce, s) (((s) << 8) ^ (ce)->tbl[0][(s) >> 56])
+
+#define CRC_SLICE8(ce, s) ( \
+  (ce)->tbl[7][(s) >> 56] ^ (ce)->tbl[6][((s) >> 48) & 255] ^ \
+  (ce)->tbl[5][((s) >> 40) & 255] ^ (ce)->tbl[4][((s) >> 32) & 255] ^ \
+  (ce)->tbl[3][((s) >> 24) & 255] ^ (ce)->tbl[2][((s) >> 16) & 255] ^ \
+  (ce)->tbl[1][((s) >> 8) & 255] ^ (ce)->tbl[0][(s) & 255])
+
+crc_engine *crc_engine_init(
+  const int *crc_poly,
+  int crc_len
+) {
+  crc_engine *ce;
+  uint64 v;
+  int i, j, k;
+
+  if ((crc_len < 1) || (crc_len > CRC_LEN_MAX)) return NULL;
+  ce = (crc_engine *)malloc(sizeof(crc_engine));
+  if (ce == NULL) return NULL;
+
+  ce->len = crc_len;
+  ce->poly = 0;
+  for (j = 0; j < crc_len; j++) {
+    if (crc_poly[j]) ce->poly |= (uint64)1 << (63 - j);
+  }
+
+  for (i = 0; i < 256; i++) {
+    v = (uint64)i << 56;
+    for (j = 0; j < 8; j++) CRC_BIT(ce, v, 0);
+    ce->tbl[0][i] = v;
+  }
+  for (k = 1; k < 8; k++) {
+    for (i = 0; i < 256; i++) {
+      v = ce->tbl[k - 1][i];
+      ce->tbl[k][i] = CRC_STEP8(ce, v);
+    }
+  }
+
+  return ce;
+}
+
+void crc_engine_free(crc_engine *ce) {
+  if (ce != NULL) free(ce);
+}
+
+void crc_pack_bits(
+  const int *x,
+  int x_len,
+  uint8 *bytes
+) {
+  int i;
+
+  memset(bytes, 0, (x_len + 7) / 8);
+  for (i = 0; i < x_len; i++) {
+    if (x[i]) bytes[i >> 3] |= 0x80 >> (i & 7);
+  }
+}
+
+uint64 crc_calc_packed(
+  const crc_engine *ce,
+  const uint8 *x,
+  int x_len
+) {
+  int h_len = x_len - ce->len;
+  int i = 0, j;
+  uint64 s = 0, w;
+
+  // Head: 8 bytes, then 1 byte, then 1 bit at a time.
+  for (; i + 64 <= h_len; i += 64) {
+    w = 0;
+    for (j = 0; j < 8; j++) w = (w << 8) | x[(i >> 3) + j];
+    s ^= w;
+    s = CRC_SLICE8(ce, s);
+  }
+  for (; i + 8 <= h_len; i += 8) {
+    s ^= (uint64)x[i >> 3] << 56;
+    s = CRC_STEP8(ce, s);
+  }
+  for (; i < h_len; i++) CRC_BIT(ce, s, (x[i >> 3] >> (7 - (i & 7))) & 1);
+
+  // Tail.
+  s >>= 64 - ce->len;
+  for (j = ce->len - 1; i < x_len; i++, j--) {
+    s ^= (uint64)((x[i >> 3] >> (7 - (i & 7))) & 1) << j;
+  }
+  return s;
+}
+
+uint64 crc_calc_bits(
+  const crc_engine *ce,
+  const int *x,
+  int x_len
+) {
+  int h_len = x_len - ce->len;
+  int i = 0, j;
+  uint64 s = 0, w;
+
+  for (; i + 64 <= h_len; i += 64) {
+    w = 0;
+    for (j = 0; j < 64; j++) w = (w << 1) | (x[i + j] != 0);
+    s ^= w;
+    s = CRC_SLICE8(ce, s);
+  }
+  for (; i < h_len; i++) CRC_BIT(ce, s, x[i] != 0);
+
+  s >>= 64 - ce->len;
+  for (j = ce->len - 1; i < x_len; i++, j--) {
+    s ^= (uint64)(x[i] != 0) << j;
+  }
+  return s;
+}
+
+int crc_check_bits(
+  const crc_engine *ce,
+  const int *x,
+  int info_len
+) {
+  uint64 s = crc_calc_bits(ce, x, info_len);
+  int j;
+
+  for (j = 0; j < ce->len; j++) {
+    s ^= (uint64)(x[info_len + j] != 0) << (ce->len - 1 - j);
+  }
+  return (s == 0);
+}
@@ -19,6 +19,18 @@
 #ifndef CRC_H
 #define CRC_H
 
+#include "typedefs.h"
+
+// Max CRC length for the table-driven engine.
+#define CRC_LEN_MAX 64
+
+// Table-driven CRC engine (slice-by-8) for a given polynomial.
+typedef struct {
+  int len; // CRC length.
+  uint64 poly; // Polynomial without leading 1, left-aligned in 64 bits.
+  uint64 tbl[8][256]; // tbl[k][b] - byte b followed by 8 * k zero bits, reduced.
+} crc_engine;
+
 /**
  * Lengths of crc_buf must be at least x_len.
  * CRC is calculated to crc_buf, starting at crc_buf + x_len - crc_len.
@@ -45,4 +57,56 @@ int is_valid_crc(
   int *buf
 );
 
+/**
+ * Creates the table-driven CRC engine for the polynomial given
+ * in the same way as for calc_crc(). crc_len must be 1..CRC_LEN_MAX.
+ * @return engine or NULL on error. Free it with crc_engine_free().
+ */
+crc_engine *crc_engine_init(
+  const int *crc_poly,
+  int crc_len
+);
+
+void crc_engine_free(crc_engine *ce);
+
+/**
+ * Packs bits x[0..x_len) to bytes, MSB first.
+ * Length of bytes must be at least (x_len + 7) / 8.
+ */
+void crc_pack_bits(
+  const int *x,
+  int x_len,
+  uint8 *bytes
+);
+
+/**
+ * The same CRC as calc_crc() calculates for x_len >= crc_len,
+ * x is x_len bits packed with crc_pack_bits().
+ * @return CRC, the first CRC bit is the most significant one (bit crc_len - 1).
+ */
+uint64 crc_calc_packed(
+  const crc_engine *ce,
+  const uint8 *x,
+  int x_len
+);
+
+/**
+ * The same as crc_calc_packed() for one bit per int.
+ */
+uint64 crc_calc_bits(
+  const crc_engine *ce,
+  const int *x,
+  int x_len
+);
+
+/**
+ * The same as is_valid_crc() with the engine (no buffer needed).
+ * @return 0|1
+ */
+int crc_check_bits(
+  const crc_engine *ce,
+  const int *x,
+  int info_len
+);
+
 #endif
\ No newline at end of file
@@ -50,6 +50,11 @@ char en_bl_token[] = "en_bl";
 char er_n_token[] = "erasures_num";
 char ml_tr_num_token[] = "ml_tr_num";
 char enml_bl_token[] = "enml_bl";
+char dec_time_token[] = "dec_time";
+char lsiz_sum_token[] = "lsiz_sum";
+char lsiz_max_token[] = "lsiz_max";
+char stage2_num_token[] = "stage2_num";
+char stage2_time_token[] = "stage2_time";
 
 //char _token[] = "";
 
@@ -88,7 +93,65 @@ strcpy_strip_comments(
    return dstr_len;
 }
 
+// Read the whole file to a new buffer with extra bytes at the end.
+// Return: the buffer or NULL.
+static char *
+read_file_str(
+   char fname[], // File name.
+   int extra_len, // # of extra bytes to allocate.
+   int *len // Out: file length.
+)
+{
+   FILE *fp;
+   char *str;
+   long fl;
+
+   if ((fp = fopen(fname, "rb")) == NULL) return NULL;
+   if ((fseek(fp, 0, SEEK_END) != 0) || ((fl = ftell(fp)) <= 0) || (fl > SP_STR_MAX)) {
+      fclose(fp);
+      return NULL;
+   }
+   rewind(fp);
+   str = (char *)malloc(fl + extra_len);
+   if (str == NULL) {
+      fclose(fp);
+      return NULL;
+   }
+   if (fread(str, 1, fl, fp) != (size_t)fl) {
+      free(str);
+      fclose(fp);
+      return NULL;
+   }
+   fclose(fp);
+   (*len) = (int)fl;
+   return str;
+}
+
+// Make sure that the string has room for add_len more characters.
+// Return: RC_OK/RC_ERROR.
+static int
+str_reserve(
+   char **str,
+   int *str_cap, // Allocated length.
+   int str_len, // Used length.
+   int add_len
+)
+{
+   char *s;
+   int cap;
+
+   if (str_len + add_len < (*str_cap)) return RC_OK;
+   cap = MAX(2 * (*str_cap), str_len + add_len + 1);
+   if (cap > SP_STR_MAX) return RC_ERROR;
+   s = (char *)realloc(*str, cap);
+   if (s == NULL) return RC_ERROR;
+   (*str) = s;
+   (*str_cap) = cap;
+   return RC_OK;
+}
+
 // Open, read and preparse simulation parameters file to sp_str.
+// The buffers grow with the included files, up to SP_STR_MAX bytes.
 // Return: RC_OK/RC_ERROR.
 int
 spf_read_preparse_ext(
@@ -99,46 +162,34 @@ spf_read_preparse_ext(
 {
    FILE *sp_file; // Simulation parameters file.
    char *sp_str, *str1, *str2, *token;
-   int sp_str_len, str2_len, i1;
+   int sp_str_len, sp_str_cap, str2_len, str2_cap, i1, tk_off, tk_len;
 
-   // Read simulation parameters file to str1.
+   // Read simulation parameters file to str2.
    if ((sp_file = fopen(spf_name, "rb")) == NULL) {
       if (try_flag != 1) err_msg("spf_read_preparse(): can't open file.");
       return RC_ERROR;
    }
-   str1 = (char *)malloc(SP_STR_MAX * 3);
-   if (str1 == NULL) {
-      err_msg("spf_read_preparse(): short of memory.");
-      fclose(sp_file);
-      return RC_ERROR;
-   }
-   str2 = str1 + SP_STR_MAX;
-   if ((i1 = fread(str1, 1, SP_STR_MAX, sp_file)) == 0) {
-      err_msg("spf_read_preparse(): can't read file.");
-      free(str1);
-      fclose(sp_file);
-      return RC_ERROR;
-   }
    fclose(sp_file);
-   if (i1 >= SP_STR_MAX) {
-      err_msg("spf_read_preparse(): file is too huge.");
-      free(str1);
+   str2 = read_file_str(spf_name, 1, &i1);
+   if (str2 == NULL) {
+      err_msg("spf_read_preparse(): can't read file.");
       return RC_ERROR;
    }
-   str1[i1] = 0;
+   str2_cap = i1 + 1;
 
-   // Allocate future sp_str.
-   sp_str = (char *)malloc(SP_STR_MAX);
+   // Allocate future sp_str (grows as needed).
+   sp_str_cap = 2 * i1 + 16;
+   sp_str = (char *)malloc(sp_str_cap);
    if (sp_str == NULL) {
       err_msg("spf_read_preparse(): short of memory!");
-      free(str1);
+      free(str2);
       return RC_ERROR;
    }
    sp_str_len = 0;
    sp_str[0] = 0;
 
-   // Remove comments from str1 and copy the result to str2.
-   str2_len = strcpy_strip_comments(str1, i1, 1, str2);
+   // Remove comments from str2 in place.
+   str2_len = strcpy_strip_comments(str2, i1, 1, str2);
 
    // ----- Preparse parameters.
 
@@ -148,61 +199,68 @@ spf_read_preparse_ext(
       // Includes.
       if (strcmp(token, include_token) == 0) {
          token = strtok(NULL, token_seps);
-         if ((sp_file = fopen(token, "rb")) == NULL) {
-            err_msg("spf_read_preparse(): can't open include file.");
-            free(sp_str);
-            free(str1);
-            return RC_ERROR;
-         }
-         if ((i1 = fread(str1, 1, SP_STR_MAX - 1, sp_file)) == 0) {
+         if (token == NULL) break;
+         str1 = read_file_str(token, 2, &i1);
+         if (str1 == NULL) {
             err_msg("spf_read_preparse(): can't read include file.");
-            fclose(sp_file);
             free(sp_str);
-            free(str1);
+            free(str2);
             return RC_ERROR;
          }
-         fclose(sp_file);
          str1[i1++] = ' ';
          str1[i1] = 0;
          i1 = strcpy_strip_comments(str1, i1, 1, str1);
-         if (i1 + str2_len >= SP_STR_MAX) {
+         // Insert the file instead of the include command.
+         tk_len = strlen(token);
+         tk_off = token - str2 + tk_len + 1;
+         if (tk_off > str2_len) {
+            // The include was the last token: no terminating 0 after it.
+            tk_off = str2_len;
+            str2[str2_len] = 0;
+         }
+         if (str_reserve(&str2, &str2_cap, str2_len, i1 + 1) != RC_OK) {
             err_msg("spf_read_preparse(): file is too huge.");
-            free(sp_str);
             free(str1);
+            free(sp_str);
+            free(str2);
             return RC_ERROR;
          }
-         // Insert the file instead of the include command.
-         memmove(token + strlen(token) + 1 + i1, token + strlen(token) + 1, str2_len + 1);
-         memcpy(token + strlen(token) + 1, str1, i1);
+         memmove(str2 + tk_off + i1, str2 + tk_off, str2_len - tk_off + 1);
+         memcpy(str2 + tk_off, str1, i1);
          str2_len += i1;
-         //str2_len += strcpy_strip_comments(str1, i1, str2 + str2_len);
-         token = strtok(NULL, token_seps);
+         free(str1);
+         token = strtok(str2 + tk_off, token_seps);
          continue;
       }
-      
+
+      tk_len = strlen(token);
+      if (str_reserve(&sp_str, &sp_str_cap, sp_str_len, tk_len + 4) != RC_OK) {
+         err_msg("spf_read_preparse(): file is too huge.");
+         free(sp_str);
+         free(str2);
+         return RC_ERROR;
+      }
+
       // Group begins.
       if (token[0] == GROUP_CHAR_BEGIN) {
          sp_str[sp_str_len++] = GROUP_CHAR_BEGIN;
          sp_str[sp_str_len++] = TOKEN_SEP_CHAR;
-         sp_str[sp_str_len] = 0;
-         if (strlen(token) > 1) {
-            strcat(sp_str, token + 1);
-            sp_str_len += strlen(token) - 1;
+         if (tk_len > 1) {
+            memcpy(sp_str + sp_str_len, token + 1, tk_len - 1);
+            sp_str_len += tk_len - 1;
             sp_str[sp_str_len++] = TOKEN_SEP_CHAR;
-            sp_str[sp_str_len] = 0;
          }
+         sp_str[sp_str_len] = 0;
          token = strtok(NULL, token_seps);
          continue;
       }
 
       // Group ends.
-      if (token[strlen(token) - 1] == GROUP_CHAR_END) {
-         if (strlen(token) > 1) {
-            token[strlen(token) - 1] = 0;
-            strcat(sp_str, token);
-            sp_str_len += strlen(token);
+      if (token[tk_len - 1] == GROUP_CHAR_END) {
+         if (tk_len > 1) {
+            memcpy(sp_str + sp_str_len, token, tk_len - 1);
+            sp_str_len += tk_len - 1;
             sp_str[sp_str_len++] = TOKEN_SEP_CHAR;
-            sp_str[sp_str_len] = 0;
          }
          sp_str[sp_str_len++] = GROUP_CHAR_END;
          sp_str[sp_str_len++] = TOKEN_SEP_CHAR;
@@ -212,15 +270,15 @@ spf_read_preparse_ext(
       }
 
       // All other tokens.
-      strcat(sp_str, token);
-      sp_str_len += strlen(token);
+      memcpy(sp_str + sp_str_len, token, tk_len);
+      sp_str_len += tk_len;
       sp_str[sp_str_len++] = TOKEN_SEP_CHAR;
       sp_str[sp_str_len] = 0;
-      
+
       token = strtok(NULL, token_seps);
    }
 
-   free(str1);
+   free(str2);
    (*out_str) = sp_str;
 
    return RC_OK;
@@ -274,3 +332,34 @@ int tryread_group_int_param(
   return RC_SPF_UNKNOWN;
 }
 
+int tryread_group_double_param(
+  char **inout_tk,
+  char *param_key,
+  double *x,
+  size_t step_size,
+  int *n,
+  int max_n,
+  char *erstr
+) {
+  if (strcmp(*inout_tk, param_key) == 0) {
+    int i = 0;
+    char *tk = strtok(NULL, tk_seps_prepared);
+    if (tk[0] == GROUP_CHAR_BEGIN) {
+      tk = strtok(NULL, tk_seps_prepared);
+      while ((tk[0] != GROUP_CHAR_END) && (i < max_n)) {
+        *x = atof(tk);
+        x = (double *)((unsigned char *)x + step_size);
+        tk = strtok(NULL, tk_seps_prepared);
+        i++;
+      }
+    }
+    else {
+      err_msg(erstr);
+      return RC_ERROR;
+    }
+    *n = i;
+    *inout_tk = strtok(NULL, tk_seps_prepared);
+    return RC_OK;
+  }
+  return RC_SPF_UNKNOWN;
+}
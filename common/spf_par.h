@@ -31,7 +31,7 @@
 //-----------------------------------------------------------------------------
 // Defines
 
-#define SP_STR_MAX         140000 // Max length of params file (with includes).
+#define SP_STR_MAX         (1 << 28) // Max length of params file (with includes).
 #define LF_CHAR            10    // LF character.
 #define COMMENT_CHAR       '%'   // Comment starts from this character.
 #define GROUP_CHAR_BEGIN   '{'   // Group starts from this character.
@@ -150,6 +150,11 @@ extern char en_bl_token[];
 extern char er_n_token[];
 extern char ml_tr_num_token[];
 extern char enml_bl_token[];
+extern char dec_time_token[];
+extern char lsiz_sum_token[];
+extern char lsiz_max_token[];
+extern char stage2_num_token[];
+extern char stage2_time_token[];
 
 #endif // #ifndef SPF_PAR_C
 
@@ -203,4 +208,18 @@ int tryread_group_int_param(
   char *erstr
 );
 
+/**
+ * Try to read a group double parameter.
+ * @return RC_OK / RC_SPF_UNKNOWN / RC_ERROR
+ */
+int tryread_group_double_param(
+  char **inout_tk,
+  char *param_key,
+  double *x, // output array
+  size_t step_size, // x step size (e.g. sizeof(double) for a plain double array)
+  int *n, // number of read items
+  int max_n,
+  char *erstr
+);
+
 #endif // #ifndef SPF_PAR_H
\ No newline at end of file
@@ -34,7 +34,7 @@ int calc_rm_k(int m, int r);
 
 // Encode (m, m) code (for BSC).
 // (Or decode, since the inverse matrix is the same.)
-// Modified generator matrix.
+// Modified generator matrix. x and y may be the same vector.
 int mrm_enc_mm_bsc(
    int m,
    int *x, // Information vector.
@@ -35,6 +35,9 @@
 #define RC_ERROR (-1)
 #define RC_CUSTOM 16
 
+// Max code length is 2^CODE_M_MAX.
+#define CODE_M_MAX 20
+
 // Memory
 #define CHK_FREE(p) {if ((p) != NULL) { free(p); (p) = NULL; }}
 
@@ -42,6 +45,13 @@
 #define MAX(a, b) (((a) > (b)) ? (a) : (b))
 #define MIN(a, b) (((a) < (b)) ? (a) : (b))
 
+// Storage class for decoder state that may be used by several threads at once.
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL _Thread_local
+#endif
+
 // Float / double
 #define FLOAT_EPS 1e-10
 #define FLOAT_EPS2ONE (1.0 - FLOAT_EPS)
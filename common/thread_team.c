@@ -0,0 +1,196 @@
+//=============================================================================
+// Team of threads for the per-path loops of the list decoders.
+//
+// Copyright 2019 and onwards Kirill Shabunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Includes.
+
+#include <stdlib.h>
+#include <string.h>
+#include "std_defs.h"
+#include "thread_team.h"
+
+//-----------------------------------------------------------------------------
+// Internal typedefs.
+
+#ifdef USE_PTHREADS
+typedef struct {
+   thread_team *tm;
+   int t; // Thread index (range of the job).
+} team_member;
+#endif
+
+//-----------------------------------------------------------------------------
+// Internal functions.
+
+#ifdef USE_PTHREADS
+static int bar_init(team_barrier *b, int n) {
+   b->n = n;
+   b->waiting = 0;
+   b->gen = 0;
+   if (pthread_mutex_init(&(b->mx), NULL) != 0) return RC_ERROR;
+   if (pthread_cond_init(&(b->cv), NULL) != 0) {
+      pthread_mutex_destroy(&(b->mx));
+      return RC_ERROR;
+   }
+   return RC_OK;
+}
+
+static void bar_destroy(team_barrier *b) {
+   pthread_cond_destroy(&(b->cv));
+   pthread_mutex_destroy(&(b->mx));
+}
+
+// Release the waiting threads if all n are there.
+static void bar_check(team_barrier *b) {
+   if (b->waiting < b->n) return;
+   b->waiting = 0;
+   b->gen++;
+   pthread_cond_broadcast(&(b->cv));
+}
+
+static void bar_wait(team_barrier *b) {
+   unsigned gen;
+
+   pthread_mutex_lock(&(b->mx));
+   gen = b->gen;
+   b->waiting++;
+   bar_check(b);
+   while (gen == b->gen) pthread_cond_wait(&(b->cv), &(b->mx));
+   pthread_mutex_unlock(&(b->mx));
+}
+
+// Wait for n threads from now on.
+static void bar_resize(team_barrier *b, int n) {
+   pthread_mutex_lock(&(b->mx));
+   b->n = n;
+   bar_check(b);
+   pthread_mutex_unlock(&(b->mx));
+}
+#endif
+
+// Range t of the job.
+static void run_range(thread_team *tm, int t) {
+   int i0 = (int)((long)tm->len * t / tm->thr_num);
+   int i1 = (int)((long)tm->len * (t + 1) / tm->thr_num);
+
+   if (i1 > i0) tm->job(tm->arg, i0, i1);
+}
+
+#ifdef USE_PTHREADS
+static void *team_thread(void *arg) {
+   team_member mb = *(team_member *)arg;
+
+   free(arg);
+   for (;;) {
+      bar_wait(&(mb.tm->bar_start));
+      if (mb.tm->quit) break;
+      run_range(mb.tm, mb.t);
+      bar_wait(&(mb.tm->bar_done));
+   }
+   return NULL;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// Functions.
+
+thread_team *team_init(int thr_num) {
+   thread_team *tm;
+#ifdef USE_PTHREADS
+   team_member *mb;
+   int t;
+#endif
+
+   if ((thr_num < 1) || (thr_num > TEAM_THR_MAX)) return NULL;
+#ifndef USE_PTHREADS
+   if (thr_num > 1) return NULL;
+#endif
+
+   tm = (thread_team *)malloc(sizeof(thread_team));
+   if (tm == NULL) return NULL;
+   memset(tm, 0, sizeof(thread_team));
+   tm->thr_num = thr_num;
+   if (thr_num == 1) return tm;
+
+#ifdef USE_PTHREADS
+   if (bar_init(&(tm->bar_start), thr_num) != RC_OK) {
+      free(tm);
+      return NULL;
+   }
+   if (bar_init(&(tm->bar_done), thr_num) != RC_OK) {
+      bar_destroy(&(tm->bar_start));
+      free(tm);
+      return NULL;
+   }
+   for (t = 1; t < thr_num; t++) {
+      mb = (team_member *)malloc(sizeof(team_member));
+      if (mb != NULL) {
+         mb->tm = tm;
+         mb->t = t;
+         if (pthread_create(&(tm->thr[t]), NULL, team_thread, mb) == 0) continue;
+         free(mb);
+      }
+      // Stop the t - 1 threads started so far.
+      if (t > 1) {
+         tm->thr_num = t;
+         bar_resize(&(tm->bar_start), t);
+         team_close(tm);
+         return NULL;
+      }
+      bar_destroy(&(tm->bar_start));
+      bar_destroy(&(tm->bar_done));
+      free(tm);
+      return NULL;
+   }
+#endif
+
+   return tm;
+}
+
+void team_close(thread_team *tm) {
+#ifdef USE_PTHREADS
+   int t;
+#endif
+
+   if (tm == NULL) return;
+#ifdef USE_PTHREADS
+   if (tm->thr_num > 1) {
+      tm->quit = 1;
+      bar_wait(&(tm->bar_start));
+      for (t = 1; t < tm->thr_num; t++) pthread_join(tm->thr[t], NULL);
+      bar_destroy(&(tm->bar_start));
+      bar_destroy(&(tm->bar_done));
+   }
+#endif
+   free(tm);
+}
+
+void team_run(thread_team *tm, team_job_fn job, void *arg, int len, long work) {
+   if ((tm == NULL) || (tm->thr_num == 1) || (work < TEAM_MIN_WORK) || (len < 2)) {
+      job(arg, 0, len);
+      return;
+   }
+#ifdef USE_PTHREADS
+   tm->job = job;
+   tm->arg = arg;
+   tm->len = len;
+   bar_wait(&(tm->bar_start));
+   run_range(tm, 0);
+   bar_wait(&(tm->bar_done));
+#endif
+}
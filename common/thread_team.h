@@ -0,0 +1,87 @@
+//=============================================================================
+// Team of threads for the per-path loops of the list decoders.
+// The threads are created once and wait on a barrier for the next job.
+// A job is a loop over [0, len) split into a range per thread, the calling
+// thread takes the first range. Needs USE_PTHREADS for more than 1 thread.
+//
+// Copyright 2019 and onwards Kirill Shabunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=============================================================================
+
+#ifndef THREAD_TEAM_H
+#define THREAD_TEAM_H
+
+//-----------------------------------------------------------------------------
+// Includes.
+
+#ifdef USE_PTHREADS
+#include <pthread.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Defines.
+
+// Max # of threads in a team.
+#define TEAM_THR_MAX 64
+
+// Jobs with less work (items, e.g. LLRs over all paths) are run by the calling
+// thread alone: two barriers cost about as much.
+#define TEAM_MIN_WORK 4096
+
+//-----------------------------------------------------------------------------
+// Typedefs.
+
+// Job: items [i0, i1) of the loop.
+typedef void (*team_job_fn)(void *arg, int i0, int i1);
+
+#ifdef USE_PTHREADS
+// Barrier (pthread_barrier_t is optional in POSIX and can't be shrunk).
+typedef struct {
+   pthread_mutex_t mx;
+   pthread_cond_t cv;
+   int n; // # of threads to wait for.
+   int waiting; // # of threads waiting.
+   unsigned gen; // Incremented when the threads are released.
+} team_barrier;
+#endif
+
+typedef struct thread_team {
+   int thr_num; // # of threads including the calling one.
+   team_job_fn job; // Current job.
+   void *arg; // ... its argument.
+   int len; // ... and length.
+   int quit; // 1 - the threads exit.
+#ifdef USE_PTHREADS
+   pthread_t thr[TEAM_THR_MAX];
+   team_barrier bar_start; // The job is set.
+   team_barrier bar_done; // All the ranges are done.
+#endif
+} thread_team;
+
+//-----------------------------------------------------------------------------
+// Prototypes.
+
+// Start the team of thr_num threads (the calling one and thr_num - 1 new ones).
+// Returns NULL on error.
+thread_team *team_init(int thr_num);
+
+// Stop the threads and free the team.
+void team_close(thread_team *tm);
+
+// Run job(arg, i0, i1) over [0, len) and wait for all the threads.
+// work - total amount of work, with less than TEAM_MIN_WORK (or tm == NULL)
+// the job is run by the calling thread only.
+void team_run(thread_team *tm, team_job_fn job, void *arg, int len, long work);
+
+#endif // #ifndef THREAD_TEAM_H
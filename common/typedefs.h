@@ -49,4 +49,7 @@ typedef unsigned long uint32;
 #error Unable to define unsigned 32 bit. Redefine int32 type in typedefs.h
 #endif
 
+typedef int64_t int64;
+typedef uint64_t uint64;
+
 #endif // #ifndef TYPEDEFS_H
\ No newline at end of file
@@ -0,0 +1,245 @@
+//=============================================================================
+// Code design tool: info bits masks of polar codes and border node masks
+// of SubRM codes for the given dimension and design Eb/N0.
+// The output is a code file for the simulation parameters files.
+//
+// Copyright 2019 and onwards Kirill Shabunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Includes.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "../common/std_defs.h"
+#include "../common/spf_par.h"
+#include "../common/code_design.h"
+#include "../common/srm_utils.h"
+#include "../interfaces/ui_utils.h"
+
+//-----------------------------------------------------------------------------
+// Internal defines.
+
+#define DESIGN_M_MAX 24
+#define DEFAULT_MC_TRIALS 10000
+#define FN_LEN_MAX 1000
+
+//-----------------------------------------------------------------------------
+// Internal typedefs.
+
+typedef struct {
+   int srm; // 1 - SubRM code, 0 - polar code.
+   int c_m;
+   int c_r;
+   int c_k;
+   double ebno; // Design Eb/N0, dB.
+   int use_mc; // 1 - Monte-Carlo, 0 - GA.
+   int mc_trials;
+   char out_file[FN_LEN_MAX];
+} design_params;
+
+//-----------------------------------------------------------------------------
+// Functions.
+
+static int read_params(char spf_name[], design_params *dp) {
+   char *sp_str, *token;
+
+   if (spf_read_preparse(spf_name, &sp_str) != RC_OK) return RC_ERROR;
+
+   token = strtok(sp_str, tk_seps_prepared);
+   while (token != NULL) {
+      if (strcmp(token, "design_code") == 0) {
+         token = strtok(NULL, tk_seps_prepared);
+         dp->srm = (strcmp(token, "srm") == 0);
+         token = strtok(NULL, tk_seps_prepared);
+         continue;
+      }
+      if (strcmp(token, "design_method") == 0) {
+         token = strtok(NULL, tk_seps_prepared);
+         dp->use_mc = (strcmp(token, "mc") == 0);
+         token = strtok(NULL, tk_seps_prepared);
+         continue;
+      }
+      if (strcmp(token, "out_file") == 0) {
+         token = strtok(NULL, tk_seps_prepared);
+         if (strlen(token) >= FN_LEN_MAX) {
+            err_msg("code_design: output file name is too long.");
+            return RC_ERROR;
+         }
+         strcpy(dp->out_file, token);
+         token = strtok(NULL, tk_seps_prepared);
+         continue;
+      }
+      TRYGET_INT_TOKEN(token, "c_m", dp->c_m);
+      TRYGET_INT_TOKEN(token, "RM_m", dp->c_m);
+      TRYGET_INT_TOKEN(token, "RM_r", dp->c_r);
+      TRYGET_INT_TOKEN(token, "code_k", dp->c_k);
+      TRYGET_FLOAT_TOKEN(token, "design_EbNo", dp->ebno);
+      TRYGET_INT_TOKEN(token, "mc_trials", dp->mc_trials);
+      SPF_SKIP_UNKNOWN_PARAMETER(token);
+   }
+   free(sp_str);
+
+   if ((dp->c_m < 1) || (dp->c_m > DESIGN_M_MAX)) {
+      err_msg("code_design: c_m (RM_m) is out of range.");
+      return RC_ERROR;
+   }
+   if (dp->srm && ((dp->c_r < 1) || (dp->c_r > dp->c_m))) {
+      err_msg("code_design: RM_r is out of range.");
+      return RC_ERROR;
+   }
+   if ((dp->c_k < 1) || (dp->c_k > (1 << dp->c_m))) {
+      err_msg("code_design: code_k is out of range.");
+      return RC_ERROR;
+   }
+   if (dp->mc_trials < 1) {
+      err_msg("code_design: mc_trials must be positive.");
+      return RC_ERROR;
+   }
+   if (dp->out_file[0] == 0) {
+      err_msg("code_design: out_file is not specified.");
+      return RC_ERROR;
+   }
+   return RC_OK;
+}
+
+static void print_mask(FILE *fp, char name[], uint32 *mask, int len) {
+   int i;
+
+   fprintf(fp, "%s ", name);
+   for (i = 0; i < len; i++) fprintf(fp, "%d", mask[i] ? 1 : 0);
+   fprintf(fp, "\n");
+}
+
+// Polar code: k most reliable bit channels.
+static int design_polar(design_params *dp, FILE *fp) {
+   int n = 1 << dp->c_m;
+   double sg = design_sigma(dp->ebno, (double)dp->c_k / n);
+   double *mean, *rel, pe;
+   uint32 *mask;
+   int i, rc = RC_ERROR;
+
+   mean = (double *)malloc(n * sizeof(double));
+   rel = (double *)malloc(n * sizeof(double));
+   mask = (uint32 *)malloc(n * sizeof(uint32));
+   if ((mean == NULL) || (rel == NULL) || (mask == NULL)) {
+      err_msg("code_design: Short of memory.");
+      goto ret;
+   }
+
+   polar_ga_means(dp->c_m, sg, mean);
+   if (dp->use_mc) {
+      if (polar_mc_errors(dp->c_m, sg, dp->mc_trials, (unsigned int)time(NULL), rel)) {
+         err_msg("code_design: Short of memory.");
+         goto ret;
+      }
+      // Lower error rate first, GA for the ties (e.g. no errors at all).
+      for (i = 0; i < n; i++) rel[i] = -rel[i] * dp->mc_trials + atan(mean[i]) / M_PI;
+   }
+   else {
+      memcpy(rel, mean, n * sizeof(double));
+   }
+   if (polar_design_mask(dp->c_m, dp->c_k, rel, mask)) {
+      err_msg("code_design: Short of memory.");
+      goto ret;
+   }
+
+   // Union bound of the block error probability under SC by GA.
+   pe = 0.0;
+   for (i = 0; i < n; i++) {
+      if (mask[i]) pe += exp(ln_q_func(sqrt(mean[i] / 2.0)));
+   }
+
+   fprintf(fp, "%% code_name \"Polar m = %d, k = %d, %s %.2f dB\"\n\n",
+      dp->c_m, dp->c_k, dp->use_mc ? "MC" : "GA", dp->ebno);
+   fprintf(fp, "c_m %d\n\n", dp->c_m);
+   fprintf(fp, "%% GA estimate of SC block error rate: %.3e\n", pe);
+   print_mask(fp, "info_bits_mask", mask, n);
+   rc = RC_OK;
+
+ret:
+   if (mean != NULL) free(mean);
+   if (rel != NULL) free(rel);
+   if (mask != NULL) free(mask);
+   return rc;
+}
+
+// SubRM code: the most reliable border nodes.
+static int design_srm(design_params *dp, FILE *fp) {
+   int nn = srm_border_node_num(dp->c_m, dp->c_r);
+   double sg;
+   uint32 *mask;
+   int k;
+
+   if (dp->c_k > calc_rm_k(dp->c_m, dp->c_r)) {
+      err_msg("code_design: code_k is larger than the dimension of RM code.");
+      return RC_ERROR;
+   }
+   mask = (uint32 *)malloc(nn * sizeof(uint32));
+   if (mask == NULL) {
+      err_msg("code_design: Short of memory.");
+      return RC_ERROR;
+   }
+   sg = design_sigma(dp->ebno, (double)dp->c_k / (1 << dp->c_m));
+   k = srm_design_mask(dp->c_m, dp->c_r, dp->c_k, sg, mask);
+   if (k < 0) {
+      err_msg("code_design: Short of memory.");
+      free(mask);
+      return RC_ERROR;
+   }
+
+   fprintf(fp, "%% code_name \"SubRM(%d, %d), k = %d, GA %.2f dB\"\n\n",
+      dp->c_r, dp->c_m, k, dp->ebno);
+   fprintf(fp, "RM_m %d\nRM_r %d\n\n", dp->c_m, dp->c_r);
+   fprintf(fp, "%% For dtrm_glp codec.\n");
+   print_mask(fp, "border_node_mask", mask, nn);
+   if (k != dp->c_k) msg_printf("Note: the closest dimension is %d.\n", k);
+
+   free(mask);
+   return RC_OK;
+}
+
+int main(int argc, char **argv) {
+   design_params dp;
+   FILE *fp;
+   clock_t start;
+   int rc;
+
+   if (argc < 2) {
+      msg_printf("Usage : %s <design_parameters_file>\n", argv[0]);
+      return RC_ERROR;
+   }
+
+   memset(&dp, 0, sizeof(design_params));
+   dp.mc_trials = DEFAULT_MC_TRIALS;
+   if (read_params(argv[1], &dp) != RC_OK) return RC_ERROR;
+
+   fp = fopen(dp.out_file, "wt");
+   if (fp == NULL) {
+      err_msg("code_design: cannot open the output file.");
+      return RC_ERROR;
+   }
+   start = clock();
+   rc = dp.srm ? design_srm(&dp, fp) : design_polar(&dp, fp);
+   fclose(fp);
+   if (rc == RC_OK) {
+      msg_printf("Done in %.3f s.\n", (double)(clock() - start) / CLOCKS_PER_SEC);
+   }
+
+   return rc;
+}
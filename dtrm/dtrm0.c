@@ -2,7 +2,8 @@
 // dtrm0
 // Recursive decoding on triangle down to (0, m) and (m, m).
 // Needs channel sigma (define global DEC_NEEDS_SIGMA).
-// Parameters: RM_m, RM_r
+// Parameters: RM_m, RM_r, batch_size
+// dec_bpsk_batch() decodes batch_size words at once (define global DEC_HAS_BATCH).
 //
 // Copyright 1999 and onwards Kirill Shabunov
 //
@@ -25,6 +26,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "../common/typedefs.h"
+#include "../common/std_defs.h"
 #include "../interfaces/codec.h"
 #include "../common/spf_par.h"
 #include "../interfaces/ui_utils.h"
@@ -37,9 +39,30 @@
 // Max # of SNR values.
 #define VARL_NUM_MAX        50
 
+// Max # of words decoded at once by dec_bpsk_batch().
+#define BATCH_SIZE_MAX 64
+
+// Schedule operations.
+#define OP_XOR 0 // Input of v: y1 xor y2.
+#define OP_ADD 1 // Input of u: (y1 xor v) + y2.
+#define OP_COMB 2 // Decisions of the node: [v xor u, u].
+#define OP_REP 3 // (0, m) leaf.
+#define OP_MM 4 // (m, m) leaf.
+
 //-----------------------------------------------------------------------------
 // Internal typedefs.
 
+// Offsets are in items per word: the item i of word f of a buffer at
+// offset o is ws[(o + i) * nb + f] for nb words decoded at once.
+typedef struct {
+   int op; // OP_*.
+   int m; // The node is of length 2^m.
+   int in; // Input of the node.
+   int aux; // Free space of the node (2^m items), the input of its children.
+   int yd; // Decisions of the node.
+   int x; // First info bit of the node.
+} sched_op;
+
 typedef struct {
    int c_n; // Code length.
    int c_k; // Code dimension.
@@ -47,6 +70,11 @@ typedef struct {
    int c_r; // RM r.
    int csnrn;
    double sg22; // 2 / sg^2 for calculation of epsilons.
+   int batch; // # of words decoded at once by dec_bpsk_batch().
+   sched_op *sched; // Decoding schedule.
+   int sched_len;
+   double *ws; // Workspace: input, decisions and aux (c_n items each) of batch words.
+   int *xw; // Interleaved info bits of batch words.
 } cdc_inst_type;
 
 
@@ -56,87 +84,123 @@ typedef struct {
 //-----------------------------------------------------------------------------
 // Internal functions.
 
-int
-tri0_dec(
-   double *y_in,
+// Schedule of the recursive decoding of RM(r, m) down to (0, m) and (m, m)
+// in the execution order. Returns the # of operations (only counts them
+// if sc == NULL).
+static int sched_build(
+   sched_op *sc,
+   int len,
    int r,
    int m,
-   int n,
-   double *y_dec,
-   int *x_dec,
-   int *x_dec_len,
-   double *aux_buf
+   int in,
+   int aux,
+   int yd,
+   int x
 )
 {
-   int i, n2, cur_x_dec_len;
-   double p1, p2;
-   double *y1, *y2, *y_dec1, *y_dec2;
-
-   // RM(0, m) case.
-   if (r == 0) {
-      (*x_dec_len) = 1; // one information bit.
-      p1 = 0.0;
-      for (i = 0; i < n; i++) {
-         p1 += EST2LLR(y_in[i]);
-      }
-      if (p1 > 0.0) {
-         x_dec[0] = 0;
-         for (i = 0; i < n; i++) y_dec[i] = YLDEC0;
-      }
-      else {
-         x_dec[0] = 1;
-         for (i = 0; i < n; i++) y_dec[i] = YLDEC1;
-      }
-      return 0;
+   int n2 = (1 << m) / 2;
+   sched_op op;
+
+   op.m = m;
+   op.in = in;
+   op.aux = aux;
+   op.yd = yd;
+   op.x = x;
+
+   if ((r == 0) || (r == m)) {
+      op.op = (r == 0) ? OP_REP : OP_MM;
+      if (sc != NULL) sc[len] = op;
+      return len + 1;
    }
 
-   // RM(m, m) case.
-   if (r == m) {
-      int tmp[1024];
-      (*x_dec_len) = n; // n information bits.
-      for (i = 0; i < n; i++) {
-         if (CHECK_EST0(y_in[i])) {
-            tmp[i] = 0;
-            y_dec[i] = YLDEC0;
+   op.op = OP_XOR;
+   if (sc != NULL) sc[len] = op;
+   len++;
+   len = sched_build(sc, len, r - 1, m - 1, aux, aux + n2, yd, x);
+   op.op = OP_ADD;
+   if (sc != NULL) sc[len] = op;
+   len++;
+   len = sched_build(sc, len, r, m - 1, aux, aux + n2, yd + n2, x + calc_rm_k(m - 1, r - 1));
+   op.op = OP_COMB;
+   if (sc != NULL) sc[len] = op;
+   return len + 1;
+}
+
+// Decoding of nb interleaved words, the input is ws[0..c_n * nb) in the format,
+// the info bits go to xw (info bit j of word f is xw[j * nb + f]).
+static void tri0_run(
+   cdc_inst_type *dd,
+   int nb
+)
+{
+   double *ws = dd->ws;
+   int *xw = dd->xw;
+   sched_op *op;
+   double *y1, *y2, *a, *yd, *p;
+   int *xd;
+   int t, n, nn, nn2, i, f, h, b;
+
+   for (t = 0; t < dd->sched_len; t++) {
+      op = dd->sched + t;
+      n = 1 << op->m;
+      nn = n * nb;
+      nn2 = nn / 2;
+      y1 = ws + (size_t)op->in * nb;
+      y2 = y1 + nn2;
+      a = ws + (size_t)op->aux * nb;
+      yd = ws + (size_t)op->yd * nb;
+
+      switch (op->op) {
+
+      case OP_XOR:
+         VXOR_EST(y1, y2, a, nn2);
+         break;
+
+      case OP_ADD:
+         for (i = 0; i < nn2; i++) y1[i] = EST_XOR_YLDEC(y1[i], yd[i]);
+         VADD_EST(y1, y2, a, nn2);
+         break;
+
+      case OP_COMB:
+         for (i = 0; i < nn2; i++) yd[i] *= yd[i + nn2];
+         break;
+
+      case OP_REP:
+         // One info bit: the sign of the sum of the LLRs.
+         p = a;
+         xd = xw + (size_t)op->x * nb;
+         for (f = 0; f < nb; f++) p[f] = 0.0;
+         for (i = 0; i < n; i++) {
+            for (f = 0; f < nb; f++) p[f] += EST2LLR(y1[i * nb + f]);
+         }
+         for (f = 0; f < nb; f++) xd[f] = (p[f] > 0.0) ? 0 : 1;
+         for (i = 0; i < n; i++) {
+            for (f = 0; f < nb; f++) yd[i * nb + f] = xd[f] ? YLDEC1 : YLDEC0;
          }
-         else {
-            tmp[i] = 1;
-            y_dec[i] = YLDEC1;
+         break;
+
+      case OP_MM:
+         // n info bits: the hard decisions encoded in place
+         // (mrm_enc_mm_bsc() butterflies, the short ones first).
+         xd = xw + (size_t)op->x * nb;
+         for (i = 0; i < nn; i++) {
+            if (CHECK_EST0(y1[i])) {
+               xd[i] = 0;
+               yd[i] = YLDEC0;
+            }
+            else {
+               xd[i] = 1;
+               yd[i] = YLDEC1;
+            }
          }
+         for (h = nb; h < nn; h <<= 1) {
+            for (b = 0; b < nn; b += 2 * h) {
+               for (i = b; i < b + h; i++) xd[i] ^= xd[i + h];
+            }
+         }
+         break;
       }
-      mrm_enc_mm_bsc(m, tmp, x_dec);
-      return 0;
    }
-
-   // Further reduction.
-
-   n2 = n / 2;
-   y1 = y_in;
-   y2 = y_in + n2;
-   y_dec1 = y_dec;
-   y_dec2 = y_dec + n2;
-
-   // Decode u1.
-   VXOR_EST(y1, y2, aux_buf, n2);
-   tri0_dec(
-      aux_buf, r - 1, m - 1, n2,
-      y_dec1, x_dec, &cur_x_dec_len, aux_buf + n2
-   );
-   (*x_dec_len) = cur_x_dec_len;
-
-   // Decode u2.
-   for (i = 0; i < n2; i++) y1[i] = EST_XOR_YLDEC(y1[i], y_dec[i]);
-   VADD_EST(y1, y2, aux_buf, n2);
-   tri0_dec(
-      aux_buf, r, m - 1, n2,
-      y_dec2, x_dec + cur_x_dec_len, &cur_x_dec_len, aux_buf + n2
-   );
-   (*x_dec_len) += cur_x_dec_len;
-
-   // y_dec = [y_dec1 .* y_dec2, y_dec2];
-   for (i = 0; i < n2; i++) y_dec1[i] *= y_dec2[i];
-
-   return 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -151,6 +215,7 @@ cdc_init(
    cdc_inst_type *dd = NULL;
    char *str1 = NULL, *token;
    int c_n = 0, c_k = 0, c_m = 0, c_r = 0;
+   int batch_size = 1;
 
    // Allocate decoder instance.
    dd = (cdc_inst_type *)malloc(sizeof(cdc_inst_type));
@@ -161,7 +226,7 @@ cdc_init(
    memset(dd, 0, sizeof(cdc_inst_type));
 
    // Allocate temporary string for parsing.
-   str1 = (char *)malloc(SP_STR_MAX);
+   str1 = (char *)malloc(strlen(param_str) + 1);
    if (str1 == NULL) {
       err_msg("cdc_init: Short of memory!");
       goto ret_err;
@@ -175,6 +240,7 @@ cdc_init(
    while (token != NULL) {
       TRYGET_INT_TOKEN(token, "RM_m", c_m);
       TRYGET_INT_TOKEN(token, "RM_r", c_r);
+      TRYGET_INT_TOKEN(token, "batch_size", batch_size);
       SPF_SKIP_UNKNOWN_PARAMETER(token);
    }
 
@@ -188,11 +254,31 @@ cdc_init(
       err_msg("cdc_init: RM_m or RM_r are not specified.");
       goto ret_err;
    }
+   if ((c_m > CODE_M_MAX) || (c_r > c_m)) {
+      err_msg("cdc_init: RM_m or RM_r are out of range.");
+      goto ret_err;
+   }
+   if ((batch_size < 1) || (batch_size > BATCH_SIZE_MAX)) {
+      err_msg("cdc_init: batch_size is out of range.");
+      goto ret_err;
+   }
+   dd->batch = batch_size;
 
    // Complete settings.
    dd->c_n = c_n = 1 << c_m;
    dd->c_k = c_k = calc_rm_k(c_m, c_r);
 
+   // Schedule: the input at 0, the decisions at c_n, aux at 2 * c_n.
+   dd->sched_len = sched_build(NULL, 0, c_r, c_m, 0, 2 * c_n, c_n, 0);
+   dd->sched = (sched_op *)malloc(dd->sched_len * sizeof(sched_op));
+   dd->ws = (double *)malloc((size_t)batch_size * c_n * 3 * sizeof(double));
+   dd->xw = (int *)malloc((size_t)batch_size * c_k * sizeof(int));
+   if ((dd->sched == NULL) || (dd->ws == NULL) || (dd->xw == NULL)) {
+      err_msg("cdc_init: Short of memory!");
+      goto ret_err;
+   }
+   sched_build(dd->sched, 0, c_r, c_m, 0, 2 * c_n, c_n, 0);
+
 #ifdef FORMAT_Q
    if (dec_tables_init()) {
       err_msg("cdc_init: error in dec_tables_init().");
@@ -208,6 +294,9 @@ ret_err:
 
    if (str1 != NULL) free(str1);
    if (dd != NULL) {
+      CHK_FREE(dd->sched);
+      CHK_FREE(dd->ws);
+      CHK_FREE(dd->xw);
       free(dd);
       (*cdc) = NULL;
    }
@@ -223,6 +312,9 @@ cdc_close(
 
    if (cdc == NULL) return;
    dd = (cdc_inst_type *)cdc;
+   CHK_FREE(dd->sched);
+   CHK_FREE(dd->ws);
+   CHK_FREE(dd->xw);
    free(dd);
 #ifdef FORMAT_Q
    dec_tables_free();
@@ -280,29 +372,61 @@ dec_bpsk(
 )
 {
    cdc_inst_type *dd;
-   double *dec_input, *y_dec, *aux_buf;
-   // int max_peak_lsiz;
-   void *mem_buf;
    int i;
 
    dd = (cdc_inst_type *)cdc;
 
-   mem_buf = (double *)malloc(dd->c_n * 3 * sizeof(double));
-   if (mem_buf == NULL) {
-      err_msg("dec_bpsk: Short of memory.");
-      return -1;
-   }
+   // Input <-- 2 * c_out / sg^2.
+   for (i = 0; i < dd->c_n; i++) dd->ws[i] = c_out[i] * dd->sg22;
+   VY_TO_FORMAT(dd->ws, dd->ws, dd->c_n);
+
+   tri0_run(dd, 1);
+   memcpy(x_dec, dd->xw, dd->c_k * sizeof(int));
+
+   return 0;
+}
+
+int cdc_get_batch(void *cdc)
+{
+   cdc_inst_type *dd;
+
+   if (cdc == NULL) return 0;
+   dd = (cdc_inst_type *)cdc;
+   return dd->batch;
+}
 
-   dec_input = (double *)mem_buf;
-   y_dec = dec_input + dd->c_n;
-   aux_buf = y_dec + dd->c_n;
-   // dec_input <-- 2 * c_out / sg^2.
-   for (i = 0; i < dd->c_n; i++) dec_input[i] = c_out[i] * dd->sg22;
-   VY_TO_FORMAT(dec_input, dec_input, dd->c_n);
+int
+dec_bpsk_batch(
+   void *cdc,
+   int nfr,
+   double c_out[],
+   int x_dec[]
+)
+{
+   cdc_inst_type *dd;
+   int c_n, c_k, nb, i, f;
+
+   dd = (cdc_inst_type *)cdc;
+   c_n = dd->c_n;
+   c_k = dd->c_k;
+
+   // By batch words at most.
+   for (; nfr > 0; nfr -= nb) {
+      nb = MIN(nfr, dd->batch);
+      // Input <-- 2 * c_out / sg^2, the words interleaved.
+      for (f = 0; f < nb; f++) {
+         for (i = 0; i < c_n; i++) dd->ws[i * nb + f] = c_out[f * c_n + i] * dd->sg22;
+      }
+      VY_TO_FORMAT(dd->ws, dd->ws, nb * c_n);
 
-   tri0_dec(dec_input, dd->c_r, dd->c_m, dd->c_n, y_dec, x_dec, &i, aux_buf);
+      tri0_run(dd, nb);
 
-   free(mem_buf);
+      for (f = 0; f < nb; f++) {
+         for (i = 0; i < c_k; i++) x_dec[f * c_k + i] = dd->xw[i * nb + f];
+      }
+      c_out += (size_t)nb * c_n;
+      x_dec += (size_t)nb * c_k;
+   }
 
    return 0;
 }
@@ -41,6 +41,7 @@
 #include <math.h>
 #include "../common/typedefs.h"
 #include "../common/std_defs.h"
+#include "../rm1_ml/rm1_ml.h"
 #include "dtrm_glp_inner.h"
 
 
@@ -61,6 +62,8 @@
 #define YLIST_POP(i) (yitems[i] + (1 << (i)) * (yfrindp[i]++))
 #endif // DBG2
 #define YLIST_RESET(i) { yfrindp[i] = 0; }
+// k rows at once (the rows of k YLIST_POP(i) in a row).
+#define YLIST_POP_N(i, k) (yfrindp[i] += (k), yitems[i] + (1 << (i)) * (yfrindp[i] - (k)))
 
 #define YLISTP(i, j) ylist[(i) * dd->c_m + (j)]
 #define YLISTPP(i, j) (ylist + (i) * dd->c_m + (j))
@@ -69,32 +72,64 @@
 //-----------------------------------------------------------------------------
 // Internal typedefs.
 
+// Per-path loop over lorder[i0..i1) run by the thread team. The list state
+// is passed explicitly: the globals are THREAD_LOCAL to the calling thread.
+typedef struct {
+  int c_m;
+  int c_n;
+  int m; // Node m.
+  ylitem **ylist;
+  int *lorder;
+  xlist_item **lind2xl;
+  slitem *slist;
+  ylitem *yrows; // Rows reserved with YLIST_POP_N() for the paths in the lorder order.
+  slitem *sbr; // Metrics of 0 and 1 per path (rm1_branch()).
+  ylitem *y_perm; // Permuted inputs (root node).
+  int *plist;
+} path_job;
+
+#define JYLISTP(jb, i, j) (jb)->ylist[(i) * (jb)->c_m + (j)]
+
 //-----------------------------------------------------------------------------
 // Global data.
+// Thread-local: independent decoders (e.g. permutation groups) may run in parallel.
+
+THREAD_LOCAL uint32 *node_table; // The table of list sizes at the border nodes.
+THREAD_LOCAL int node_counter;
+THREAD_LOCAL int lsiz_lim; // List size limit for the current decoding (dd->peak_lsiz).
+
+// List size at the node i limited with lsiz_lim.
+#define NODE_LSIZ(i) ((int)MIN(node_table[i], (uint32)lsiz_lim))
+
+THREAD_LOCAL slitem *slist;
+THREAD_LOCAL xlist_item *xlist;
+THREAD_LOCAL int *plist; // Permutation index list.
+THREAD_LOCAL int *parent; // index of the parent list element.
+THREAD_LOCAL xlist_item **lind2xl; // list index to xlist
 
-uint32 *node_table; // The table of list sizes at the border nodes.
-int node_counter;
+THREAD_LOCAL ylitem **yitems; // peak_lsiz * 2 * c_n
+THREAD_LOCAL ylitem **ylist; // current buffer - YLISTP(list_index, m)
+THREAD_LOCAL int yfrindp[32]; // yfrindp[i] points to the next available row for ylist in yitems[i].
 
-slitem *slist;
-xlist_item *xlist;
-int *plist; // Permutation index list.
-int *parent; // index of the parent list element.
-xlist_item **lind2xl; // list index to xlist
+THREAD_LOCAL int *lorder; // list ordering
+THREAD_LOCAL int cur_lsiz; // Current list size.
 
-ylitem **yitems; // peak_lsiz * 2 * c_n
-ylitem **ylist; // current buffer - YLISTP(list_index, m)
-int yfrindp[32]; // yfrindp[i] points to the next available row for ylist in yitems[i].
+THREAD_LOCAL int *frind; // Stack containing indexes of free list cells.
+THREAD_LOCAL int frindp; // frind pointer. Points to the next available element.
 
-int *lorder; // list ordering
-int cur_lsiz; // Current list size.
+THREAD_LOCAL xlist_item *next_xle_ptr; // pointer to the next available xlist element
 
-int *frind; // Stack containing indexes of free list cells.
-int frindp; // frind pointer. Points to the next available element.
+THREAD_LOCAL xlitem *xtmp;
+THREAD_LOCAL xlitem *xtmp2;
 
-xlist_item *next_xle_ptr; // pointer to the next available xlist element
+// rm1_fht_branch() buffers.
+THREAD_LOCAL double *fht_llr; // LLRs of the node and their transform.
+THREAD_LOCAL double *fht_s; // Metrics of the candidates.
+THREAD_LOCAL int *fht_x; // Info bits of the candidates.
+THREAD_LOCAL slitem *fht_heap; // Min-heap of the best path metrics at the node.
+THREAD_LOCAL int fht_heap_len;
 
-xlitem *xtmp;
-xlitem *xtmp2;
+THREAD_LOCAL slitem *sbr; // Metrics of 0 and 1 per path (rm1_branch()).
 
 
 //-----------------------------------------------------------------------------
@@ -160,17 +195,22 @@ int vgetx_all(int listInd, xlitem *res_x) {
 }
 void print_list(char rem[]) {
   int i, j, n;
-  xlitem tmp[4096];
+  xlitem *tmp;
+  xlist_item *xle;
   if (rem != NULL) {
     printf("%s: ", rem);
   }
   for (i = 0; i < cur_lsiz; i++) {
     printf("%3.1f:", slist[lorder[i]]);
+    for (n = 0, xle = lind2xl[lorder[i]]; xle->p != NULL; xle = xle->p) n++;
+    tmp = (xlitem *)malloc((n + 1) * sizeof(xlitem));
+    if (tmp == NULL) break;
     n = vgetx_all(lorder[i], tmp);
     for (j = 0; j < n; j++) {
       printf("%1d", tmp[j]);
     }
     printf(" ");
+    free(tmp);
   }
   printf("\n");
 #ifdef DBG2
@@ -208,42 +248,232 @@ static void qpartition(int *v, int len, int k) {
   else qpartition(v + st, len - st, k - st);
 }
 
-// n <= 2^15.
+// Drop the paths worse than the best one by more than prune_margin
+// (0 - no pruning) and update the peak # of active paths.
+static void prune_list(decoder_type *dd) {
+  slitem s_lim;
+  int i;
+
+  if ((dd->prune_margin > 0.0) && (cur_lsiz > 1)) {
+    s_lim = slist[lorder[0]];
+    for (i = 1; i < cur_lsiz; i++) s_lim = MAX(s_lim, slist[lorder[i]]);
+    s_lim -= dd->prune_margin;
+    for (i = 0; i < cur_lsiz; ) {
+      if (slist[lorder[i]] >= s_lim) {
+        i++;
+        continue;
+      }
+      frind[--frindp] = lorder[i];
+      lorder[i] = lorder[--cur_lsiz];
+    }
+  }
+  dd->act_lsiz = MAX(dd->act_lsiz, cur_lsiz);
+}
+
+// (m, m) code, butterflies level by level (no recursion, any n).
 void code_mm(int n, xlitem *x, xlitem *y) {
-  int cur_depth = 0;
-  int states[] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-  int i, n2;
-
-  while (cur_depth >= 0) {
-    if (n == 1) {
-      y[0] = x[0];
-      n = 2;
-      cur_depth--;
-      continue;
+  int n2, b, j;
+
+  memcpy(y, x, n * sizeof(xlitem));
+  for (n2 = 1; n2 < n; n2 <<= 1) {
+    for (b = 0; b < n; b += 2 * n2) {
+      for (j = b; j < b + n2; j++) y[j] ^= y[j + n2];
     }
-    if (states[cur_depth] == 0) {
-      // Calculate y_v.
-      states[cur_depth++] = 1;
-      n >>= 1;
-      continue;
+  }
+}
+
+// Path job for the node m of the current list.
+static void path_job_init(path_job *jb, decoder_type *dd, int m, ylitem *yrows) {
+  jb->c_m = dd->c_m;
+  jb->c_n = dd->c_n;
+  jb->m = m;
+  jb->ylist = ylist;
+  jb->lorder = lorder;
+  jb->lind2xl = lind2xl;
+  jb->slist = slist;
+  jb->yrows = yrows;
+  jb->sbr = sbr;
+  jb->y_perm = NULL;
+  jb->plist = plist;
+}
+
+// y_v = y_1 xor y_2.
+static void vxor_job(void *arg, int i0, int i1) {
+  path_job *jb = (path_job *)arg;
+  int n2 = 1 << (jb->m - 1);
+  int cur_ind0, i;
+  ylitem *yp1, *yp2, *vp;
+
+  for (i = i0; i < i1; i++) {
+    cur_ind0 = jb->lorder[i];
+    yp1 = JYLISTP(jb, cur_ind0, jb->m);
+    yp2 = yp1 + n2;
+    vp = JYLISTP(jb, cur_ind0, jb->m - 1) = jb->yrows + (size_t)i * n2;
+    VXOR_EST(yp1, yp2, vp, n2);
+  }
+}
+
+// y_u = y_1 xor v + y_2, ref to v is saved in y.
+static void yu_job(void *arg, int i0, int i1) {
+  path_job *jb = (path_job *)arg;
+  int n2 = 1 << (jb->m - 1);
+  int cur_ind0, i, j;
+  ylitem *yp1, *yp2, *vp, *up;
+  ylitem y1;
+
+  for (i = i0; i < i1; i++) {
+    cur_ind0 = jb->lorder[i];
+    yp1 = JYLISTP(jb, cur_ind0, jb->m);
+    yp2 = yp1 + n2;
+    vp = JYLISTP(jb, cur_ind0, jb->m) = JYLISTP(jb, cur_ind0, jb->m - 1); // y <-- v
+    up = JYLISTP(jb, cur_ind0, jb->m - 1) = jb->yrows + (size_t)i * n2;
+    for (j = 0; j < n2; j++) {
+      y1 = EST_XOR_YLDEC(yp1[j], vp[j]); // y1 <-- y_1[j] xor v[j].
+      ADD_EST(y1, yp2[j], up[j]); // y_u <-- y1 + y_2[j];
     }
-    n2 = n >> 1;
-    if (states[cur_depth] == 1) {
-      // Calculate y_u.
-      states[cur_depth++] = 2;
-      x += n2;
-      y += n2;
-      n >>= 1;
+  }
+}
+
+// y_u = y_1 xor v + y_2 at the root (y is the permuted input).
+static void root_yu_job(void *arg, int i0, int i1) {
+  path_job *jb = (path_job *)arg;
+  int n2 = jb->c_n / 2;
+  int cur_ind0, i, j;
+  ylitem *yp, *vp, *up;
+  ylitem y1;
+
+  for (i = i0; i < i1; i++) {
+    cur_ind0 = jb->lorder[i];
+    vp = JYLISTP(jb, cur_ind0, jb->c_m - 1);
+    up = JYLISTP(jb, cur_ind0, jb->c_m - 1) = jb->yrows + (size_t)i * n2;
+    yp = jb->y_perm + (size_t)jb->c_n * jb->plist[cur_ind0];
+    for (j = 0; j < n2; j++) {
+      y1 = EST_XOR_YLDEC(yp[j], vp[j]); // y1 <-- y_1[j] xor v[j].
+      ADD_EST(y1, yp[j + n2], up[j]); // y_u <-- y1 + y_2[j];
+    }
+  }
+}
+
+// y_dec <-- (u xor v | u).
+static void ydec_job(void *arg, int i0, int i1) {
+  path_job *jb = (path_job *)arg;
+  int n = 1 << jb->m;
+  int n2 = n / 2;
+  int cur_ind0, i, j;
+  ylitem *yp1, *yp2, *vp, *up;
+
+  for (i = i0; i < i1; i++) {
+    cur_ind0 = jb->lorder[i];
+    vp = JYLISTP(jb, cur_ind0, jb->m);
+    yp1 = JYLISTP(jb, cur_ind0, jb->m) = jb->yrows + (size_t)i * n;
+    yp2 = yp1 + n2;
+    up = JYLISTP(jb, cur_ind0, jb->m - 1);
+    for (j = 0; j < n2; j++) {
+      yp1[j] = XOR_YLDEC(vp[j], up[j]);
+      yp2[j] = up[j];
+    }
+  }
+}
+
+// rm1_branch(): ln P of v = 0 and v = 1 to sbr[].
+static void rm1_metric_job(void *arg, int i0, int i1) {
+  path_job *jb = (path_job *)arg;
+  int n2 = 1 << (jb->m - 1);
+  int i, j;
+  slitem s0, s1;
+  ylitem y1;
+  ylitem *yp1, *yp2;
+
+  for (i = i0; i < i1; i++) {
+    yp1 = JYLISTP(jb, jb->lorder[i], jb->m);
+    yp2 = yp1 + n2;
+    s0 = 0.0;
+    s1 = 0.0;
+    for (j = 0; j < n2; j++) {
+      y1 = XOR_EST(yp1[j], yp2[j]);
+      if (CHECK_EST0(y1)) {
+        s0 += EST0_TO_LNP0(y1);
+        s1 += EST0_TO_LNP1(y1);
+      }
+      else {
+        s0 += EST1_TO_LNP0(y1);
+        s1 += EST1_TO_LNP1(y1);
+      }
+    }
+    jb->sbr[2 * i] = s0;
+    jb->sbr[2 * i + 1] = s1;
+  }
+}
+
+// rm1_branch(): v decisions and y_u for the decided v.
+static void rm1_finish_job(void *arg, int i0, int i1) {
+  path_job *jb = (path_job *)arg;
+  int n2 = 1 << (jb->m - 1);
+  int cur_ind1, i, j;
+  ylitem *yp1, *yp2, *vp, *up;
+
+  for (i = i0; i < i1; i++) {
+    cur_ind1 = jb->lorder[i];
+    yp1 = JYLISTP(jb, cur_ind1, jb->m);
+    yp2 = yp1 + n2;
+    vp = JYLISTP(jb, cur_ind1, jb->m) = jb->yrows + (size_t)(2 * i) * n2;
+    up = JYLISTP(jb, cur_ind1, jb->m - 1) = vp + n2;
+    if (jb->lind2xl[cur_ind1]->x == 0) {
+      VADD_EST(yp1, yp2, up, n2);
+      for (j = 0; j < n2; j++) vp[j] = YLDEC0;
     }
     else {
-      // (states[cur_depth] == 2)
-      x -= n2;
-      y -= n2;
-      for (i = 0; i < n2; i++) y[i] ^= y[i + n2];
-      states[cur_depth--] = 0;
-      n <<= 1;
-    }
-  } // while (cur_depth >= 0)
+      VADD_INV_EST(yp1, yp2, up, n2);
+      for (j = 0; j < n2; j++) vp[j] = YLDEC1;
+    }
+  }
+}
+
+// rm1_skip(): v = 0.
+static void rm1_skip_job(void *arg, int i0, int i1) {
+  path_job *jb = (path_job *)arg;
+  int n2 = 1 << (jb->m - 1);
+  int cur_ind0, i, j;
+  slitem s1;
+  ylitem y1;
+  ylitem *yp1, *yp2, *vp, *up;
+
+  for (i = i0; i < i1; i++) {
+    cur_ind0 = jb->lorder[i];
+    yp1 = JYLISTP(jb, cur_ind0, jb->m);
+    yp2 = yp1 + n2;
+    vp = JYLISTP(jb, cur_ind0, jb->m) = jb->yrows + (size_t)(2 * i) * n2;
+    up = JYLISTP(jb, cur_ind0, jb->m - 1) = vp + n2;
+    s1 = 0.0;
+    for (j = 0; j < n2; j++) {
+      y1 = XOR_EST(yp1[j], yp2[j]);
+      s1 += EST_TO_LNP0(y1);
+    }
+    jb->slist[cur_ind0] += s1;
+    VADD_EST(yp1, yp2, up, n2);
+    for (j = 0; j < n2; j++) vp[j] = YLDEC0;
+  }
+}
+
+// rmm_skip(): all zeroes.
+static void rmm_skip_job(void *arg, int i0, int i1) {
+  path_job *jb = (path_job *)arg;
+  int n = 1 << jb->m;
+  int cur_ind0, i, j;
+  slitem s1;
+  ylitem *yp1, *yp3;
+
+  for (i = i0; i < i1; i++) {
+    cur_ind0 = jb->lorder[i];
+    yp1 = JYLISTP(jb, cur_ind0, jb->m);
+    yp3 = JYLISTP(jb, cur_ind0, jb->m) = jb->yrows + (size_t)i * n;
+    s1 = 0.0;
+    for (j = 0; j < n; j++) {
+      s1 += EST_TO_LNP0(yp1[j]);
+      yp3[j] = YLDEC0;
+    }
+    jb->slist[cur_ind0] += s1;
+  }
 }
 
 void rm1_branch(
@@ -256,35 +486,24 @@ void rm1_branch(
   int cur_lsiz_old = cur_lsiz;
   int cur_ind0, cur_ind1;
   slitem s0, s1;
-  ylitem y1;
-  ylitem *yp1, *yp2, *vp, *up;
-  int i, j;
+  path_job jb;
+  int i;
 
 #ifdef DBG
   printf("rm1:    m=%d, r=%d, n=%3d, cur_lsiz=%d.\n", m, 1, n, cur_lsiz);
   print_list("a");
 #endif
 
+  path_job_init(&jb, dd, m, NULL);
+  team_run(dd->team, rm1_metric_job, &jb, cur_lsiz_old, (long)cur_lsiz_old * n2);
+
   // Initial branching
   for (i = 0; i < cur_lsiz_old; i++) {
     cur_ind0 = lorder[i];
     parent[cur_ind0] = -1;
     cur_ind1 = branch(cur_ind0, lind2xl[cur_ind0]);
-    yp1 = YLISTP(cur_ind0, m);
-    yp2 = yp1 + n2;
-    s0 = 0.0;
-    s1 = 0.0;
-    for (j = 0; j < n2; j++) {
-      y1 = XOR_EST(yp1[j], yp2[j]);
-      if (CHECK_EST0(y1)) {
-        s0 += EST0_TO_LNP0(y1);
-        s1 += EST0_TO_LNP1(y1);
-      }
-      else {
-        s0 += EST1_TO_LNP0(y1);
-        s1 += EST1_TO_LNP1(y1);
-      }
-    }
+    s0 = sbr[2 * i];
+    s1 = sbr[2 * i + 1];
     if (s0 > s1) {
       PUSHZEROX(cur_ind0);
       PUSHONEX(cur_ind1);
@@ -308,6 +527,7 @@ void rm1_branch(
     qpartition(lorder, cur_lsiz, peak_lsiz);
     while (cur_lsiz > peak_lsiz) frind[--frindp] = lorder[--cur_lsiz];
   }
+  prune_list(dd);
 
   // Finalize the remaining branches
   for (i = 0; i < cur_lsiz; i++) {
@@ -317,19 +537,117 @@ void rm1_branch(
       memcpy(YLISTPP(cur_ind1, 0), YLISTPP(cur_ind0, 0), dd->c_m * sizeof(ylitem *));
     }
   }
+  path_job_init(&jb, dd, m, YLIST_POP_N(m - 1, 2 * cur_lsiz));
+  team_run(dd->team, rm1_finish_job, &jb, cur_lsiz, (long)cur_lsiz * n2);
+
+#ifdef DBG
+  print_list("c");
+#endif
+
+}
+
+// Add s to the min-heap of the best hsiz metrics.
+static void heap_add(slitem s, int hsiz) {
+  int i, j;
+
+  if (fht_heap_len < hsiz) {
+    for (i = fht_heap_len++; (i > 0) && (fht_heap[j = (i - 1) / 2] > s); i = j) {
+      fht_heap[i] = fht_heap[j];
+    }
+    fht_heap[i] = s;
+    return;
+  }
+  if (s <= fht_heap[0]) return;
+  for (i = 0; (j = 2 * i + 1) < hsiz; i = j) {
+    if ((j + 1 < hsiz) && (fht_heap[j + 1] < fht_heap[j])) j++;
+    if (fht_heap[j] >= s) break;
+    fht_heap[i] = fht_heap[j];
+  }
+  fht_heap[i] = s;
+}
+
+// (1, m) node with its whole subtree ((0, m - 1), ..., (0, 1), (1, 1) border
+// nodes): each path is expanded with the best dd->rm1_lsiz candidates of
+// the FHT based ML decoder. The candidates below the peak_lsiz-th best
+// metric so far are not added (they would be cut anyway).
+void rm1_fht_branch(
+   decoder_type *dd, // Decoder instance data.
+   int m,
+   int peak_lsiz
+) {
+  int n = 1 << m;
+  int k = m + 1;
+  int cur_lsiz_old = cur_lsiz;
+  int cand_num;
+  int cur_ind0, cur_ind1;
+  xlist_item *cur_xl0;
+  slitem s0, s_min;
+  ylitem *yp1, *yp3;
+  int i, j, t, len;
+
+#ifdef DBG
+  printf("rm1fht: m=%d, r=%d, n=%3d, cur_lsiz=%d.\n", m, 1, n, cur_lsiz);
+  print_list("a");
+#endif
+
+  fht_heap_len = 0;
+  for (i = 0; i < cur_lsiz_old; i++) {
+    cur_ind0 = lorder[i];
+    cur_xl0 = lind2xl[cur_ind0];
+    parent[cur_ind0] = -1;
+    yp1 = YLISTP(cur_ind0, m);
+    // ln P(c | y) = s0 + sum_j (-1)^c_j * llr_j / 2.
+    s0 = slist[cur_ind0];
+    for (j = 0; j < n; j++) {
+      fht_llr[j] = EST2LLR(yp1[j]);
+      s0 += EST_TO_LNP0(yp1[j]) - 0.5 * fht_llr[j];
+    }
+    s_min = (fht_heap_len == peak_lsiz) ? fht_heap[0] - s0 : -FM_S_HUGE;
+    cand_num = rm1_dec_fht_lst_th(m, fht_llr, MIN(dd->rm1_lsiz, peak_lsiz), s_min, fht_x, fht_s);
+    for (t = 0; t < cand_num; t++) heap_add(s0 + fht_s[t], peak_lsiz);
+    if (cand_num == 0) {
+      // There are peak_lsiz better paths already: cut below.
+      slist[cur_ind0] = -FM_S_HUGE;
+      continue;
+    }
+    vpushx(cur_ind0, fht_x, k);
+    slist[cur_ind0] = s0 + fht_s[0];
+    for (t = 1; t < cand_num; t++) {
+      cur_ind1 = branch(cur_ind0, cur_xl0);
+      vpushx(cur_ind1, fht_x + t * k, k);
+      slist[cur_ind1] = s0 + fht_s[t];
+    }
+  }
+
+#ifdef DBG
+  print_list("b");
+#endif
+
+  // Partition and cut the list.
+  if (cur_lsiz > peak_lsiz) {
+    qpartition(lorder, cur_lsiz, peak_lsiz);
+    while (cur_lsiz > peak_lsiz) frind[--frindp] = lorder[--cur_lsiz];
+  }
+  prune_list(dd);
+
   for (i = 0; i < cur_lsiz; i++) {
     cur_ind1 = lorder[i];
-    yp1 = YLISTP(cur_ind1, m);
-    yp2 = yp1 + n2;
-    vp = YLISTP(cur_ind1, m) = YLIST_POP(m - 1);
-    up = YLISTP(cur_ind1, m - 1) = YLIST_POP(m - 1);
-    if (GETX(cur_ind1) == 0) {
-      VADD_EST(yp1, yp2, up, n2);
-      for (j = 0; j < n2; j++) vp[j] = YLDEC0;
+    cur_ind0 = parent[cur_ind1];
+    if (cur_ind0 >= 0) {
+      memcpy(YLISTPP(cur_ind1, 0), YLISTPP(cur_ind0, 0), dd->c_m * sizeof(ylitem *));
     }
-    else {
-      VADD_INV_EST(yp1, yp2, up, n2);
-      for (j = 0; j < n2; j++) vp[j] = YLDEC1;
+    // Codeword (u xor v | u) level by level from the (0, 0) code.
+    vgetx(cur_ind1, xtmp, k);
+    xtmp2[0] = xtmp[m];
+    for (len = 1, t = m - 1; t >= 0; len <<= 1, t--) {
+      for (j = 0; j < len; j++) {
+        xtmp2[j + len] = xtmp2[j];
+        xtmp2[j] ^= xtmp[t];
+      }
+    }
+    yp3 = YLISTP(cur_ind1, m) = YLIST_POP(m);
+    for (j = 0; j < n; j++) {
+      yp3[j] = xtmp2[j] ? YLDEC1 : YLDEC0;
     }
   }
 
@@ -339,35 +657,27 @@ void rm1_branch(
 
 }
 
+// 1 if all the border nodes of the (1, m) subtree are active.
+static int rm1_nodes_active(int m) {
+  int i;
+
+  for (i = 0; i < m; i++) {
+    if (node_table[node_counter + i] == 0) return 0;
+  }
+  return 1;
+}
+
 void rm1_skip(
   decoder_type *dd, // Decoder instance data.
   int m
 ) {
 
-  int n = 1 << m;
-  int n2 = n / 2;
-  int cur_ind0;
-  slitem s1;
-  ylitem y1;
-  ylitem *yp1, *yp2, *vp, *up;
-  int i, j;
+  int n2 = 1 << (m - 1);
+  path_job jb;
 
   YLIST_RESET(m - 1);
-  for (i = 0; i < cur_lsiz; i++) {
-    cur_ind0 = lorder[i];
-    yp1 = YLISTP(cur_ind0, m);
-    yp2 = yp1 + n2;
-    vp = YLISTP(cur_ind0, m) = YLIST_POP(m - 1);
-    up = YLISTP(cur_ind0, m - 1) = YLIST_POP(m - 1);
-    s1 = 0.0;
-    for (j = 0; j < n2; j++) {
-      y1 = XOR_EST(yp1[j], yp2[j]);
-      s1 += EST_TO_LNP0(y1);
-    }
-    slist[cur_ind0] += s1;
-    VADD_EST(yp1, yp2, up, n2);
-    for (j = 0; j < n2; j++) vp[j] = YLDEC0;
-  }
+  path_job_init(&jb, dd, m, YLIST_POP_N(m - 1, 2 * cur_lsiz));
+  team_run(dd->team, rm1_skip_job, &jb, cur_lsiz, (long)cur_lsiz * n2);
 }
 
 void rm11_branch(
@@ -444,6 +754,7 @@ void rm11_branch(
     qpartition(lorder, cur_lsiz, peak_lsiz);
     while (cur_lsiz > peak_lsiz) frind[--frindp] = lorder[--cur_lsiz];
   }
+  prune_list(dd);
 
   for (i = 0; i < cur_lsiz; i++) {
     cur_ind1 = lorder[i];
@@ -580,6 +891,7 @@ void rmm_branch(
     qpartition(lorder, cur_lsiz, peak_lsiz);
     while (cur_lsiz > peak_lsiz) frind[--frindp] = lorder[--cur_lsiz];
   }
+  prune_list(dd);
 
   for (i = 0; i < cur_lsiz; i++) {
     cur_ind1 = lorder[i];
@@ -609,22 +921,10 @@ void rmm_skip(
 ) {
 
   int n = 1 << m;
-  int cur_ind0;
-  slitem s1;
-  ylitem *yp1, *yp3;
-  int i, j;
+  path_job jb;
 
-  for (i = 0; i < cur_lsiz; i++) {
-    cur_ind0 = lorder[i];
-    yp1 = YLISTP(cur_ind0, m);
-    yp3 = YLISTP(cur_ind0, m) = YLIST_POP(m);
-    s1 = 0.0;
-    for (j = 0; j < n; j++) {
-      s1 += EST_TO_LNP0(yp1[j]);
-      yp3[j] = YLDEC0;
-    }
-    slist[cur_ind0] += s1;
-  }
+  path_job_init(&jb, dd, m, YLIST_POP_N(m, cur_lsiz));
+  team_run(dd->team, rmm_skip_job, &jb, cur_lsiz, (long)cur_lsiz * n);
 }
 
 void rm_dec_inner(
@@ -635,10 +935,7 @@ void rm_dec_inner(
 
   int n = 1 << m;
   int n2 = n / 2;
-  int cur_ind0;
-  ylitem *yp1, *yp2, *vp, *up;
-  ylitem y1;
-  int i, j;
+  path_job jb;
 
   if (r == m) {
      if (node_table[node_counter] == 0) {
@@ -646,10 +943,10 @@ void rm_dec_inner(
      }
      else {
         if (m == 1) {
-           rm11_branch(dd, node_table[node_counter]);
+           rm11_branch(dd, NODE_LSIZ(node_counter));
         }
         else {
-           rmm_branch(dd, m, node_table[node_counter]);
+           rmm_branch(dd, m, NODE_LSIZ(node_counter));
         }
      }
      node_counter++;
@@ -657,11 +954,17 @@ void rm_dec_inner(
   }
 
   if (r == 1) {
+     if ((dd->rm1_lsiz > 0) && (m > 1) && rm1_nodes_active(m)) {
+        // The subtree as a whole, list size of its last node.
+        rm1_fht_branch(dd, m, NODE_LSIZ(node_counter + m - 1));
+        node_counter += m;
+        return;
+     }
      if (node_table[node_counter] == 0) {
         rm1_skip(dd, m);
      }
      else {
-        rm1_branch(dd, m, node_table[node_counter]);
+        rm1_branch(dd, m, NODE_LSIZ(node_counter));
      }
      node_counter++;
   }
@@ -673,13 +976,8 @@ void rm_dec_inner(
 #endif
 
     // Calculate y_v = y_1 xor y_2.
-    for (i = 0; i < cur_lsiz; i++) {
-       cur_ind0 = lorder[i];
-       yp1 = YLISTP(cur_ind0, m);
-       yp2 = yp1 + n2;
-       vp = YLISTP(cur_ind0, m - 1) = YLIST_POP(m - 1);
-       VXOR_EST(yp1, yp2, vp, n2);
-    }
+    path_job_init(&jb, dd, m, YLIST_POP_N(m - 1, cur_lsiz));
+    team_run(dd->team, vxor_job, &jb, cur_lsiz, (long)cur_lsiz * n2);
 
     rm_dec_inner(dd, m - 1, r - 1);
 
@@ -690,17 +988,8 @@ void rm_dec_inner(
 
     // Calculate y_u = y_1 xor v + y_2.
     // Also save ref to v in y.
-    for (i = 0; i < cur_lsiz; i++) {
-       cur_ind0 = lorder[i];
-       yp1 = YLISTP(cur_ind0, m);
-       yp2 = yp1 + n2;
-       vp = YLISTP(cur_ind0, m) = YLISTP(cur_ind0, m - 1); // y <-- v
-       up = YLISTP(cur_ind0, m - 1) = YLIST_POP(m - 1);
-       for (j = 0; j < n2; j++) {
-          y1 = EST_XOR_YLDEC(yp1[j], vp[j]); // y1 <-- y_1[j] xor v[j].
-          ADD_EST(y1, yp2[j], up[j]); // y_u <-- y1 + y_2[j];
-       }
-    }
+    path_job_init(&jb, dd, m, YLIST_POP_N(m - 1, cur_lsiz));
+    team_run(dd->team, yu_job, &jb, cur_lsiz, (long)cur_lsiz * n2);
   }
 
 #ifdef DBG2
@@ -714,17 +1003,8 @@ void rm_dec_inner(
 #endif
 
   // y_dec <-- (u xor v | u).
-  for (i = 0; i < cur_lsiz; i++) {
-     cur_ind0 = lorder[i];
-     vp = YLISTP(cur_ind0, m);
-     yp1 = YLISTP(cur_ind0, m) = YLIST_POP(m);
-     yp2 = yp1 + n2;
-     up = YLISTP(cur_ind0, m - 1);
-     for (j = 0; j < n2; j++) {
-        yp1[j] = XOR_YLDEC(vp[j], up[j]);
-        yp2[j] = up[j];
-     }
-  }
+  path_job_init(&jb, dd, m, YLIST_POP_N(m, cur_lsiz));
+  team_run(dd->team, ydec_job, &jb, cur_lsiz, (long)cur_lsiz * n);
 
   YLIST_RESET(m - 1);
 }
@@ -743,23 +1023,23 @@ rm_dec(
   int c_k = dd->c_k;
   int c_m = dd->c_m;
   int c_r = dd->c_r;
-  int peak_lsiz; // Peak list size.
   int flsiz; // Size of allocated list.
   ylitem *y_in;
+  ylitem *y_perm; // Permuted inputs, c_n per permutation.
+  ylitem *yp;
   int n2 = dd->c_n / 2; // Half of the current length (n).
-  int cur_ind0;
-  ylitem *vp, *up;
+  ylitem *vp;
   int *p1; // For permutations.
   slitem s1;
-  ylitem y1;
   uint8 *mem_buf_ptr;
-  int mem_buf_size;
+  size_t mem_buf_size;
+  path_job jb;
 
   // ----- Shortcuts assignment.
 
   node_table = dd->node_table;
-  peak_lsiz = dd->peak_lsiz;
-  flsiz = MAX(dd->peak_lsiz, dd->p_num) * FLSIZ_MULT;
+  lsiz_lim = dd->peak_lsiz;
+  flsiz = DD_FLSIZ(dd);
 
   // ----- Memory allocation.
 
@@ -768,6 +1048,9 @@ rm_dec(
   y_in = (ylitem *)mem_buf_ptr;
   mem_buf_ptr += c_n * sizeof(ylitem);
 
+  y_perm = (ylitem *)mem_buf_ptr;
+  mem_buf_ptr += (size_t)dd->p_num * c_n * sizeof(ylitem);
+
   frind = (int *)mem_buf_ptr;
   mem_buf_ptr += flsiz * sizeof(int);
 
@@ -775,7 +1058,7 @@ rm_dec(
   mem_buf_ptr += flsiz * sizeof(int);
 
   xlist = (xlist_item *)mem_buf_ptr;
-  mem_buf_ptr += (c_k * flsiz + 1) * sizeof(xlist_item);
+  mem_buf_ptr += ((size_t)c_k * flsiz + 1) * sizeof(xlist_item);
 
   lind2xl = (xlist_item **)mem_buf_ptr;
   mem_buf_ptr += flsiz * sizeof(xlist_item *);
@@ -791,7 +1074,7 @@ rm_dec(
 #endif
   for (i = 0; i < dd->c_m; i++) {
     yitems[i] = (ylitem *)mem_buf_ptr;
-    mem_buf_ptr += (1 << i) * MAX(dd->peak_lsiz, dd->p_num) * 4 * sizeof(ylitem);
+    mem_buf_ptr += ((size_t)1 << i) * MAX(dd->peak_lsiz, dd->p_num) * 4 * sizeof(ylitem);
 #ifdef DBG2
     printf("Buffer %d: yitems[i]=%p, %ld\n", i, yitems[i], mem_buf_ptr - dd->mem_buf);
 #endif
@@ -812,6 +1095,21 @@ rm_dec(
   xtmp2 = (xlitem *)mem_buf_ptr;
   mem_buf_ptr += c_n * sizeof(xlitem);
 
+  fht_llr = (double *)mem_buf_ptr;
+  mem_buf_ptr += c_n * sizeof(double);
+
+  fht_s = (double *)mem_buf_ptr;
+  mem_buf_ptr += dd->rm1_lsiz * sizeof(double);
+
+  sbr = (slitem *)mem_buf_ptr;
+  mem_buf_ptr += 2 * flsiz * sizeof(slitem);
+
+  fht_heap = (slitem *)mem_buf_ptr;
+  mem_buf_ptr += dd->peak_lsiz * sizeof(slitem);
+
+  fht_x = (int *)mem_buf_ptr;
+  mem_buf_ptr += (size_t)dd->rm1_lsiz * (c_m + 1) * sizeof(int);
+
 #ifdef DBG2
   printf("\nAssigned buffer size: %ld\n", mem_buf_ptr - dd->mem_buf);
 #endif
@@ -820,6 +1118,12 @@ rm_dec(
 
   VY_TO_FORMAT(y_input, y_in, c_n);
 
+  // Gather the permuted inputs once, so that the root loops below
+  // (for all list paths) read them sequentially.
+  p1 = dd->pyarr;
+  yp = y_perm;
+  for (i = 0; i < dd->p_num * c_n; i++) yp[i] = y_in[p1[i]];
+
   for (i = 0; i < flsiz; i++) frind[i] = i;
   for (i = 0; i < 32; i++) YLIST_RESET(i);
 
@@ -835,12 +1139,13 @@ rm_dec(
     slist[i] = 0.0;
     lorder[i] = i;
     lind2xl[i] = xlist;
-    p1 = dd->pyarr + c_n * i;
+    yp = y_perm + c_n * i;
     vp = YLISTP(i, c_m - 1) = YLIST_POP(c_m - 1);
-    for (j = 0; j < n2; j++) vp[j] = XOR_EST(y_in[p1[j]], y_in[p1[j + n2]]);
+    for (j = 0; j < n2; j++) vp[j] = XOR_EST(yp[j], yp[j + n2]);
     plist[i] = i;
   }
   cur_lsiz = frindp = dd->p_num;
+  dd->act_lsiz = cur_lsiz;
   next_xle_ptr = xlist + 1;
   xlist[0].x = 0;
   xlist[0].p = NULL;
@@ -858,16 +1163,9 @@ rm_dec(
 #endif
 
   // Calculate y_u = y_1 xor v + y_2.
-  for (i = 0; i < cur_lsiz; i++) {
-    cur_ind0 = lorder[i];
-    vp = YLISTP(cur_ind0, c_m - 1);
-    up = YLISTP(cur_ind0, c_m - 1) = YLIST_POP(c_m - 1);
-    p1 = dd->pyarr + c_n * plist[cur_ind0];
-    for (j = 0; j < n2; j++) {
-      y1 = EST_XOR_YLDEC(y_in[p1[j]], vp[j]); // y1 <-- y_1[j] xor v[j].
-      ADD_EST(y1, y_in[p1[j + n2]], up[j]); // y_u <-- y1 + y_2[j];
-    }
-  }
+  path_job_init(&jb, dd, c_m, YLIST_POP_N(c_m - 1, cur_lsiz));
+  jb.y_perm = y_perm;
+  team_run(dd->team, root_yu_job, &jb, cur_lsiz, (long)cur_lsiz * n2);
 
   // Decode u.
   rm_dec_inner(dd, c_m - 1, c_r);
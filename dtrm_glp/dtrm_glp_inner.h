@@ -25,11 +25,15 @@
 
 #define FLSIZ_MULT 4
 
+// Size of the allocated list: the paths before a cut of the list.
+#define DD_FLSIZ(dd) (MAX((dd)->peak_lsiz, (dd)->p_num) * MAX(FLSIZ_MULT, (dd)->rm1_lsiz))
+
 
 //-----------------------------------------------------------------------------
 // Includes.
 
 #include "../common/typedefs.h"
+#include "../common/thread_team.h"
 #include "../formats/formats.h"
 
 
@@ -53,6 +57,10 @@ typedef struct {
   int *pxarr; // permutations for inf. seq. (after decoding).
   int *pyarr; // perm. for ch. output vector (before decoding).
   int ret_s_sum; // If 1 - return SUM s_i for list.
+  double prune_margin; // Paths worse than the best one by more than this are dropped (0 - no pruning).
+  int act_lsiz; // Peak # of paths in the list during the last rm_dec() call.
+  int rm1_lsiz; // Candidates per path at the (1, m) nodes decoded with FHT (0 - recursive decoding).
+  thread_team *team; // Threads for the per-path loops (NULL - the calling thread only).
   uint8 *mem_buf;
 } decoder_type;
 
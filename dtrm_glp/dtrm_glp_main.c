@@ -2,6 +2,8 @@
 // Recursive decoding on triangle, global list with permutations.
 // Needs channel sigma (define global DEC_NEEDS_SIGMA).
 // May use up to mCr permutations.
+// Permutation groups may be decoded in parallel (define global USE_PTHREADS).
+// The per-path loops of one list may be split between threads (list_threads).
 //
 // Copyright 2001 and onwards Kirill Shabunov
 //
@@ -37,6 +39,12 @@
 // Max # of SNR values.
 #define VARL_NUM_MAX        50
 
+// Max # of permutation groups.
+#define GRP_NUM_MAX         256
+
+// Max # of candidates per path at the (1, m) nodes.
+#define RM1_LSIZ_MAX        64
+
 //-----------------------------------------------------------------------------
 // Internal typedefs.
 
@@ -49,11 +57,30 @@ typedef struct {
    int csnrn;
    double sg22; // 2 / sg^2 for calculation of epsilons.
    int use_var_list;
+   int adaptive_list; // 1 - L = 1, 2, 4, ... up to border_node_lsize (use_var_list stages).
+   double adaptive_t; // Distance threshold of the adaptive_list stages.
+   int cascade_lsiz; // List size of the second stage of the cascade (0 - no cascade).
+   double cascade_t; // Distance threshold of the first stage of the cascade.
+   int last_stage; // use_var_list stage that gave the last decoded word.
    int lsiz[VARL_NUM_MAX];
    double dist_t[VARL_NUM_MAX];
    int dist_t_n;
+   int max_lsiz; // Max list size (memory is allocated for it).
+   int last_lsiz; // List size used for the last decoded word.
+   int grp_num; // # of permutation groups decoded independently (1 - single list).
+   int thr_num; // # of threads sharing the per-path loops of a word.
+   struct grp_task *grp; // Permutation groups.
+   thread_team *grp_team; // Threads of the groups, started once (NULL - the calling thread only).
 } cdc_inst_type;
 
+// Independent decoder of a permutation group.
+typedef struct grp_task {
+   decoder_type dc; // Shares node_table and permutation arrays with the main decoder.
+   double *y_in; // Decoder input.
+   int *x_dec; // Best candidate of the group.
+   double s_dec; // ... and its metric.
+} grp_task;
+
 
 //-----------------------------------------------------------------------------
 // Global data.
@@ -61,26 +88,107 @@ typedef struct {
 //-----------------------------------------------------------------------------
 // Internal functions.
 
-int get_membuf_size(decoder_type *dd) {
-   int flsiz = MAX(dd->peak_lsiz, dd->p_num) * FLSIZ_MULT;
-   int mem_buf_size = 0;
+size_t get_membuf_size(decoder_type *dd) {
+   int flsiz = DD_FLSIZ(dd);
+   size_t mem_buf_size = 0;
 
    mem_buf_size += dd->c_n * sizeof(ylitem); // y_in
+   mem_buf_size += (size_t)dd->p_num * dd->c_n * sizeof(ylitem); // y_perm
    mem_buf_size += flsiz * sizeof(int); // frind
    mem_buf_size += flsiz * sizeof(int); // lorder
-   mem_buf_size += (dd->c_k * flsiz + 1) * sizeof(xlist_item); // xlist
+   mem_buf_size += ((size_t)dd->c_k * flsiz + 1) * sizeof(xlist_item); // xlist
    mem_buf_size += flsiz * sizeof(xlist_item *); // lind2xl
    mem_buf_size += dd->c_m * flsiz * sizeof(ylitem *); // ylist
-   mem_buf_size += dd->c_m * sizeof(ylitem *) + (dd->c_n - 1) * MAX(dd->peak_lsiz, dd->p_num) * 4 * sizeof(ylitem); // yitems
+   mem_buf_size += dd->c_m * sizeof(ylitem *) + (size_t)(dd->c_n - 1) * MAX(dd->peak_lsiz, dd->p_num) * 4 * sizeof(ylitem); // yitems
    mem_buf_size += flsiz * sizeof(slitem); // slist
    mem_buf_size += flsiz * sizeof(int); // plist.
    mem_buf_size += dd->c_n * sizeof(xlitem); // xtmp.
    mem_buf_size += dd->c_n * sizeof(xlitem); // xtmp2.
    mem_buf_size += flsiz * sizeof(int); // parent.
+   mem_buf_size += dd->c_n * sizeof(double); // fht_llr.
+   mem_buf_size += dd->rm1_lsiz * sizeof(double); // fht_s.
+   mem_buf_size += 2 * flsiz * sizeof(slitem); // sbr.
+   mem_buf_size += dd->peak_lsiz * sizeof(slitem); // fht_heap.
+   mem_buf_size += (size_t)dd->rm1_lsiz * (dd->c_m + 1) * sizeof(int); // fht_x.
 
    return mem_buf_size;
 }
 
+// Split permutations to grp_num groups, each decoded with its own list.
+int init_groups(cdc_inst_type *dd) {
+   int g, p0, p1;
+
+   dd->grp = (grp_task *)malloc(dd->grp_num * sizeof(grp_task));
+   if (dd->grp == NULL) return RC_ERROR;
+   memset(dd->grp, 0, dd->grp_num * sizeof(grp_task));
+   for (g = 0; g < dd->grp_num; g++) {
+      p0 = dd->dc.p_num * g / dd->grp_num;
+      p1 = dd->dc.p_num * (g + 1) / dd->grp_num;
+      dd->grp[g].dc = dd->dc;
+      dd->grp[g].dc.p_num = p1 - p0;
+      dd->grp[g].dc.pxarr = dd->dc.pxarr + p0 * dd->c_k;
+      dd->grp[g].dc.pyarr = dd->dc.pyarr + p0 * dd->c_n;
+      dd->grp[g].dc.ret_s_sum = 0; // Groups are merged by the best metric.
+      dd->grp[g].dc.team = NULL;
+      dd->grp[g].dc.mem_buf = (uint8 *)malloc(get_membuf_size(&(dd->grp[g].dc)));
+      dd->grp[g].x_dec = (int *)malloc(dd->c_k * sizeof(int));
+      if ((dd->grp[g].dc.mem_buf == NULL) || (dd->grp[g].x_dec == NULL)) return RC_ERROR;
+   }
+   return RC_OK;
+}
+
+void free_groups(cdc_inst_type *dd) {
+   int g;
+
+   team_close(dd->grp_team);
+   dd->grp_team = NULL;
+   if (dd->grp == NULL) return;
+   for (g = 0; g < dd->grp_num; g++) {
+      if (dd->grp[g].dc.mem_buf != NULL) free(dd->grp[g].dc.mem_buf);
+      if (dd->grp[g].x_dec != NULL) free(dd->grp[g].x_dec);
+   }
+   free(dd->grp);
+   dd->grp = NULL;
+}
+
+// Groups [g0, g1).
+static void grp_job(void *arg, int g0, int g1) {
+   grp_task *grp = (grp_task *)arg;
+   int g;
+
+   for (g = g0; g < g1; g++) rm_dec(&(grp[g].dc), grp[g].y_in, grp[g].x_dec, &(grp[g].s_dec));
+}
+
+// Decode with the current peak_lsiz, with permutation groups if any.
+int dec_groups(cdc_inst_type *dd, double *dec_input, int *x_dec) {
+   int g, best = 0;
+
+   if (dd->grp_num <= 1) {
+      rm_dec(&(dd->dc), dec_input, x_dec, NULL);
+      // With pruning: the peak # of active paths.
+      if (dd->dc.prune_margin > 0.0) dd->last_lsiz = dd->dc.act_lsiz;
+      return RC_OK;
+   }
+
+   for (g = 0; g < dd->grp_num; g++) {
+      dd->grp[g].dc.peak_lsiz = dd->dc.peak_lsiz;
+      dd->grp[g].y_in = dec_input;
+   }
+   // A group is always worth a thread.
+   team_run(dd->grp_team, grp_job, dd->grp, dd->grp_num, TEAM_MIN_WORK);
+
+   // Merge: the best candidate over all groups.
+   for (g = 1; g < dd->grp_num; g++) {
+      if (dd->grp[g].s_dec > dd->grp[best].s_dec) best = g;
+   }
+   memcpy(x_dec, dd->grp[best].x_dec, dd->c_k * sizeof(int));
+   if (dd->dc.prune_margin > 0.0) {
+      dd->last_lsiz = 0;
+      for (g = 0; g < dd->grp_num; g++) dd->last_lsiz += dd->grp[g].dc.act_lsiz;
+   }
+   return RC_OK;
+}
+
 
 //-----------------------------------------------------------------------------
 // codec interface functions.
@@ -95,9 +203,11 @@ cdc_init(
    char *str1 = NULL, *token;
    int c_n = 0, c_k = 0, c_m = 0, c_r = 0;
    int i, j, i1, i2, pn;
-   int *p1, *px, *py;
-   int p_info[10000], inf_coeff[2048];
+   int *p1, *px, *py, *p2;
+   int *p_info = NULL, *inf_coeff = NULL, *inf_index = NULL;
+   int p_info_cap = 0;
    int p_num = 0;
+   int grp_num = 1;
 
    // Allocate decoder instance.
    dd = (cdc_inst_type *)malloc(sizeof(cdc_inst_type));
@@ -106,9 +216,10 @@ cdc_init(
       goto ret_err;
    }
    memset(dd, 0, sizeof(cdc_inst_type));
+   dd->thr_num = 1;
 
    // Allocate temporary string for parsing.
-   str1 = (char *)malloc(SP_STR_MAX);
+   str1 = (char *)malloc(strlen(param_str) + 1);
    if (str1 == NULL) {
       err_msg("cdc_init: Short of memory!");
       goto ret_err;
@@ -153,6 +264,15 @@ cdc_init(
             i1 = 0;
             p_num = 0;
             while (token[0] != GROUP_CHAR_END) {
+               if (i1 + c_m > p_info_cap) {
+                  p_info_cap = 2 * (i1 + c_m);
+                  p2 = (int *)realloc(p_info, p_info_cap * sizeof(int));
+                  if (p2 == NULL) {
+                     err_msg("cdc_init: Short of memory.");
+                     goto ret_err;
+                  }
+                  p_info = p2;
+               }
                for (i = 0; i < c_m; i++) {
                   p_info[i1++] = atoi(token);
                   token = strtok(NULL, tk_seps_prepared);
@@ -172,6 +292,14 @@ cdc_init(
          continue;
       }
       TRYGET_ONOFF_TOKEN(token, "use_variable_list", dd->use_var_list);
+      TRYGET_ONOFF_TOKEN(token, "adaptive_list", dd->adaptive_list);
+      TRYGET_FLOAT_TOKEN(token, "adaptive_threshold", dd->adaptive_t);
+      TRYGET_INT_TOKEN(token, "cascade_list_size", dd->cascade_lsiz);
+      TRYGET_FLOAT_TOKEN(token, "cascade_threshold", dd->cascade_t);
+      TRYGET_INT_TOKEN(token, "permutation_groups", grp_num);
+      TRYGET_FLOAT_TOKEN(token, "prune_margin", dd->dc.prune_margin);
+      TRYGET_INT_TOKEN(token, "rm1_list_size", dd->dc.rm1_lsiz);
+      TRYGET_INT_TOKEN(token, "list_threads", dd->thr_num);
       TRYGET_GRINTDOUBLE_TOKEN(token, "distance_threshold",
          dd->lsiz, dd->dist_t, dd->dist_t_n, VARL_NUM_MAX,
          "cdc_init: distance_threshold.");
@@ -189,6 +317,10 @@ cdc_init(
       err_msg("cdc_init: RM_m or RM_r are not specified.");
       goto ret_err;
    }
+   if ((c_m > CODE_M_MAX) || (c_r > c_m)) {
+      err_msg("cdc_init: RM_m or RM_r are out of range.");
+      goto ret_err;
+   }
    if (dd->dc.node_table_len == 0) {
       err_msg("cdc_init: No border nodes map.");
       goto ret_err;
@@ -201,9 +333,78 @@ cdc_init(
       err_msg("cdc_init: No distance_threshold.");
       goto ret_err;
    }
+   if (dd->adaptive_list && dd->use_var_list) {
+      err_msg("cdc_init: adaptive_list can't be used with use_variable_list.");
+      goto ret_err;
+   }
+   if (dd->adaptive_list && (dd->adaptive_t <= 0.0)) {
+      err_msg("cdc_init: adaptive_list needs a positive adaptive_threshold.");
+      goto ret_err;
+   }
+   if (dd->adaptive_list) {
+      // The stages of use_variable_list: L = 1, 2, 4, ... up to border_node_lsize,
+      // the last one is accepted anyway.
+      dd->dist_t_n = 0;
+      for (i = 1; ; i *= 2) {
+         i = MIN(i, dd->dc.peak_lsiz);
+         dd->lsiz[dd->dist_t_n] = i;
+         dd->dist_t[dd->dist_t_n++] = (i < dd->dc.peak_lsiz) ? dd->adaptive_t : HUGE_VAL;
+         if (i == dd->dc.peak_lsiz) break;
+      }
+      dd->use_var_list = 1;
+   }
+   if (dd->cascade_lsiz < 0) {
+      err_msg("cdc_init: cascade_list_size must be positive.");
+      goto ret_err;
+   }
+   if ((dd->cascade_lsiz > 0) && dd->use_var_list) {
+      err_msg("cdc_init: cascade_list_size can't be used with use_variable_list or adaptive_list.");
+      goto ret_err;
+   }
+   if ((dd->cascade_lsiz > 0) && (dd->cascade_t <= 0.0)) {
+      err_msg("cdc_init: cascade_list_size needs a positive cascade_threshold.");
+      goto ret_err;
+   }
+   if (dd->cascade_lsiz > 0) {
+      // Two stages of use_variable_list: border_node_lsize, then cascade_list_size
+      // (accepted anyway) for the words too far from the channel output.
+      dd->lsiz[0] = dd->dc.peak_lsiz;
+      dd->dist_t[0] = dd->cascade_t;
+      dd->lsiz[1] = dd->cascade_lsiz;
+      dd->dist_t[1] = HUGE_VAL;
+      dd->dist_t_n = 2;
+      dd->use_var_list = 1;
+   }
+   if ((grp_num < 1) || (grp_num > GRP_NUM_MAX)) {
+      err_msg("cdc_init: permutation_groups is out of range.");
+      goto ret_err;
+   }
+   if (dd->dc.prune_margin < 0.0) {
+      err_msg("cdc_init: prune_margin must be positive.");
+      goto ret_err;
+   }
+   if ((dd->dc.rm1_lsiz < 0) || (dd->dc.rm1_lsiz > RM1_LSIZ_MAX)) {
+      err_msg("cdc_init: rm1_list_size is out of range.");
+      goto ret_err;
+   }
+   if ((dd->thr_num < 1) || (dd->thr_num > TEAM_THR_MAX)) {
+      err_msg("cdc_init: list_threads is out of range.");
+      goto ret_err;
+   }
+   if ((dd->thr_num > 1) && (grp_num > 1)) {
+      err_msg("cdc_init: list_threads > 1 needs permutation_groups 1.");
+      goto ret_err;
+   }
 
    // Complete settings.
    dd->c_n = dd->dc.c_n = c_n = 1 << c_m;
+   if (dd->use_var_list) {
+      // Node list sizes are limited by the list size of each stage when decoding.
+      for (i = 0; i < dd->dist_t_n; i++)
+         dd->dc.peak_lsiz = MAX(dd->dc.peak_lsiz, dd->lsiz[i]);
+   }
+   dd->max_lsiz = dd->last_lsiz = dd->dc.peak_lsiz;
+   dd->last_stage = 1;
    for (i = 0; i < dd->dc.node_table_len; i++)
       dd->dc.node_table[i] = (dd->dc.node_table[i] == 0) ? 0 : dd->dc.peak_lsiz;
    dd->c_k = dd->dc.c_k = c_k = calc_srm_k(c_m, c_r, dd->dc.node_table);
@@ -212,14 +413,19 @@ cdc_init(
    if (p_num == 0) {
       // permutations parameter was not given => only one permutation
       // (0 1 ... m-1) (no permutation).
+      p_info = (int *)malloc(c_m * sizeof(int));
+      if (p_info == NULL) {
+         err_msg("cdc_init: Short of memory.");
+         goto ret_err;
+      }
       for (i = 0; i < c_m; i++) p_info[i] = i;
       p_num = 1;
    }
    dd->dc.p_num = p_num;
    if (p_num > 0) {
-      dd->dc.pxarr = (int *)malloc(p_num * c_k * sizeof(int));
-      dd->dc.pyarr = (int *)malloc(p_num * c_n * sizeof(int));
-      if ((dd->dc.pxarr == NULL) || (dd->dc.pxarr == NULL)) {
+      dd->dc.pxarr = (int *)malloc((size_t)p_num * c_k * sizeof(int));
+      dd->dc.pyarr = (int *)malloc((size_t)p_num * c_n * sizeof(int));
+      if ((dd->dc.pxarr == NULL) || (dd->dc.pyarr == NULL)) {
          err_msg("cdc_init: Short of memory.");
          goto ret_err;
       }
@@ -228,7 +434,14 @@ cdc_init(
       p1 = p_info;
    }
    // Calculate inf_coeff[]. It contains all integers with weight <= c_r
-   // in reverse lexicographic order.
+   // in reverse lexicographic order. inf_index[] is the inverse of its first
+   // c_k items (c_k for the other positions).
+   inf_coeff = (int *)malloc(calc_rm_k(c_m, c_r) * sizeof(int));
+   inf_index = (int *)malloc(c_n * sizeof(int));
+   if ((inf_coeff == NULL) || (inf_index == NULL)) {
+      err_msg("cdc_init: Short of memory.");
+      goto ret_err;
+   }
    i1 = 0;
    for (i = c_n - 1; i >= 0; i--) {
       // i2 <-- weight(i);
@@ -236,6 +449,8 @@ cdc_init(
       for (j = 1; j < c_m; j++) i2 += (i >> j) & 1;
       if (i2 <= c_r) inf_coeff[i1++] = i;
    }
+   for (i = 0; i < c_n; i++) inf_index[i] = c_k;
+   for (i = 0; i < c_k; i++) inf_index[inf_coeff[i]] = i;
    // Generate permutation arrays.
    for (pn = 0; pn < p_num; pn++) {
       // Next permutation for y.
@@ -252,14 +467,16 @@ cdc_init(
          i1 = 0;
          i2 = inf_coeff[i];
          for (j = 0; j < c_m; j++) i1 |= ((i2 >> j) & 1) << p1[j];
-         for (j = 0; j < c_k; j++) if (inf_coeff[j] == i1) break;
-         px[i] = j;
+         px[i] = inf_index[i1];
       }
       // for (i = 0; i < c_k; i++) msg_printf("%d ", px[i]); // DDD
       // msg_printf("\n"); // DDD
       px += c_k;
       p1 += c_m;
    }
+   free(p_info); p_info = NULL;
+   free(inf_coeff); inf_coeff = NULL;
+   free(inf_index); inf_index = NULL;
 
 #ifdef FORMAT_Q
    if (dec_tables_init()) {
@@ -275,6 +492,31 @@ cdc_init(
       goto ret_err;
    }
 
+   // Permutation groups.
+   dd->grp_num = MIN(grp_num, p_num);
+   if ((dd->grp_num > 1) && (init_groups(dd) != RC_OK)) {
+      err_msg("cdc_init: Short of memory.");
+      goto ret_err;
+   }
+#ifdef USE_PTHREADS
+   if (dd->grp_num > 1) {
+      dd->grp_team = team_init(MIN(dd->grp_num, TEAM_THR_MAX));
+      if (dd->grp_team == NULL) {
+         err_msg("cdc_init: cannot start permutation_groups threads.");
+         goto ret_err;
+      }
+   }
+#endif
+
+   // Threads for the per-path loops.
+   if (dd->thr_num > 1) {
+      dd->dc.team = team_init(dd->thr_num);
+      if (dd->dc.team == NULL) {
+         err_msg("cdc_init: cannot start list_threads threads.");
+         goto ret_err;
+      }
+   }
+
    (*cdc) = dd;
 
    return 0;
@@ -282,7 +524,12 @@ cdc_init(
 ret_err:
 
    if (str1 != NULL) free(str1);
+   if (p_info != NULL) free(p_info);
+   if (inf_coeff != NULL) free(inf_coeff);
+   if (inf_index != NULL) free(inf_index);
    if (dd != NULL) {
+      free_groups(dd);
+      team_close(dd->dc.team);
       if (dd->dc.mem_buf != NULL) free(dd->dc.mem_buf);
       if (dd->dc.pxarr != NULL) free(dd->dc.pxarr);
       if (dd->dc.pyarr != NULL) free(dd->dc.pyarr);
@@ -302,6 +549,8 @@ cdc_close(
 
    if (cdc == NULL) return;
    dd = (cdc_inst_type *)cdc;
+   free_groups(dd);
+   team_close(dd->dc.team);
    if (dd->dc.mem_buf != NULL) free(dd->dc.mem_buf);
    if (dd->dc.node_table != NULL) free(dd->dc.node_table);
    if (dd->dc.pxarr != NULL) free(dd->dc.pxarr);
@@ -342,6 +591,28 @@ cdc_set_sg(
    dd->sg22 = 2.0 / (noise_sg * noise_sg);
 }
 
+#ifdef DEC_HAS_STATS
+int cdc_get_lsiz(void *cdc)
+{
+   cdc_inst_type *dd;
+
+   if (cdc == NULL) return 0;
+   dd = (cdc_inst_type *)cdc;
+   return dd->last_lsiz;
+}
+#endif // DEC_HAS_STATS
+
+#ifdef DEC_HAS_STAGES
+int cdc_get_stage(void *cdc)
+{
+   cdc_inst_type *dd;
+
+   if (cdc == NULL) return 0;
+   dd = (cdc_inst_type *)cdc;
+   return dd->last_stage;
+}
+#endif // DEC_HAS_STAGES
+
 void
 cdc_set_csnrn(
    void *cdc,
@@ -352,7 +623,7 @@ cdc_set_csnrn(
 
    dd = (cdc_inst_type *)cdc;
    dd->csnrn = csnrn;
-   if ((dd->use_var_list != 0) && (dd->dist_t_n <= csnrn)) {
+   if ((dd->use_var_list != 0) && !dd->adaptive_list && (dd->cascade_lsiz == 0) && (dd->dist_t_n <= csnrn)) {
       err_msg("cdc_set_csnrn: dist_t_n <= csnrn.");
    }
 }
@@ -379,9 +650,9 @@ dec_bpsk(
 {
    cdc_inst_type *dd;
    double *dec_input, *y_dec;
-   // int max_peak_lsiz;
    void *mem_buf;
    int i, j;
+   int rc = RC_OK;
    double d1;
 
    dd = (cdc_inst_type *)cdc;
@@ -396,16 +667,17 @@ dec_bpsk(
    // dec_input <-- 2 * c_out / sg^2.
    for (i = 0; i < dd->c_n; i++) dec_input[i] = c_out[i] * dd->sg22;
 
-   if (dd->use_var_list == 0)
-      rm_dec(&(dd->dc), dec_input, x_dec, NULL);
+   dd->last_stage = 1;
+   if (dd->use_var_list == 0) {
+      rc = dec_groups(dd, dec_input, x_dec);
+   }
    else {
       y_dec = ((double *)mem_buf) + dd->c_n;
-      // max_peak_lsiz = dd->dc.peak_lsiz;
       for (i = 0; i < dd->dist_t_n; i++) {
-         dd->dc.peak_lsiz = dd->lsiz[i];
-         for (j = 0; j < dd->dc.node_table_len; j++)
-            dd->dc.node_table[j] = (dd->dc.node_table[j] == 0) ? 0 : dd->lsiz[i];
-         rm_dec(&(dd->dc), dec_input, x_dec, NULL);
+         dd->dc.peak_lsiz = dd->last_lsiz = dd->lsiz[i];
+         dd->last_stage = i + 1;
+         rc = dec_groups(dd, dec_input, x_dec);
+         if (rc != RC_OK) break;
          enc_bpsk(cdc, x_dec, y_dec);
          d1 = 0.0;
          // d1 <-- dist(dec_input, y_dec).
@@ -416,10 +688,10 @@ dec_bpsk(
       }
       // msg_printf("i = %d, d1 = %g.\n", i, d1);
       // msg_flush();
-      // dd->dc.peak_lsiz = max_peak_lsiz;
+      dd->dc.peak_lsiz = dd->max_lsiz;
    }
 
    free(mem_buf);
 
-   return 0;
+   return rc;
 }
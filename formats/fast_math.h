@@ -0,0 +1,251 @@
+//=============================================================================
+// Fast approximations of exp(), log(), log1p() and expm1() for the format macros.
+// With FORMAT_FAST_MATH defined globally FM_EXP(), FM_LOG(), FM_LOG1P() and
+// FM_EXPM1() are the polynomial approximations below, otherwise they are the libm
+// functions.
+//
+// fm_exp: 2^n * e^r, |r| <= ln(2) / 2, degree 7 Taylor polynomial,
+//   relative error < 1e-8 for |x| < 708, clamped outside.
+// fm_log: n * ln(2) + 2 atanh(s), s = (m - 1) / (m + 1), m in [sqrt(1/2), sqrt(2)),
+//   degree 9 odd series, absolute error < 1e-9 for normal x > 0
+//   (no checks for 0, negative or denormal x).
+// fm_log1p: the same series with s = x / (2 + x) for |x| < 1/4,
+//   relative error < 1e-9 there.
+// fm_log1pf: FM_LOGF(1 + x) corrected by the rounding error of 1 + x, a few ulp
+//   (log1pf() of glibc is 1.5-2 times slower than logf()).
+// fm_expm1: degree 8 Taylor polynomial for |x| < 1/4, fm_exp(x) - 1 otherwise,
+//   relative error < 1e-9 near 0.
+// fm_log_lin: n * ln(2) + (m - 1) * ln(2), m in [1, 2) (the bits of x read
+//   as an integer), shifted by half of the max error: absolute error < 0.03
+//   for normal x > 0. No polynomial, for the approximate path metrics.
+// fm_log_linf: the same for float.
+// fm_xor_llr: LLR of the XOR of two bits, ln((1 + e^(y1 + y2)) / (e^y1 + e^y2)),
+//   with exp() of non-positive arguments only (no overflow). fm_xor_llrf: for float.
+// fm_exp() and fm_log() have no branches, so the loops over them vectorize.
+//
+// FM_Y*() and FM_S*() are the literals and the math functions in the type of
+// the reliabilities (ylitem) and of the path metrics (slitem): float for
+// FORMAT_FLOAT (both) and FORMAT_MIXED (ylitem only), double otherwise.
+// The polynomial approximations are double only, FM_EXPF() and the like
+// round their results to float.
+//
+// Copyright 2019 and onwards Kirill Shabunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=============================================================================
+
+#ifndef FAST_MATH_H
+
+#define FAST_MATH_H
+
+//-----------------------------------------------------------------------------
+// Includes.
+
+#include <math.h>
+#include "../common/typedefs.h"
+
+//-----------------------------------------------------------------------------
+// Defines
+
+#define FM_LN2_HI 6.93147180369123816490e-01
+#define FM_LN2_LO 1.90821492927058770002e-10
+#define FM_LOG2E 1.44269504088896338700
+#define FM_SQRT2 1.41421356237309504880
+
+// ln(2) / 2^52 and 1023 ln(2) - ln(2) max(log2(1 + f) - f) / 2.
+#define FM_LN2_ULP 1.539095918623324e-16
+#define FM_LOG_LIN_BIAS 709.0597356622533
+// ln(2) / 2^23 and ln(2) max(log2(1 + f) - f) / 2.
+#define FM_LN2_ULPF 8.262958294867817e-08f
+#define FM_LOG_LIN_SHIFTF 0.029830050570804817f
+
+// exp() is clamped to [e^-FM_EXP_MAX, e^FM_EXP_MAX].
+#define FM_EXP_MAX 708.0
+
+// 1.5 * 2^52: adding it rounds to an integer.
+#define FM_ROUND_MAGIC 6755399441055744.0
+
+#ifdef FORMAT_FAST_MATH
+#define FM_EXP(x) fm_exp(x)
+#define FM_LOG(x) fm_log(x)
+#define FM_LOG1P(x) fm_log1p(x)
+#define FM_EXPM1(x) fm_expm1(x)
+#define FM_EXPF(x) ((float)fm_exp(x))
+#define FM_LOGF(x) ((float)fm_log(x))
+#define FM_EXPM1F(x) ((float)fm_expm1(x))
+#else
+#define FM_EXP(x) exp(x)
+#define FM_LOG(x) log(x)
+#define FM_LOG1P(x) log1p(x)
+#define FM_EXPM1(x) expm1(x)
+#define FM_EXPF(x) expf(x)
+#define FM_LOGF(x) logf(x)
+#define FM_EXPM1F(x) expm1f(x)
+#endif
+#define FM_LOG1PF(x) fm_log1pf(x)
+
+#if defined(FORMAT_FLOAT) || defined(FORMAT_MIXED)
+#define FM_Y_(x) x##f
+#define FM_Y(x) FM_Y_(x)
+#define FM_YEXP(x) FM_EXPF(x)
+#define FM_YLOG(x) FM_LOGF(x)
+#define FM_YLOG_LIN(x) fm_log_linf(x)
+#define FM_YXOR_LLR(y1, y2) fm_xor_llrf(y1, y2)
+#define FM_YABS(x) fabsf(x)
+#else
+#define FM_Y(x) x
+#define FM_YEXP(x) FM_EXP(x)
+#define FM_YLOG(x) FM_LOG(x)
+#define FM_YLOG_LIN(x) fm_log_lin(x)
+#define FM_YXOR_LLR(y1, y2) fm_xor_llr(y1, y2)
+#define FM_YABS(x) fabs(x)
+#endif
+
+#ifdef FORMAT_FLOAT
+#define FM_S_(x) x##f
+#define FM_S(x) FM_S_(x)
+#define FM_S_HUGE HUGE_VALF
+#define FM_SEXP(x) FM_EXPF(x)
+#define FM_SLOG(x) FM_LOGF(x)
+#define FM_SLOG1P(x) FM_LOG1PF(x)
+#else
+#define FM_S(x) x
+#define FM_S_HUGE HUGE_VAL
+#define FM_SEXP(x) FM_EXP(x)
+#define FM_SLOG(x) FM_LOG(x)
+#define FM_SLOG1P(x) FM_LOG1P(x)
+#endif
+
+//-----------------------------------------------------------------------------
+// Functions.
+
+// 2 atanh(s) for |s| <= 0.172.
+static inline double fm_atanh2(double s) {
+   double s2 = s * s;
+
+   return 2.0 * s * (1.0 + s2 * (1.0 / 3.0 + s2 * (1.0 / 5.0 + s2 * (1.0 / 7.0 + s2 * (1.0 / 9.0)))));
+}
+
+static inline double fm_exp(double x) {
+   union { double d; uint64 u; } nr, sc;
+   double n, r, p;
+
+   x = (x > FM_EXP_MAX) ? FM_EXP_MAX : x;
+   x = (x < -FM_EXP_MAX) ? -FM_EXP_MAX : x;
+   // Round to the nearest integer: n is in the low mantissa bits of nr.
+   nr.d = x * FM_LOG2E + FM_ROUND_MAGIC;
+   n = nr.d - FM_ROUND_MAGIC;
+   r = (x - n * FM_LN2_HI) - n * FM_LN2_LO;
+   p = 1.0 + r * (1.0 + r * (1.0 / 2 + r * (1.0 / 6 + r * (1.0 / 24 + r * (1.0 / 120 +
+      r * (1.0 / 720 + r * (1.0 / 5040)))))));
+   sc.u = (nr.u + 1023) << 52;
+   return p * sc.d;
+}
+
+static inline double fm_log(double x) {
+   union { double d; uint64 u; } xm;
+   double m, e;
+
+   xm.d = x;
+   // x = m * 2^e, m in [sqrt(1/2), sqrt(2)).
+   e = (double)(int64)((xm.u >> 52) & 0x7ff) - 1023.0;
+   xm.u = (xm.u & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL;
+   m = xm.d;
+   e = (m > FM_SQRT2) ? e + 1.0 : e;
+   m = (m > FM_SQRT2) ? 0.5 * m : m;
+   return e * FM_LN2_HI + (fm_atanh2((m - 1.0) / (m + 1.0)) + e * FM_LN2_LO);
+}
+
+static inline float fm_log1pf(float x) {
+   float u = 1.0f + x;
+
+   return FM_LOGF(u) + (x - (u - 1.0f)) / u;
+}
+
+static inline double fm_expm1(double x) {
+   if ((x > -0.25) && (x < 0.25)) {
+      return x * (1.0 + x * (1.0 / 2.0 + x * (1.0 / 6.0 + x * (1.0 / 24.0 + x * (1.0 / 120.0
+         + x * (1.0 / 720.0 + x * (1.0 / 5040.0 + x * (1.0 / 40320.0))))))));
+   }
+   return fm_exp(x) - 1.0;
+}
+
+static inline double fm_log_lin(double x) {
+   union { double d; uint64 u; } xu;
+
+   xu.d = x;
+   return (double)(int64)xu.u * FM_LN2_ULP - FM_LOG_LIN_BIAS;
+}
+
+static inline float fm_log_linf(float x) {
+   union { float f; uint32 u; } xu;
+
+   xu.f = x;
+   return (float)((int32)xu.u - 0x3f800000) * FM_LN2_ULPF + FM_LOG_LIN_SHIFTF;
+}
+
+static inline double fm_log1p(double x) {
+   if ((x > -0.25) && (x < 0.25)) return fm_atanh2(x / (2.0 + x));
+   return fm_log(1.0 + x);
+}
+
+// a, b = |y1|, |y2|, a <= b: ln(1 + (1 - e^-a)(1 - e^-b) / (e^-a + e^-b)) with
+// 1 - e^-a taken by expm1() keeps the precision of the weak estimates,
+// a + ln((1 + e^-(a + b)) / (1 + e^-(b - a))) is used for the strong ones.
+static inline double fm_xor_llr(double y1, double y2) {
+   double a, b, ea, eb, r;
+
+   a = fabs(y1);
+   b = fabs(y2);
+   if (a > b) {
+      r = a;
+      a = b;
+      b = r;
+   }
+   if (a < 1.0) {
+      ea = -FM_EXPM1(-a);
+      eb = -FM_EXPM1(-b);
+      r = FM_LOG1P(ea * eb / (2.0 - ea - eb));
+   }
+   else {
+      ea = FM_EXP(-(a + b));
+      eb = FM_EXP(a - b);
+      r = a + FM_LOG((1.0 + ea) / (1.0 + eb));
+   }
+   return ((y1 < 0.0) != (y2 < 0.0)) ? -r : r;
+}
+
+static inline float fm_xor_llrf(float y1, float y2) {
+   float a, b, ea, eb, r;
+
+   a = fabsf(y1);
+   b = fabsf(y2);
+   if (a > b) {
+      r = a;
+      a = b;
+      b = r;
+   }
+   if (a < 1.0f) {
+      ea = -FM_EXPM1F(-a);
+      eb = -FM_EXPM1F(-b);
+      r = FM_LOG1PF(ea * eb / (2.0f - ea - eb));
+   }
+   else {
+      ea = FM_EXPF(-(a + b));
+      eb = FM_EXPF(a - b);
+      r = a + FM_LOGF((1.0f + ea) / (1.0f + eb));
+   }
+   return ((y1 < 0.0f) != (y2 < 0.0f)) ? -r : r;
+}
+
+#endif // #ifndef FAST_MATH_H
@@ -27,24 +27,35 @@
 #define FORMAT_EPS
 #define FORMAT_USE_CLIPPING
 
+// 1 - CLIP_EPS must stay below 1 in the ylitem type.
+#if defined(FORMAT_FLOAT) || defined(FORMAT_MIXED)
+#define CLIP_EPS 1e-6
+#else
 #define CLIP_EPS 1e-8
-#define CLIP_T (1.0 - CLIP_EPS)
+#endif
+#define CLIP_T (FM_Y(1.0) - FM_Y(CLIP_EPS))
 
 #define FORMAT_CLIP(e) { \
    if ((e) > CLIP_T) (e) = CLIP_T; \
    if ((e) < -CLIP_T) (e) = -CLIP_T; \
 }
 
-#define STRONGEST_EST0 (1.0)
+#define STRONGEST_EST0 FM_Y(1.0)
 
-#define YLDEC0 1.0
-#define YLDEC1 (-1.0)
+#define YLDEC0 FM_Y(1.0)
+#define YLDEC1 (-FM_Y(1.0))
 
-#define EPS2LOGP0(e) log(1.0 + (e))
-#define EPS2LOGP1(e) log(1.0 - (e))
+#ifdef FORMAT_FLOAT
+// 1 + e in float would round off the weak estimates.
+#define EPS2LOGP0(e) FM_SLOG1P(e)
+#define EPS2LOGP1(e) FM_SLOG1P(-(e))
+#else
+#define EPS2LOGP0(e) FM_LOG(1.0 + (e))
+#define EPS2LOGP1(e) FM_LOG(1.0 - (e))
+#endif
 
 // True if estimate votes for 0.
-#define CHECK_EST0(y) ((y) > 0.0)
+#define CHECK_EST0(y) ((y) > FM_Y(0.0))
 
 // True if e1 is a stronger estimate of 0 than est2.
 #define STRONGER_EST0(e1, e2) ((e1) > (e2))
@@ -52,6 +63,33 @@
 // Invert the estimate.
 #define INV_EST(y) (-(y))
 
+#ifdef PM_LLR_APPROX
+// LLR-domain path metric: 0 for the decision agreeing with the estimate,
+// -|LLR| for the other one. The LLR is taken with the piecewise linear
+// log of fast_math.h (error < 0.03), no log() per update.
+#define EPS2LLR_LIN(e) FM_YLOG_LIN((FM_Y(1.0) + (e)) / (FM_Y(1.0) - (e)))
+
+// ln(Pr{y = 0 | y}).
+#define EST_TO_LNP0(y) (CHECK_EST0(y) ? FM_S(0.0) : EPS2LLR_LIN(y))
+
+// ln(Pr{y = 1 | y}).
+#define EST_TO_LNP1(y) (CHECK_EST0(y) ? -EPS2LLR_LIN(y) : FM_S(0.0))
+
+// ln(Pr{y = 0 | y}) for y voting for 0.
+#define EST0_TO_LNP0(y) FM_S(0.0)
+// ln(Pr{y = 0 | y}) for y voting for 1.
+#define EST1_TO_LNP0(y) EPS2LLR_LIN(y)
+
+// ln(Pr{y = 1 | y}) for y voting for 0.
+#define EST0_TO_LNP1(y) (-EPS2LLR_LIN(y))
+// ln(Pr{y = 1 | y}) for y voting for 1.
+#define EST1_TO_LNP1(y) FM_S(0.0)
+
+// EST0_TO_LNP1(y) - EST0_TO_LNP0(y).
+#define EST0_ADD_LNP1_SUB_LNP0(y) (-EPS2LLR_LIN(y))
+
+#else // PM_LLR_APPROX
+
 // ln(Pr{y = 0 | y}).
 #define EST_TO_LNP0(y) EPS2LOGP0(y)
 
@@ -69,15 +107,17 @@
 #define EST1_TO_LNP1(y) EPS2LOGP1(y)
 
 // EST0_TO_LNP1(y) - EST0_TO_LNP0(y).
-#define EST0_ADD_LNP1_SUB_LNP0(y) log((1.0 - (y)) / (1.0 + (y)))
+#define EST0_ADD_LNP1_SUB_LNP0(y) FM_SLOG((FM_S(1.0) - (y)) / (FM_S(1.0) + (y)))
+
+#endif // PM_LLR_APPROX
 
 // Convert estimate to log likelihood ratio.
-#define EST2LLR(e) log((1.0 + (e)) / (1.0 - (e)))
+#define EST2LLR(e) FM_YLOG((FM_Y(1.0) + (e)) / (FM_Y(1.0) - (e)))
 
 #define XOR_EST(y1, y2) ((y1) * (y2))
 
 #define ADD_EST(y1, y2, y3) { \
-   y3 = ((y1) + (y2)) / (1.0 + (y1) * (y2)); \
+   y3 = ((y1) + (y2)) / (FM_Y(1.0) + (y1) * (y2)); \
    FORMAT_CLIP(y3); \
 }
 
@@ -90,7 +130,15 @@
 // List items typedefs.
 
 typedef int xlitem;
+#if defined(FORMAT_FLOAT) || defined(FORMAT_MIXED)
+typedef float ylitem;
+#else
 typedef double ylitem;
+#endif
+#ifdef FORMAT_FLOAT
+typedef float slitem;
+#else
 typedef double slitem;
+#endif
 
 #endif // #ifndef FORMAT_EPS5_H
\ No newline at end of file
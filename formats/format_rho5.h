@@ -29,20 +29,28 @@
 // Includes.
 
 #include "../common/std_defs.h"
+#include "fast_math.h"
 
 //-----------------------------------------------------------------------------
 // Defines
 
+#if defined(FORMAT_FLOAT) || defined(FORMAT_MIXED)
+#define STRONGEST_EST0 FM_Y(1e38)
+#else
 #define STRONGEST_EST0 (1e300)
+#endif
 
-#define YLDEC0 1.0
-#define YLDEC1 (-1.0)
+#define YLDEC0 FM_Y(1.0)
+#define YLDEC1 (-FM_Y(1.0))
 
-#define RHO2LOGP0(e) (-log(1.0 + exp(-(e))))
-#define RHO2LOGP1(e) (-log(1.0 + exp(e)))
+// ln(1 + e^x) without the overflow of exp() for large x.
+#define RHO2SOFTPLUS(x) (((x) > FM_S(0.0)) ? (x) + FM_SLOG1P(FM_SEXP(-(x))) : FM_SLOG1P(FM_SEXP(x)))
+
+#define RHO2LOGP0(e) (-RHO2SOFTPLUS(-(e)))
+#define RHO2LOGP1(e) (-RHO2SOFTPLUS(e))
 
 // True if estimate votes for 0.
-#define CHECK_EST0(y) ((y) > 0.0)
+#define CHECK_EST0(y) ((y) > FM_Y(0.0))
 
 // True if e1 is a stronger estimate of 0 than est2.
 #define STRONGER_EST0(e1, e2) ((e1) > (e2))
@@ -50,6 +58,28 @@
 // Invert the estimate.
 #define INV_EST(y) (-(y))
 
+#ifdef PM_LLR_APPROX
+// LLR-domain path metric: 0 for the decision agreeing with the estimate,
+// -|LLR| for the other one (no transcendental functions).
+
+// ln(Pr{y = 0 | y}).
+#define EST_TO_LNP0(y) (CHECK_EST0(y) ? FM_S(0.0) : (y))
+
+// ln(Pr{y = 1 | y}).
+#define EST_TO_LNP1(y) (CHECK_EST0(y) ? -(y) : FM_S(0.0))
+
+// ln(Pr{y = 0 | y}) for y voting for 0.
+#define EST0_TO_LNP0(y) FM_S(0.0)
+// ln(Pr{y = 0 | y}) for y voting for 1.
+#define EST1_TO_LNP0(y) (y)
+
+// ln(Pr{y = 1 | y}) for y voting for 0.
+#define EST0_TO_LNP1(y) (-(y))
+// ln(Pr{y = 1 | y}) for y voting for 1.
+#define EST1_TO_LNP1(y) FM_S(0.0)
+
+#else // PM_LLR_APPROX
+
 // ln(Pr{y = 0 | y}).
 #define EST_TO_LNP0(y) RHO2LOGP0(y)
 
@@ -66,14 +96,16 @@
 // ln(Pr{y = 1 | y}) for y voting for 1.
 #define EST1_TO_LNP1(y) RHO2LOGP1(y)
 
+#endif // PM_LLR_APPROX
+
 // EST0_TO_LNP1(y) - EST0_TO_LNP0(y).
 #define EST0_ADD_LNP1_SUB_LNP0(y) (-(y))
 
 // Convert estimate to log likelihood ratio.
 #define EST2LLR(e) (e)
 
-#define XOR_EST(y1, y2) ((ABSF(y1) < ABSF(y2)) ? (((y1) * (y2) > 0.0) ? ABSF(y1) : -ABSF(y1)) : \
-   (((y1) * (y2) > 0.0) ? ABSF(y2) : -ABSF(y2)))
+#define XOR_EST(y1, y2) ((FM_YABS(y1) < FM_YABS(y2)) ? (((y1) * (y2) > FM_Y(0.0)) ? FM_YABS(y1) : -FM_YABS(y1)) : \
+   (((y1) * (y2) > FM_Y(0.0)) ? FM_YABS(y2) : -FM_YABS(y2)))
 
 #define ADD_EST(y1, y2, y3) {y3 = (y1) + (y2);}
 
@@ -86,7 +118,15 @@
 // List items typedefs.
 
 typedef int xlitem;
+#if defined(FORMAT_FLOAT) || defined(FORMAT_MIXED)
+typedef float ylitem;
+#else
 typedef double ylitem;
+#endif
+#ifdef FORMAT_FLOAT
+typedef float slitem;
+#else
 typedef double slitem;
+#endif
 
 #endif // #ifndef FORMAT_RHO5_H
\ No newline at end of file
@@ -23,10 +23,21 @@
 //-----------------------------------------------------------------------------
 // Configuration switches.
 
+// The format is eps5 unless one of these is defined globally:
+// FORMAT_SEL_RHO1 - LLR, exact; FORMAT_SEL_RHO5 - LLR, min/sum.
+// PM_LLR_APPROX (defined globally) - LLR-domain approximation of the path
+// metrics in the list decoders, see format_*.h.
+// FORMAT_FLOAT (defined globally) - float reliabilities (ylitem) and path
+// metrics (slitem); FORMAT_MIXED - float reliabilities, double path metrics.
+// Both halve the list buffers; the eps formats clip at 1 - 1e-6 then.
+// FORMAT_FAST_MATH (defined globally) - polynomial exp(), log() and log1p()
+// in the format macros, see fast_math.h.
+
 //-----------------------------------------------------------------------------
 // Includes.
 
 #include <math.h>
+#include "fast_math.h"
 
 //#include "format_gm1.h"
 //#include "format_gm2.h"
@@ -37,7 +48,9 @@
 //#include "format_eps3.h"
 //#include "format_eps4.h" // eps., approx.
 //#include "format_eps4h.h" // eps., approx., hard input.
+#if !defined(FORMAT_SEL_RHO1) && !defined(FORMAT_SEL_RHO5)
 #include "format_eps5.h" // eps, exact, clipping.
+#endif
 //#include "format_eps5h.h" // eps, exact, hard input, clipping.
 //#include "format_eps6.h"
 //#include "format_eps6a.h"
@@ -45,12 +58,16 @@
 //#include "format_eps7.h"
 //#include "format_eps8.h"
 
-//#include "format_rho1.h" // LLR, exact.
+#ifdef FORMAT_SEL_RHO1
+#include "format_rho1.h" // LLR, exact.
+#endif
 //#include "format_rho2.h"
 //#include "format_rho3.h"
 //#include "format_rho3h.h"
 //#include "format_rho4.h"
-//#include "format_rho5.h" // LLR, min/sum.
+#ifdef FORMAT_SEL_RHO5
+#include "format_rho5.h" // LLR, min/sum.
+#endif
 //#include "format_rho6.h"
 //#include "format_rho6a.h"
 //#include "format_rho7.h"
@@ -85,8 +102,8 @@
 #define VY_TO_FORMAT(y, e, n) { \
    int i; \
    for (i = 0; i < n; i++) { \
-      e[i] = exp(y[i]); \
-      e[i] = (1.0 - e[i]) / (1.0 + e[i]); \
+      e[i] = FM_YEXP((ylitem)y[i]); \
+      e[i] = (FM_Y(1.0) - e[i]) / (FM_Y(1.0) + e[i]); \
       FORMAT_CLIP(e[i]); \
    } \
 }
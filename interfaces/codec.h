@@ -25,6 +25,10 @@
 
 // #define DEC_NEEDS_SIGMA
 // #define DEC_NEEDS_CSNRN
+// #define DEC_HAS_STATS
+// #define DEC_HAS_SOFT
+// #define DEC_HAS_STAGES
+// #define DEC_HAS_BATCH
 
 // Decoder extra return codes
 #define RC_DEC_ERASURE 1
@@ -71,6 +75,46 @@ dec_bpsk(
    int xd[]
 );
 
+#ifdef DEC_HAS_STATS
+// List size used to decode the last word (adaptive list decoders).
+int cdc_get_lsiz(void *cdc);
+#endif // DEC_HAS_STATS
+
+#ifdef DEC_HAS_STAGES
+// Stage of the cascade decoder that gave the last word (1 - the first stage).
+int cdc_get_stage(void *cdc);
+#endif // DEC_HAS_STAGES
+
+#ifdef DEC_HAS_SOFT
+// Soft-output decoding of nfr words at once (c_out - nfr * n items).
+// LLRs are ln(Pr{0} / Pr{1}): llr_cw - extrinsic LLRs of the codeword bits
+// (nfr * n items), llr_info - LLRs of the info bits (nfr * k items).
+// Any of llr_cw and llr_info may be NULL.
+int
+dec_soft(
+   void *cdc,
+   int nfr,
+   double c_out[],
+   double llr_cw[],
+   double llr_info[]
+);
+#endif // DEC_HAS_SOFT
+
+#ifdef DEC_HAS_BATCH
+// # of words to pass to dec_bpsk_batch() at once (1 - use dec_bpsk()).
+int cdc_get_batch(void *cdc);
+
+// Decoding of nfr words at once: c_out - nfr * n items, x_dec - nfr * k items.
+// The result is the same as of dec_bpsk() word by word.
+int
+dec_bpsk_batch(
+   void *cdc,
+   int nfr,
+   double c_out[],
+   int x_dec[]
+);
+#endif // DEC_HAS_BATCH
+
 void
 cdc_close(
    void *cdc
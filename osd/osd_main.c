@@ -0,0 +1,415 @@
+//=============================================================================
+// Ordered statistics decoder (OSD) for RM and SubRM codes.
+// Parameters: RM_m, RM_r, border_node_mask (optional), osd_order.
+//
+// Copyright 2019 and onwards Kirill Shabunov.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Includes.
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../common/typedefs.h"
+#include "../common/std_defs.h"
+#include "../interfaces/codec.h"
+#include "../common/spf_par.h"
+#include "../interfaces/ui_utils.h"
+#include "../common/srm_utils.h"
+
+//-----------------------------------------------------------------------------
+// Internal defines.
+
+// Max OSD order.
+#define OSD_ORDER_MAX 8
+
+// Bit j of the packed row.
+#define ROW_BIT(row, j) (((row)[(j) >> 6] >> ((j) & 63)) & 1)
+#define ROW_SET(row, j) ((row)[(j) >> 6] |= (uint64)1 << ((j) & 63))
+
+//-----------------------------------------------------------------------------
+// Internal typedefs.
+
+typedef struct {
+   double r; // Reliability.
+   int i; // Position in the codeword.
+} srt_item;
+
+typedef struct {
+   int c_n; // Code length.
+   int c_k; // Code dimension.
+   int c_m; // RM m.
+   int c_r; // RM r.
+   int d_min; // Min distance (2^(m - r) for RM(r, m) and its subcodes).
+   int order; // OSD order.
+   uint32 *node_table; // SubRM border nodes (NULL - RM code).
+   int node_table_len;
+   uint8 *g; // Generator matrix (c_k x c_n) in the natural order.
+   // Decoder data.
+   // A packed row is c_n codeword bits in the reliability order followed by
+   // c_k bits of the info sequence that gives this codeword.
+   int w_num; // # of 64-bit words in a packed row.
+   uint64 *rows; // Reduced generator matrix (c_k rows).
+   uint64 *z; // Hard decision of the input.
+   uint64 *acc; // Candidates for each depth of the enumeration (order + 1 rows).
+   uint64 *best; // The best candidate.
+   srt_item *srt; // Positions sorted by reliability.
+   int *piv; // Pivot (most reliable basis) column of each row.
+   double best_d; // Discrepancy of the best candidate.
+   int stop; // 1 - the best candidate is ML.
+   int last_pat; // # of test patterns checked for the last decoded word.
+} cdc_inst_type;
+
+
+//-----------------------------------------------------------------------------
+// Global data.
+
+//-----------------------------------------------------------------------------
+// Internal functions.
+
+static int srt_cmp(const void *a, const void *b) {
+   double ra = ((const srt_item *)a)->r, rb = ((const srt_item *)b)->r;
+   return (ra < rb) - (ra > rb);
+}
+
+// Sufficient condition of the ML decision: any other codeword differs from
+// the input in at least d_min - w positions out of the w positions where
+// the best candidate does.
+static int best_is_ml(cdc_inst_type *dd) {
+   int w = 0, need, j;
+   double s = 0.0;
+
+   for (j = 0; j < dd->c_n; j++) w += (int)(ROW_BIT(dd->best, j) ^ ROW_BIT(dd->z, j));
+   need = dd->d_min - w;
+   // The least reliable positions are at the end.
+   for (j = dd->c_n - 1; (j >= 0) && (need > 0); j--) {
+      if (ROW_BIT(dd->best, j) != ROW_BIT(dd->z, j)) continue;
+      s += dd->srt[j].r;
+      need--;
+   }
+   return dd->best_d <= s;
+}
+
+// Check the candidate cw, update the best one.
+static void check_cand(cdc_inst_type *dd, uint64 *cw) {
+   double d = 0.0;
+   uint64 diff;
+   int wi, j;
+
+   dd->last_pat++;
+   // Discrepancy: sum of the reliabilities where cw differs from the input.
+   for (wi = 0; wi * 64 < dd->c_n; wi++) {
+      diff = cw[wi] ^ dd->z[wi];
+      for (j = wi * 64; (diff != 0) && (j < dd->c_n); j++, diff >>= 1) {
+         if (diff & 1) d += dd->srt[j].r;
+      }
+      if (d >= dd->best_d) return;
+   }
+   dd->best_d = d;
+   memcpy(dd->best, cw, dd->w_num * sizeof(uint64));
+   dd->stop = best_is_ml(dd);
+}
+
+// Flip up to order - depth more info bits out of rows 0..jmax.
+// lb - lower bound of the discrepancy of the candidates (sum of
+// the reliabilities of the flipped basis positions).
+static void osd_enum(cdc_inst_type *dd, int depth, int jmax, double lb) {
+   uint64 *cw = dd->acc + depth * dd->w_num;
+   uint64 *cw1 = cw + dd->w_num;
+   double lb1;
+   int j, wi;
+
+   // Rows are in the decreasing order of their basis reliabilities.
+   for (j = jmax; (j >= 0) && !dd->stop; j--) {
+      lb1 = lb + dd->srt[dd->piv[j]].r;
+      // Skipping rule: the rest has even larger bounds.
+      if (lb1 >= dd->best_d) break;
+      for (wi = 0; wi < dd->w_num; wi++) cw1[wi] = cw[wi] ^ dd->rows[j * dd->w_num + wi];
+      check_cand(dd, cw1);
+      if (depth + 1 < dd->order) osd_enum(dd, depth + 1, j - 1, lb1);
+   }
+}
+
+//-----------------------------------------------------------------------------
+// codec interface functions.
+
+int
+cdc_init(
+   char param_str[],
+   void **cdc
+)
+{
+   cdc_inst_type *dd = NULL;
+   char *str1 = NULL, *token;
+   int c_n = 0, c_k = 0, c_m = 0, c_r = 0;
+   int *x = NULL, *y = NULL;
+   int order = 1;
+   int i, j;
+
+   // Allocate decoder instance.
+   dd = (cdc_inst_type *)malloc(sizeof(cdc_inst_type));
+   if (dd == NULL) {
+      show_msg("cdc_init: Short of memory!");
+      goto ret_err;
+   }
+   memset(dd, 0, sizeof(cdc_inst_type));
+
+   // Allocate temporary string for parsing.
+   str1 = (char *)malloc(strlen(param_str) + 1);
+   if (str1 == NULL) {
+      err_msg("cdc_init: Short of memory!");
+      goto ret_err;
+   }
+   str1[0] = 0;
+
+   // ----- Parse parameters.
+   strcpy(str1, param_str);
+
+   token = strtok(str1, tk_seps_prepared);
+   while (token != NULL) {
+      TRYGET_INT_TOKEN(token, "RM_m", c_m);
+      TRYGET_INT_TOKEN(token, "RM_r", c_r);
+      if (strcmp(token, "border_node_mask") == 0) {
+         token = strtok(NULL, tk_seps_prepared);
+         dd->node_table_len = strlen(token);
+         dd->node_table = (uint32 *)malloc(dd->node_table_len * 4);
+         if (dd->node_table == NULL) {
+            err_msg("cdc_init: Short of memory.");
+            goto ret_err;
+         }
+         for (i = 0; i < dd->node_table_len; i++)
+            dd->node_table[i] = (token[i] == '0') ? 0 : 1;
+         token = strtok(NULL, tk_seps_prepared);
+         continue;
+      }
+      TRYGET_INT_TOKEN(token, "osd_order", order);
+      SPF_SKIP_UNKNOWN_PARAMETER(token);
+   }
+
+   free(str1); str1 = NULL;
+
+   dd->c_m = c_m;
+   dd->c_r = c_r;
+
+   // Check if all necessary parameters are specified.
+   if ((c_m == 0) || (c_r == 0)) {
+      err_msg("cdc_init: RM_m or RM_r are not specified.");
+      goto ret_err;
+   }
+   if ((order < 0) || (order > OSD_ORDER_MAX)) {
+      err_msg("cdc_init: osd_order is out of range.");
+      goto ret_err;
+   }
+
+   // Complete settings.
+   dd->c_n = c_n = 1 << c_m;
+   if (dd->node_table != NULL) dd->c_k = c_k = calc_srm_k(c_m, c_r, dd->node_table);
+   else dd->c_k = c_k = calc_rm_k(c_m, c_r);
+   dd->d_min = 1 << (c_m - c_r);
+   dd->order = MIN(order, c_k);
+   dd->w_num = (c_n + c_k + 63) / 64;
+
+   // Generator matrix.
+   dd->g = (uint8 *)malloc(c_k * c_n);
+   x = (int *)malloc(c_k * sizeof(int));
+   y = (int *)malloc(c_n * sizeof(int));
+   if ((dd->g == NULL) || (x == NULL) || (y == NULL)) {
+      err_msg("cdc_init: Short of memory.");
+      goto ret_err;
+   }
+   memset(x, 0, c_k * sizeof(int));
+   for (i = 0; i < c_k; i++) {
+      x[i] = 1;
+      if (dd->node_table != NULL) smrm_enc_bsc(c_m, c_r, dd->node_table, x, y);
+      else mrm_enc_bsc(c_m, c_r, x, y);
+      x[i] = 0;
+      for (j = 0; j < c_n; j++) dd->g[i * c_n + j] = (uint8)y[j];
+   }
+   free(x); x = NULL;
+   free(y); y = NULL;
+
+   // Decoder buffers.
+   dd->rows = (uint64 *)malloc(c_k * dd->w_num * sizeof(uint64));
+   dd->z = (uint64 *)malloc(dd->w_num * sizeof(uint64));
+   dd->acc = (uint64 *)malloc((dd->order + 1) * dd->w_num * sizeof(uint64));
+   dd->best = (uint64 *)malloc(dd->w_num * sizeof(uint64));
+   dd->srt = (srt_item *)malloc(c_n * sizeof(srt_item));
+   dd->piv = (int *)malloc(c_k * sizeof(int));
+   if ((dd->rows == NULL) || (dd->z == NULL) || (dd->acc == NULL) ||
+      (dd->best == NULL) || (dd->srt == NULL) || (dd->piv == NULL)) {
+      err_msg("cdc_init: Short of memory.");
+      goto ret_err;
+   }
+
+   (*cdc) = dd;
+
+   return RC_OK;
+
+ret_err:
+
+   if (str1 != NULL) free(str1);
+   if (x != NULL) free(x);
+   if (y != NULL) free(y);
+   if (dd != NULL) {
+      cdc_close(dd);
+      (*cdc) = NULL;
+   }
+   return RC_ERROR;
+}
+
+void
+cdc_close(
+   void *cdc
+)
+{
+   cdc_inst_type *dd;
+
+   if (cdc == NULL) return;
+   dd = (cdc_inst_type *)cdc;
+   if (dd->node_table != NULL) free(dd->node_table);
+   if (dd->g != NULL) free(dd->g);
+   if (dd->rows != NULL) free(dd->rows);
+   if (dd->z != NULL) free(dd->z);
+   if (dd->acc != NULL) free(dd->acc);
+   if (dd->best != NULL) free(dd->best);
+   if (dd->srt != NULL) free(dd->srt);
+   if (dd->piv != NULL) free(dd->piv);
+   free(dd);
+}
+
+int cdc_get_n(void *cdc)
+{
+   cdc_inst_type *dd;
+
+   if (cdc == NULL) return 0;
+   dd = (cdc_inst_type *)cdc;
+   return dd->c_n;
+}
+
+int cdc_get_k(void *cdc)
+{
+   cdc_inst_type *dd;
+
+   if (cdc == NULL) return 0;
+   dd = (cdc_inst_type *)cdc;
+   return dd->c_k;
+}
+
+#ifdef DEC_HAS_STATS
+int cdc_get_lsiz(void *cdc)
+{
+   cdc_inst_type *dd;
+
+   if (cdc == NULL) return 0;
+   dd = (cdc_inst_type *)cdc;
+   return dd->last_pat;
+}
+#endif // DEC_HAS_STATS
+
+int
+enc_bpsk(
+   void *cdc,
+   int x[],
+   double y[]
+)
+{
+   cdc_inst_type *dd;
+
+   dd = (cdc_inst_type *)cdc;
+   if (dd->node_table != NULL) return smrm_enc_bpsk(dd->c_m, dd->c_r, dd->node_table, x, y);
+   return mrm_enc_bpsk(dd->c_m, dd->c_r, x, y);
+}
+
+int
+dec_bpsk(
+   void *cdc,
+   double c_out[],
+   int x_dec[]
+)
+{
+   cdc_inst_type *dd;
+   int c_n, c_k, w_num;
+   uint64 *row, *rp, t;
+   int i, j, q, rank, wi;
+
+   dd = (cdc_inst_type *)cdc;
+   c_n = dd->c_n;
+   c_k = dd->c_k;
+   w_num = dd->w_num;
+
+   // Sort the positions by reliability. Only the order and the ratios
+   // matter, so the channel output is used as is.
+   for (j = 0; j < c_n; j++) {
+      dd->srt[j].r = fabs(c_out[j]);
+      dd->srt[j].i = j;
+   }
+   qsort(dd->srt, c_n, sizeof(srt_item), srt_cmp);
+
+   // Generator matrix and the hard decision in the reliability order.
+   memset(dd->rows, 0, c_k * w_num * sizeof(uint64));
+   memset(dd->z, 0, w_num * sizeof(uint64));
+   for (i = 0; i < c_k; i++) {
+      row = dd->rows + i * w_num;
+      for (j = 0; j < c_n; j++) {
+         if (dd->g[i * c_n + dd->srt[j].i]) ROW_SET(row, j);
+      }
+      ROW_SET(row, c_n + i);
+   }
+   for (j = 0; j < c_n; j++) {
+      if (c_out[dd->srt[j].i] > 0.0) ROW_SET(dd->z, j);
+   }
+
+   // Gaussian elimination: the most reliable basis.
+   rank = 0;
+   for (j = 0; (j < c_n) && (rank < c_k); j++) {
+      for (q = rank; q < c_k; q++) {
+         if (ROW_BIT(dd->rows + q * w_num, j)) break;
+      }
+      if (q == c_k) continue; // Dependent column.
+      row = dd->rows + rank * w_num;
+      if (q != rank) {
+         rp = dd->rows + q * w_num;
+         for (wi = 0; wi < w_num; wi++) {
+            t = row[wi]; row[wi] = rp[wi]; rp[wi] = t;
+         }
+      }
+      for (q = 0; q < c_k; q++) {
+         rp = dd->rows + q * w_num;
+         if ((q == rank) || !ROW_BIT(rp, j)) continue;
+         for (wi = 0; wi < w_num; wi++) rp[wi] ^= row[wi];
+      }
+      dd->piv[rank++] = j;
+   }
+
+   // Order 0: the hard decision on the basis.
+   memset(dd->acc, 0, w_num * sizeof(uint64));
+   for (i = 0; i < c_k; i++) {
+      if (!ROW_BIT(dd->z, dd->piv[i])) continue;
+      row = dd->rows + i * w_num;
+      for (wi = 0; wi < w_num; wi++) dd->acc[wi] ^= row[wi];
+   }
+   dd->last_pat = 0;
+   dd->best_d = HUGE_VAL;
+   dd->stop = 0;
+   check_cand(dd, dd->acc);
+
+   // Test patterns of weight 1..order.
+   if ((dd->order > 0) && !dd->stop) osd_enum(dd, 0, c_k - 1, 0.0);
+
+   for (i = 0; i < c_k; i++) x_dec[i] = (int)ROW_BIT(dd->best, c_n + i);
+
+   return RC_OK;
+}
@@ -1,5 +1,11 @@
 //=============================================================================
 // CRC-aided (CA) Polar SCL codec.
+// Optionally uses the SCS (stack) decoder instead of SCL.
+// SC-Flip: SC repeated with the least reliable decisions flipped
+// until CRC passes.
+// Automorphism ensemble: independent SCL decoders of the permuted inputs
+// may run in parallel (define global USE_PTHREADS).
+// The per-path loops of one SCL list may be split between threads (list_threads).
 // Implements codec.h
 // Needs channel sigma (define global DEC_NEEDS_SIGMA).
 //
@@ -40,6 +46,20 @@
 // Max # of SNR values.
 #define VARL_NUM_MAX        50
 
+#define SCAN_ITERS_DEFAULT  2
+
+// Defaults of the SC-Flip decoder.
+#define FLIP_ORDER_DEFAULT  1
+#define FLIP_ALPHA_DEFAULT  0.5
+
+// Max size of the automorphism ensemble.
+#define AE_NUM_MAX          256
+
+// Max # of tries to find a new automorphism, and
+// # of random transvections multiplied to get one (per bit index).
+#define AE_TRIES            1000
+#define AE_STEPS_PER_M      4
+
 //-----------------------------------------------------------------------------
 // Internal typedefs.
 
@@ -51,11 +71,41 @@ typedef struct {
    int c_m; // Polar m.
    int *crc;
    int crc_len;
+   crc_engine *ce; // Table-driven CRC.
+   int *x_crc; // Encoder buffer for (info_bits | crc).
    int csnrn;
    double sg22; // 2 / sg^2 for calculation of epsilons.
    int lsiz[VARL_NUM_MAX];
+   int adaptive_list; // 1 - double the list size starting from 1 until CRC passes.
+   int max_lsiz; // Max list size (memory is allocated for it).
+   int last_lsiz; // List size used for the last decoded word.
+   int lsiz1; // List size of the first stage of the cascade.
+   int cascade_lsiz; // List size of the second stage of the cascade (0 - no cascade).
+   double cascade_t; // Distance threshold of the first stage (0 - CRC check only).
+   int last_stage; // Cascade stage that gave the last decoded word.
+   int scan_iters; // # of SCAN iterations for dec_soft().
+   uint8 *scan_buf; // SCAN decoder memory buffer.
+   int ae_num; // Size of the automorphism ensemble (0 - no ensemble).
+   struct ae_task *ae; // Decoders of the ensemble.
+   int *ae_info; // Info bit positions in the natural order.
+   int *ae_u; // Buffer for the winner's codeword and info bits (c_n).
+   thread_team *ae_team; // Threads of the ensemble, started once (NULL - the calling thread only).
+   int thr_num; // # of threads sharing the per-path loops of a word.
 } cdc_inst_type;
 
+// Decoder of one automorphism of the ensemble.
+typedef struct ae_task {
+   decoder_type dc; // Shares node_table and CRC tables with the main decoder.
+   cdc_inst_type *owner;
+   int *perm; // The automorphism: y_in[j] = dec_input[perm[j]].
+   double *dec_input; // Decoder input (not permuted).
+   double *y_in; // Permuted decoder input.
+   int *x_dec; // Decoded info bits of the permuted word.
+   int *cw; // ... and its codeword.
+   int lsiz; // polar_dec() result.
+   double corr; // Correlation of cw with y_in.
+} ae_task;
+
 
 //-----------------------------------------------------------------------------
 // Global data.
@@ -63,21 +113,40 @@ typedef struct {
 //-----------------------------------------------------------------------------
 // Internal functions.
 
-int get_membuf_size(decoder_type *dd) {
+size_t get_membuf_size(decoder_type *dd) {
    int flsiz = MAX(dd->peak_lsiz, dd->p_num) * FLSIZ_MULT;
-   int mem_buf_size = 0;
+   size_t mem_buf_size = 0;
+
+   if (dd->stack_size > 0) return polar_scs_membuf_size(dd);
+   if (dd->bp_iters > 0) return polar_bp_membuf_size(dd);
 
    mem_buf_size += dd->c_n * sizeof(ylitem); // y_in
+   mem_buf_size += (size_t)dd->p_num * dd->c_n * sizeof(ylitem); // y_perm
    mem_buf_size += flsiz * sizeof(int); // frind
    mem_buf_size += flsiz * sizeof(int); // lorder
-   mem_buf_size += (dd->c_k * flsiz + 1) * sizeof(xlist_item); // xlist
+   mem_buf_size += ((size_t)dd->c_k * flsiz + 1) * sizeof(xlist_item); // xlist
    mem_buf_size += flsiz * sizeof(xlist_item *); // lind2xl
    mem_buf_size += dd->c_m * flsiz * sizeof(ylitem *); // ylist
-   mem_buf_size += dd->c_m * sizeof(ylitem *) + (dd->c_n - 1) * MAX(dd->peak_lsiz, dd->p_num) * 4 * sizeof(ylitem); // yitems
+   mem_buf_size += dd->c_m * sizeof(ylitem *) + (size_t)(dd->c_n - 1) * MAX(dd->peak_lsiz, dd->p_num) * 4 * sizeof(ylitem); // yitems
    mem_buf_size += flsiz * sizeof(slitem); // slist
    mem_buf_size += flsiz * sizeof(int); // plist.
    mem_buf_size += dd->c_n * sizeof(xlitem); // xtmp.
+   if (dd->node_spec != NULL) {
+      mem_buf_size += dd->c_n / 2 * sizeof(ylitem); // ytmp
+      mem_buf_size += dd->c_n / 2 * sizeof(ylitem); // sel_y
+      mem_buf_size += (size_t)MAX(dd->peak_lsiz, dd->p_num) * dd->c_n / 2 * sizeof(split_item); // splits
+      mem_buf_size += (size_t)MAX(dd->peak_lsiz, dd->p_num) * dd->c_n / 2 * sizeof(xlitem); // shd
+      mem_buf_size += flsiz * sizeof(int); // sorig
+      mem_buf_size += flsiz * sizeof(int); // sstate
+      mem_buf_size += dd->c_n / 2 * sizeof(int); // sel_pos
+   }
+   if (dd->crc_hp != NULL) {
+      mem_buf_size += flsiz * sizeof(uint32); // crc_state
+   }
    mem_buf_size += flsiz * sizeof(int); // parent.
+   if (dd->flip_attempts > 0) {
+      mem_buf_size += polar_scf_membuf_size(dd);
+   }
 
    return mem_buf_size;
 }
@@ -93,32 +162,269 @@ int get_k_from_node_table(
   return k;
 }
 
-int get_best_in_list(
-  int *x,
-  int x_len,
-  int lsiz,
-  int *crc,
-  int crc_len
-) {
-  if (crc_len <= 0) {
-    return 0;
-  }
-  else {
-    int sum_len = x_len + crc_len;
-    int i;
-    int *tmp = (int *)malloc(x_len * sizeof(int));
-    if (tmp == NULL) {
-      return 0;
-    }
-    for (i = 0; i < lsiz; i++) {
-      if (is_valid_crc(x + i * sum_len, x_len, crc, crc_len, tmp)) {
-        free(tmp);
-        return i;
+// Build the tables for the incremental CRC check in the decoder.
+// The CRC syndrome of x = (info_bits | crc) is the XOR of crc_hp[] over the
+// nonzero bits of x. It is 0 iff x has the valid CRC.
+int init_crc_tables(cdc_inst_type *dd) {
+   decoder_type *dc = &(dd->dc);
+   int c_k = dd->c_k, eff_k = dd->eff_k, crc_len = dd->crc_len;
+   int i, j, q, pn;
+   int *x, *px;
+   uint32 *h, *hp, *fin;
+   uint32 pending;
+   uint64 crc;
+
+   x = (int *)malloc(eff_k * sizeof(int));
+   h = (uint32 *)malloc(c_k * sizeof(uint32));
+   dc->crc_hp = (uint32 *)malloc((size_t)dc->p_num * c_k * sizeof(uint32));
+   dc->crc_fin = (uint32 *)malloc((size_t)dc->p_num * c_k * sizeof(uint32));
+   if ((x == NULL) || (h == NULL) || (dc->crc_hp == NULL) || (dc->crc_fin == NULL)) {
+      if (x != NULL) free(x);
+      if (h != NULL) free(h);
+      return RC_ERROR;
+   }
+
+   // Syndrome contributions in the natural order.
+   memset(x, 0, eff_k * sizeof(int));
+   for (i = 0; i < eff_k; i++) {
+      x[i] = 1;
+      crc = crc_calc_bits(dd->ce, x, eff_k);
+      x[i] = 0;
+      h[i] = 0;
+      for (q = 0; q < crc_len; q++) h[i] |= (uint32)((crc >> (crc_len - 1 - q)) & 1) << q;
+   }
+   for (q = 0; q < crc_len; q++) h[eff_k + q] = (uint32)1 << q;
+
+   // The same in the decoding order of each permutation.
+   for (pn = 0; pn < dc->p_num; pn++) {
+      px = dc->pxarr + pn * c_k;
+      hp = dc->crc_hp + pn * c_k;
+      fin = dc->crc_fin + pn * c_k;
+      for (j = 0; j < c_k; j++) hp[j] = h[px[j]];
+      // A syndrome bit is final after the last info bit contributing to it.
+      pending = 0;
+      for (j = c_k - 1; j >= 0; j--) {
+         fin[j] = hp[j] & ~pending;
+         pending |= hp[j];
       }
-    }
-    free(tmp);
-    return -1; // no candidates with valid CRC found
-  }
+   }
+
+   free(x);
+   free(h);
+   return RC_OK;
+}
+
+static int parity32(uint32 v) {
+   v ^= v >> 16;
+   v ^= v >> 8;
+   v ^= v >> 4;
+   v ^= v >> 2;
+   v ^= v >> 1;
+   return v & 1;
+}
+
+// Check if the code is invariant under j_a <-- j_a + j_b (j is the codeword
+// bit index). The info bit i is the monomial of z_l = j_l + 1 over the bits l
+// cleared in i. If bit a is cleared and bit b is set in i, the map adds the
+// monomials i | a and (i | a) & ~b to it, the rest of the monomials are kept.
+static int transvection_ok(cdc_inst_type *dd, int a, int b) {
+   uint32 *mask = dd->dc.node_table;
+   int i, i1;
+
+   for (i = 0; i < dd->c_n; i++) {
+      if ((mask[i] == 0) || ((i >> a) & 1) || !((i >> b) & 1)) continue;
+      i1 = i | (1 << a);
+      if ((mask[i1] == 0) || (mask[i1 & ~(1 << b)] == 0)) return 0;
+   }
+   return 1;
+}
+
+// Generate ae_num automorphisms: the identity and random products of the
+// transvections j_a <-- j_a + j_b, a < b. The lower triangular affine ones
+// (a > b) are skipped since SC gives the same result for them, so are
+// the repeated ones.
+static int init_automorphisms(cdc_inst_type *dd) {
+   int c_m = dd->c_m, c_n = dd->c_n;
+   int tr_a[CODE_M_MAX * CODE_M_MAX], tr_b[CODE_M_MAX * CODE_M_MAX];
+   int tr_num = 0;
+   uint32 *rows; // Row masks of the matrices, c_m per automorphism.
+   uint32 *r;
+   uint32 rnd = 1;
+   int a, b, t, t1, i, j, s, tries;
+
+   for (a = 0; a < c_m; a++) {
+      for (b = a + 1; b < c_m; b++) {
+         if (transvection_ok(dd, a, b)) {
+            tr_a[tr_num] = a;
+            tr_b[tr_num++] = b;
+         }
+      }
+   }
+   if ((tr_num == 0) && (dd->ae_num > 1)) {
+      err_msg("cdc_init: info_bits_mask has no automorphisms giving different SC results.");
+      return RC_ERROR;
+   }
+
+   rows = (uint32 *)malloc((size_t)dd->ae_num * c_m * sizeof(uint32));
+   if (rows == NULL) {
+      err_msg("cdc_init: Short of memory.");
+      return RC_ERROR;
+   }
+   for (t = 0; t < dd->ae_num; t++) {
+      r = rows + t * c_m;
+      for (tries = 0; tries < AE_TRIES; tries++) {
+         for (a = 0; a < c_m; a++) r[a] = (uint32)1 << a;
+         if (t == 0) break;
+         for (s = 0; s < AE_STEPS_PER_M * c_m; s++) {
+            // Own LCG: the random numbers of the channel simulator are kept intact.
+            rnd = rnd * 1103515245 + 12345;
+            i = (rnd >> 16) % tr_num;
+            r[tr_a[i]] ^= r[tr_b[i]];
+         }
+         for (t1 = 0; t1 < t; t1++) {
+            if (memcmp(r, rows + t1 * c_m, c_m * sizeof(uint32)) == 0) break;
+         }
+         if (t1 == t) break;
+      }
+      if (tries == AE_TRIES) {
+         err_msg("cdc_init: too many automorphisms for this info_bits_mask.");
+         free(rows);
+         return RC_ERROR;
+      }
+      for (j = 0; j < c_n; j++) {
+         i = 0;
+         for (a = 0; a < c_m; a++) i |= parity32(r[a] & (uint32)j) << a;
+         dd->ae[t].perm[j] = i;
+      }
+   }
+
+   free(rows);
+   return RC_OK;
+}
+
+static void free_ae(cdc_inst_type *dd) {
+   int t;
+
+   team_close(dd->ae_team);
+   dd->ae_team = NULL;
+   if (dd->ae == NULL) return;
+   for (t = 0; t < dd->ae_num; t++) {
+      if (dd->ae[t].dc.mem_buf != NULL) free(dd->ae[t].dc.mem_buf);
+      if (dd->ae[t].perm != NULL) free(dd->ae[t].perm);
+   }
+   free(dd->ae);
+   dd->ae = NULL;
+}
+
+// Allocate the decoders of the ensemble. Should be called when dd->dc is complete.
+static int init_ae(cdc_inst_type *dd) {
+   ae_task *t;
+   int i, i1;
+
+   dd->ae = (ae_task *)malloc(dd->ae_num * sizeof(ae_task));
+   dd->ae_info = (int *)malloc(dd->c_k * sizeof(int));
+   dd->ae_u = (int *)malloc(dd->c_n * sizeof(int));
+   if ((dd->ae == NULL) || (dd->ae_info == NULL) || (dd->ae_u == NULL)) return RC_ERROR;
+   memset(dd->ae, 0, dd->ae_num * sizeof(ae_task));
+   for (i = 0; i < dd->ae_num; i++) {
+      t = &(dd->ae[i]);
+      t->dc = dd->dc;
+      t->owner = dd;
+      t->dc.mem_buf = (uint8 *)malloc(get_membuf_size(&(t->dc)));
+      // perm, y_in, cw and x_dec in one buffer.
+      t->perm = (int *)malloc((size_t)dd->c_n * (2 * sizeof(int) + sizeof(double)) + dd->c_k * sizeof(int));
+      if ((t->dc.mem_buf == NULL) || (t->perm == NULL)) return RC_ERROR;
+      t->y_in = (double *)(t->perm + dd->c_n);
+      t->cw = (int *)(t->y_in + dd->c_n);
+      t->x_dec = t->cw + dd->c_n;
+   }
+   i1 = 0;
+   for (i = 0; i < dd->c_n; i++) {
+      if (dd->dc.node_table[i] != 0) dd->ae_info[i1++] = i;
+   }
+   return RC_OK;
+}
+
+// Decode the permuted input, re-encode and correlate.
+static void ae_dec(ae_task *t) {
+   int c_n = t->owner->c_n, c_k = t->owner->c_k;
+   int j;
+
+   for (j = 0; j < c_n; j++) t->y_in[j] = t->dec_input[t->perm[j]];
+   t->lsiz = polar_dec(&(t->dc), t->y_in, t->x_dec, NULL);
+   memset(t->cw, 0, c_n * sizeof(int));
+   for (j = 0; j < c_k; j++) t->cw[t->owner->ae_info[j]] = t->x_dec[j];
+   mrm_enc_mm_bsc(t->owner->c_m, t->cw, t->cw);
+   t->corr = 0.0;
+   for (j = 0; j < c_n; j++) t->corr += t->cw[j] ? t->y_in[j] : -t->y_in[j];
+}
+
+// Automorphisms [i0, i1).
+static void ae_job(void *arg, int i0, int i1) {
+   ae_task *ae = (ae_task *)arg;
+   int i;
+
+   for (i = i0; i < i1; i++) ae_dec(&(ae[i]));
+}
+
+// Decode with the automorphism ensemble.
+// The best candidate passing the CRC check (if any) is returned.
+static int run_ae(cdc_inst_type *dd, double *dec_input, int *x_dec) {
+   ae_task *t;
+   int *u = dd->ae_u;
+   int i, best = 0;
+
+   for (i = 0; i < dd->ae_num; i++) {
+      dd->ae[i].dc.peak_lsiz = dd->dc.peak_lsiz;
+      dd->ae[i].dec_input = dec_input;
+   }
+   // An automorphism is always worth a thread.
+   team_run(dd->ae_team, ae_job, dd->ae, dd->ae_num, TEAM_MIN_WORK);
+
+   for (i = 1; i < dd->ae_num; i++) {
+      t = &(dd->ae[i]);
+      if ((t->lsiz > 0) > (dd->ae[best].lsiz > 0)) best = i;
+      else if (((t->lsiz > 0) == (dd->ae[best].lsiz > 0)) && (t->corr > dd->ae[best].corr)) best = i;
+   }
+
+   // Back to the original bit order, then the info bits (the (m, m)
+   // encoding is its own inverse).
+   t = &(dd->ae[best]);
+   for (i = 0; i < dd->c_n; i++) u[t->perm[i]] = t->cw[i];
+   mrm_enc_mm_bsc(dd->c_m, u, u);
+   for (i = 0; i < dd->c_k; i++) x_dec[i] = u[dd->ae_info[i]];
+   dd->last_lsiz = dd->ae_num * dd->dc.peak_lsiz;
+   return t->lsiz;
+}
+
+// Decode with SCL, SCS, BP, SC-Flip or the automorphism ensemble.
+static int run_dec(cdc_inst_type *dd, double *dec_input, int *x_dec) {
+   int res;
+
+   if (dd->ae_num > 0) return run_ae(dd, dec_input, x_dec);
+   if (dd->dc.flip_attempts > 0) {
+      res = polar_scf_dec(&(dd->dc), dec_input, x_dec, NULL);
+      // # of SC decodings, stage 2 - some flip was needed.
+      dd->last_lsiz = 1 + dd->dc.flip_done;
+      dd->last_stage = (dd->dc.flip_done > 0) ? 2 : 1;
+      return res;
+   }
+   if (dd->dc.bp_iters > 0) {
+      res = polar_bp_dec(&(dd->dc), dec_input, x_dec, NULL);
+      // Total # of BP iterations over all the permutations.
+      dd->last_lsiz = dd->dc.bp_done;
+      return res;
+   }
+   if (dd->dc.stack_size == 0) {
+      res = polar_dec(&(dd->dc), dec_input, x_dec, NULL);
+      // With pruning: the peak # of active paths.
+      if (dd->dc.prune_margin > 0.0) dd->last_lsiz = dd->dc.act_lsiz;
+      return res;
+   }
+   res = polar_scs_dec(&(dd->dc), dec_input, x_dec, NULL);
+   // Equivalent list size: # of extended paths per info bit.
+   dd->last_lsiz = (dd->dc.scs_pops + dd->c_k - 1) / dd->c_k;
+   return res;
 }
 
 #ifdef DBG
@@ -145,9 +451,11 @@ cdc_init(
    char *str1 = NULL, *token;
    int c_n = 0, c_k = 0, c_m = 0;
    int i, j, i1, i2, pn;
-   int *p1, *px, *py;
-   int p_info[10000], inf_coeff[2048];
+   int *p1, *px, *py, *p2;
+   int *p_info = NULL, *inf_coeff = NULL, *inf_index = NULL;
+   int p_info_cap = 0;
    int p_num = 0;
+   int fast_scl = 0;
 
    // Allocate decoder instance.
    dd = (cdc_inst_type *)malloc(sizeof(cdc_inst_type));
@@ -156,9 +464,12 @@ cdc_init(
       goto ret_err;
    }
    memset(dd, 0, sizeof(cdc_inst_type));
+   dd->dc.flip_order = FLIP_ORDER_DEFAULT;
+   dd->thr_num = 1;
+   dd->dc.flip_alpha = FLIP_ALPHA_DEFAULT;
 
    // Allocate temporary string for parsing.
-   str1 = (char *)malloc(SP_STR_MAX);
+   str1 = (char *)malloc(strlen(param_str) + 1);
    if (str1 == NULL) {
       err_msg("cdc_init: Short of memory!");
       goto ret_err;
@@ -204,8 +515,22 @@ cdc_init(
          token = strtok(NULL, tk_seps_prepared);
          continue;
       }
+      TRYGET_ONOFF_TOKEN(token, "fast_scl", fast_scl);
+      TRYGET_ONOFF_TOKEN(token, "adaptive_list", dd->adaptive_list);
+      TRYGET_INT_TOKEN(token, "stack_size", dd->dc.stack_size);
+      TRYGET_INT_TOKEN(token, "scan_iterations", dd->scan_iters);
+      TRYGET_INT_TOKEN(token, "bp_iterations", dd->dc.bp_iters);
+      TRYGET_INT_TOKEN(token, "cascade_list_size", dd->cascade_lsiz);
+      TRYGET_FLOAT_TOKEN(token, "cascade_threshold", dd->cascade_t);
+      TRYGET_INT_TOKEN(token, "automorphisms", dd->ae_num);
+      TRYGET_INT_TOKEN(token, "flip_attempts", dd->dc.flip_attempts);
+      TRYGET_INT_TOKEN(token, "flip_order", dd->dc.flip_order);
+      TRYGET_FLOAT_TOKEN(token, "flip_alpha", dd->dc.flip_alpha);
+      TRYGET_FLOAT_TOKEN(token, "prune_margin", dd->dc.prune_margin);
+      TRYGET_INT_TOKEN(token, "list_threads", dd->thr_num);
       if (strcmp(token, "permutations") == 0) {
-         // TODO: Permutations that were used for RM codes are not usable with Polar, but let's leave it here for now.
+         // Permutations of the bit indices, the info_bits_mask must be invariant
+         // under them (RM and some SubRM codes).
          if (c_m == 0) {
             err_msg("cdc_init(): parameters file: c_m must be specified before permutations.");
             goto ret_err;
@@ -216,6 +541,15 @@ cdc_init(
             i1 = 0;
             p_num = 0;
             while (token[0] != GROUP_CHAR_END) {
+               if (i1 + c_m > p_info_cap) {
+                  p_info_cap = 2 * (i1 + c_m);
+                  p2 = (int *)realloc(p_info, p_info_cap * sizeof(int));
+                  if (p2 == NULL) {
+                     err_msg("cdc_init: Short of memory.");
+                     goto ret_err;
+                  }
+                  p_info = p2;
+               }
                for (i = 0; i < c_m; i++) {
                   p_info[i1++] = atoi(token);
                   token = strtok(NULL, tk_seps_prepared);
@@ -251,31 +585,152 @@ cdc_init(
       err_msg("cdc_init: No info_bits_mask.");
       goto ret_err;
    }
+   if (c_m > CODE_M_MAX) {
+      err_msg("cdc_init: c_m is too large.");
+      goto ret_err;
+   }
+   if (dd->dc.node_table_len != (1 << c_m)) {
+      err_msg("cdc_init: info_bits_mask length must be 2^c_m.");
+      goto ret_err;
+   }
    if (dd->dc.peak_lsiz == 0) {
       err_msg("cdc_init: No list size.");
       goto ret_err;
    }
+   if (dd->crc_len > 32) {
+      err_msg("cdc_init: CRC can't be longer than 32 bits.");
+      goto ret_err;
+   }
+   if (dd->adaptive_list && (dd->crc_len == 0)) {
+      err_msg("cdc_init: adaptive_list needs CRC.");
+      goto ret_err;
+   }
+   if (dd->scan_iters < 0) {
+      err_msg("cdc_init: scan_iterations must be positive.");
+      goto ret_err;
+   }
+   if (dd->dc.stack_size < 0) {
+      err_msg("cdc_init: stack_size must be positive.");
+      goto ret_err;
+   }
+   if ((dd->dc.stack_size > 0) && (fast_scl || dd->adaptive_list)) {
+      err_msg("cdc_init: stack_size can't be used with fast_scl or adaptive_list.");
+      goto ret_err;
+   }
+
+   if (dd->dc.bp_iters < 0) {
+      err_msg("cdc_init: bp_iterations must be positive.");
+      goto ret_err;
+   }
+   if ((dd->dc.bp_iters > 0) && (fast_scl || dd->adaptive_list || (dd->dc.stack_size > 0))) {
+      err_msg("cdc_init: bp_iterations can't be used with fast_scl, adaptive_list or stack_size.");
+      goto ret_err;
+   }
+
+   if (dd->cascade_lsiz < 0) {
+      err_msg("cdc_init: cascade_list_size must be positive.");
+      goto ret_err;
+   }
+   if ((dd->cascade_lsiz > 0) && (dd->crc_len == 0)) {
+      err_msg("cdc_init: cascade_list_size needs CRC.");
+      goto ret_err;
+   }
+   if ((dd->cascade_lsiz > 0) && (dd->adaptive_list || (dd->dc.stack_size > 0) || (dd->dc.bp_iters > 0))) {
+      err_msg("cdc_init: cascade_list_size can't be used with adaptive_list, stack_size or bp_iterations.");
+      goto ret_err;
+   }
+   if (dd->cascade_t < 0.0) {
+      err_msg("cdc_init: cascade_threshold must be positive.");
+      goto ret_err;
+   }
+   if ((dd->cascade_t > 0.0) && (dd->cascade_lsiz == 0)) {
+      err_msg("cdc_init: cascade_threshold needs cascade_list_size.");
+      goto ret_err;
+   }
+
+   if ((dd->ae_num < 0) || (dd->ae_num > AE_NUM_MAX)) {
+      err_msg("cdc_init: automorphisms is out of range.");
+      goto ret_err;
+   }
+   if ((dd->ae_num > 0) && ((p_num > 0) || dd->adaptive_list || (dd->dc.stack_size > 0)
+         || (dd->dc.bp_iters > 0) || (dd->cascade_lsiz > 0))) {
+      err_msg("cdc_init: automorphisms can't be used with permutations, adaptive_list, stack_size, bp_iterations or cascade_list_size.");
+      goto ret_err;
+   }
+
+   if (dd->dc.flip_attempts < 0) {
+      err_msg("cdc_init: flip_attempts must be positive.");
+      goto ret_err;
+   }
+   if ((dd->dc.flip_order < 1) || (dd->dc.flip_order > SCF_ORDER_MAX)) {
+      err_msg("cdc_init: flip_order is out of range.");
+      goto ret_err;
+   }
+   if (dd->dc.flip_alpha <= 0.0) {
+      err_msg("cdc_init: flip_alpha must be positive.");
+      goto ret_err;
+   }
+   if ((dd->dc.flip_attempts > 0) && (dd->crc_len == 0)) {
+      err_msg("cdc_init: flip_attempts needs CRC.");
+      goto ret_err;
+   }
+   if ((dd->dc.flip_attempts > 0) && (dd->dc.peak_lsiz != 1)) {
+      err_msg("cdc_init: flip_attempts needs list_size 1.");
+      goto ret_err;
+   }
+   if ((dd->dc.flip_attempts > 0) && ((p_num > 0) || fast_scl || dd->adaptive_list || (dd->dc.stack_size > 0)
+         || (dd->dc.bp_iters > 0) || (dd->cascade_lsiz > 0) || (dd->ae_num > 0))) {
+      err_msg("cdc_init: flip_attempts can't be used with permutations, fast_scl, adaptive_list, stack_size, bp_iterations, cascade_list_size or automorphisms.");
+      goto ret_err;
+   }
+
+   if (dd->dc.prune_margin < 0.0) {
+      err_msg("cdc_init: prune_margin must be positive.");
+      goto ret_err;
+   }
+   if ((dd->dc.prune_margin > 0.0) && (dd->adaptive_list || (dd->dc.stack_size > 0) || (dd->dc.bp_iters > 0)
+         || (dd->cascade_lsiz > 0) || (dd->ae_num > 0) || (dd->dc.flip_attempts > 0))) {
+      err_msg("cdc_init: prune_margin can't be used with adaptive_list, stack_size, bp_iterations, cascade_list_size, automorphisms or flip_attempts.");
+      goto ret_err;
+   }
+
+   if ((dd->thr_num < 1) || (dd->thr_num > TEAM_THR_MAX)) {
+      err_msg("cdc_init: list_threads is out of range.");
+      goto ret_err;
+   }
+   if ((dd->thr_num > 1) && (dd->ae_num > 0)) {
+      err_msg("cdc_init: list_threads can't be used with automorphisms.");
+      goto ret_err;
+   }
 
    // Complete settings.
    dd->c_n = dd->dc.c_n = c_n = 1 << c_m;
    dd->c_k = dd->dc.c_k = c_k = get_k_from_node_table(c_n, dd->dc.node_table);
    dd->eff_k = c_k - dd->crc_len;
-   dd->dc.ret_list = (dd->crc_len > 0) ? 1 : 0;
+   dd->dc.ret_list = 0;
+   dd->lsiz1 = dd->dc.peak_lsiz;
+   dd->dc.peak_lsiz = MAX(dd->dc.peak_lsiz, dd->cascade_lsiz);
+   dd->max_lsiz = dd->last_lsiz = dd->dc.peak_lsiz;
+   dd->last_stage = 1;
    for (i = 0; i < dd->dc.node_table_len; i++)
       dd->dc.node_table[i] = (dd->dc.node_table[i] == 0) ? 0 : dd->dc.peak_lsiz;
 
    // Generate permutations.
-   // TODO: Permutations.
    if (p_num == 0) {
       // permutations parameter was not given => only one permutation
       // (0 1 ... m-1) (no permutation).
+      p_info = (int *)malloc(c_m * sizeof(int));
+      if (p_info == NULL) {
+         err_msg("cdc_init: Short of memory.");
+         goto ret_err;
+      }
       for (i = 0; i < c_m; i++) p_info[i] = i;
       p_num = 1;
    }
    dd->dc.p_num = p_num;
    if (p_num > 0) {
-      dd->dc.pxarr = (int *)malloc(p_num * c_k * sizeof(int));
-      dd->dc.pyarr = (int *)malloc(p_num * c_n * sizeof(int));
+      dd->dc.pxarr = (int *)malloc((size_t)p_num * c_k * sizeof(int));
+      dd->dc.pyarr = (int *)malloc((size_t)p_num * c_n * sizeof(int));
       if ((dd->dc.pxarr == NULL) || (dd->dc.pyarr == NULL)) {
          err_msg("cdc_init: Short of memory.");
          goto ret_err;
@@ -284,14 +739,21 @@ cdc_init(
       py = dd->dc.pyarr;
       p1 = p_info;
    }
-   // Calculate inf_coeff[]. It contains all integers with weight <= c_r
-   // in reverse lexicographic order.
+   // Calculate inf_coeff[]. It contains the info bit positions
+   // in the decoding order, inf_index[] is its inverse (-1 for frozen bits).
+   inf_coeff = (int *)malloc(c_k * sizeof(int));
+   inf_index = (int *)malloc(c_n * sizeof(int));
+   if ((inf_coeff == NULL) || (inf_index == NULL)) {
+      err_msg("cdc_init: Short of memory.");
+      goto ret_err;
+   }
    i1 = 0;
-   for (i = c_n - 1; i >= 0; i--) {
-      // i2 <-- weight(i);
-      i2 = i & 1;
-      for (j = 1; j < c_m; j++) i2 += (i >> j) & 1;
-      if (i2 <= c_m) inf_coeff[i1++] = i;
+   for (i = 0; i < c_n; i++) {
+      inf_index[i] = -1;
+      if (dd->dc.node_table[i] != 0) {
+         inf_index[i] = i1;
+         inf_coeff[i1++] = i;
+      }
    }
    // Generate permutation arrays.
    for (pn = 0; pn < p_num; pn++) {
@@ -309,14 +771,48 @@ cdc_init(
          i1 = 0;
          i2 = inf_coeff[i];
          for (j = 0; j < c_m; j++) i1 |= ((i2 >> j) & 1) << p1[j];
-         for (j = 0; j < c_k; j++) if (inf_coeff[j] == i1) break;
-         px[i] = j;
+         if (inf_index[i1] < 0) {
+            err_msg("cdc_init: info_bits_mask is not invariant under the permutations.");
+            goto ret_err;
+         }
+         px[i] = inf_index[i1];
       }
       // for (i = 0; i < c_k; i++) msg_printf("%d ", px[i]); // DDD
       // msg_printf("\n"); // DDD
       px += c_k;
       p1 += c_m;
    }
+   free(p_info); p_info = NULL;
+   free(inf_coeff); inf_coeff = NULL;
+   free(inf_index); inf_index = NULL;
+
+   // Special nodes for Fast-SSCL.
+   if (fast_scl) {
+      dd->dc.node_spec = (int *)malloc(2 * c_n * sizeof(int));
+      if (dd->dc.node_spec == NULL) {
+         err_msg("cdc_init: Short of memory.");
+         goto ret_err;
+      }
+      polar_init_node_spec(&(dd->dc), dd->dc.node_spec);
+   }
+
+   // Tables for the incremental CRC check.
+   if (dd->crc_len > 0) {
+      if (dd->eff_k < dd->crc_len) {
+         err_msg("cdc_init: CRC is longer than the information block.");
+         goto ret_err;
+      }
+      dd->ce = crc_engine_init(dd->crc, dd->crc_len);
+      dd->x_crc = (int *)malloc(c_k * sizeof(int));
+      if ((dd->ce == NULL) || (dd->x_crc == NULL)) {
+         err_msg("cdc_init: Short of memory.");
+         goto ret_err;
+      }
+      if (init_crc_tables(dd) != RC_OK) {
+         err_msg("cdc_init: Short of memory.");
+         goto ret_err;
+      }
+   }
 
 #ifdef FORMAT_Q
    if (dec_tables_init()) {
@@ -332,6 +828,41 @@ cdc_init(
       goto ret_err;
    }
 
+   // Automorphism ensemble.
+   if (dd->ae_num > 0) {
+      if (init_ae(dd) != RC_OK) {
+         err_msg("cdc_init: Short of memory.");
+         goto ret_err;
+      }
+      if (init_automorphisms(dd) != RC_OK) goto ret_err;
+#ifdef USE_PTHREADS
+      if (dd->ae_num > 1) {
+         dd->ae_team = team_init(MIN(dd->ae_num, TEAM_THR_MAX));
+         if (dd->ae_team == NULL) {
+            err_msg("cdc_init: cannot start automorphisms threads.");
+            goto ret_err;
+         }
+      }
+#endif
+   }
+
+   // Soft output decoder.
+   if (dd->scan_iters == 0) dd->scan_iters = SCAN_ITERS_DEFAULT;
+   dd->scan_buf = (uint8 *)malloc(polar_scan_membuf_size(&(dd->dc)));
+   if (dd->scan_buf == NULL) {
+      err_msg("cdc_init: Short of memory.");
+      goto ret_err;
+   }
+
+   // Threads for the per-path loops.
+   if (dd->thr_num > 1) {
+      dd->dc.team = team_init(dd->thr_num);
+      if (dd->dc.team == NULL) {
+         err_msg("cdc_init: cannot start list_threads threads.");
+         goto ret_err;
+      }
+   }
+
    (*cdc) = dd;
 
    return RC_OK;
@@ -339,11 +870,25 @@ cdc_init(
 ret_err:
 
    if (str1 != NULL) free(str1);
+   if (p_info != NULL) free(p_info);
+   if (inf_coeff != NULL) free(inf_coeff);
+   if (inf_index != NULL) free(inf_index);
    if (dd != NULL) {
+      team_close(dd->dc.team);
       if (dd->dc.mem_buf != NULL) free(dd->dc.mem_buf);
+      if (dd->scan_buf != NULL) free(dd->scan_buf);
       if (dd->dc.pxarr != NULL) free(dd->dc.pxarr);
       if (dd->dc.pyarr != NULL) free(dd->dc.pyarr);
       if (dd->dc.node_table != NULL) free(dd->dc.node_table);
+      if (dd->dc.node_spec != NULL) free(dd->dc.node_spec);
+      if (dd->dc.crc_hp != NULL) free(dd->dc.crc_hp);
+      if (dd->dc.crc_fin != NULL) free(dd->dc.crc_fin);
+      if (dd->crc != NULL) free(dd->crc);
+      if (dd->ce != NULL) crc_engine_free(dd->ce);
+      if (dd->x_crc != NULL) free(dd->x_crc);
+      free_ae(dd);
+      if (dd->ae_info != NULL) free(dd->ae_info);
+      if (dd->ae_u != NULL) free(dd->ae_u);
       free(dd);
       (*cdc) = NULL;
    }
@@ -359,11 +904,21 @@ cdc_close(
 
    if (cdc == NULL) return;
    dd = (cdc_inst_type *)cdc;
+   team_close(dd->dc.team);
    if (dd->dc.mem_buf != NULL) free(dd->dc.mem_buf);
+   if (dd->scan_buf != NULL) free(dd->scan_buf);
    if (dd->crc != NULL) free(dd->crc);
    if (dd->dc.node_table != NULL) free(dd->dc.node_table);
+   if (dd->dc.node_spec != NULL) free(dd->dc.node_spec);
+   if (dd->dc.crc_hp != NULL) free(dd->dc.crc_hp);
+   if (dd->dc.crc_fin != NULL) free(dd->dc.crc_fin);
    if (dd->dc.pxarr != NULL) free(dd->dc.pxarr);
    if (dd->dc.pyarr != NULL) free(dd->dc.pyarr);
+   if (dd->ce != NULL) crc_engine_free(dd->ce);
+   if (dd->x_crc != NULL) free(dd->x_crc);
+   free_ae(dd);
+   if (dd->ae_info != NULL) free(dd->ae_info);
+   if (dd->ae_u != NULL) free(dd->ae_u);
    free(dd);
 #ifdef FORMAT_Q
    dec_tables_free();
@@ -388,6 +943,28 @@ int cdc_get_k(void *cdc)
    return dd->eff_k;
 }
 
+#ifdef DEC_HAS_STATS
+int cdc_get_lsiz(void *cdc)
+{
+   cdc_inst_type *dd;
+
+   if (cdc == NULL) return 0;
+   dd = (cdc_inst_type *)cdc;
+   return dd->last_lsiz;
+}
+#endif // DEC_HAS_STATS
+
+#ifdef DEC_HAS_STAGES
+int cdc_get_stage(void *cdc)
+{
+   cdc_inst_type *dd;
+
+   if (cdc == NULL) return 0;
+   dd = (cdc_inst_type *)cdc;
+   return dd->last_stage;
+}
+#endif // DEC_HAS_STAGES
+
 void
 cdc_set_sg(
    void *cdc,
@@ -409,19 +986,17 @@ enc_bpsk(
 {
    cdc_inst_type *dd;
    int *x_crc;
+   uint64 crc;
+   int j;
 
    dd = (cdc_inst_type *)cdc;
 
    if (dd->crc_len > 0) {
-      x_crc = (int *)malloc(dd->c_k * sizeof(int));
-      if (x_crc == NULL) {
-         err_msg("enc_bpsk: Short of memory.");
-         return RC_ERROR;
-      }
-      calc_crc(x, dd->eff_k, dd->crc, dd->crc_len, x_crc + dd->crc_len);
+      x_crc = dd->x_crc;
+      crc = crc_calc_bits(dd->ce, x, dd->eff_k);
       memcpy(x_crc, x, dd->eff_k * sizeof(int));
+      for (j = 0; j < dd->crc_len; j++) x_crc[dd->eff_k + j] = (crc >> (dd->crc_len - 1 - j)) & 1;
       smrm_par0_enc_bpsk(dd->c_m, dd->c_m, dd->dc.node_table, x_crc, y);
-      free(x_crc);
       return dd->eff_k;
    }
    else {
@@ -437,18 +1012,22 @@ dec_bpsk(
 )
 {
    cdc_inst_type *dd;
-   double *dec_input;
-   int *x_candidates;
+   double *dec_input, *y_dec;
+   int *x_crc, *x1;
    uint8 *mem_buf, *mem_buf_ptr;
-   int mem_buf_size;
-   int best_ind;
-   int is_erasure = 0;
+   size_t mem_buf_size;
+   int lsiz, p_num, i;
+   double d1;
 
    dd = (cdc_inst_type *)cdc;
 
    mem_buf_size = dd->c_n * sizeof(double); // dec_input
-   if (dd->dc.ret_list) {
-      mem_buf_size += dd->dc.peak_lsiz * dd->c_k * sizeof(int); // x_candidates
+   if (dd->crc_len > 0) {
+      mem_buf_size += dd->c_k * sizeof(int); // x_crc
+   }
+   if (dd->cascade_t > 0.0) {
+      mem_buf_size += dd->c_n * sizeof(double); // y_dec
+      mem_buf_size += dd->c_k * sizeof(int); // x1
    }
    mem_buf = (uint8 *)malloc(mem_buf_size);
    if (mem_buf == NULL) {
@@ -460,31 +1039,124 @@ dec_bpsk(
    dec_input = (double *)mem_buf_ptr;
    mem_buf_ptr += dd->c_n * sizeof(double);
 
-   if (dd->dc.ret_list) {
-      x_candidates = (int *)mem_buf_ptr;
-      mem_buf_ptr += dd->dc.peak_lsiz * dd->c_k * sizeof(int);
-   }
-
    // dec_input <-- 2 * c_out / sg^2.
-   for (int i = 0; i < dd->c_n; i++) dec_input[i] = c_out[i] * dd->sg22;
+   for (i = 0; i < dd->c_n; i++) dec_input[i] = c_out[i] * dd->sg22;
 
-   if (dd->dc.ret_list) {
-      polar_dec(&(dd->dc), dec_input, x_candidates, NULL);
-      best_ind = get_best_in_list(x_candidates, dd->eff_k, dd->dc.peak_lsiz, dd->crc, dd->crc_len);
+   if (dd->crc_len > 0) {
+      // The decoder checks CRC itself: the candidate it returns has the valid CRC
+      // unless the list is empty.
+      x_crc = (int *)mem_buf_ptr;
+      mem_buf_ptr += dd->c_k * sizeof(int);
+      if (dd->adaptive_list) {
+         // L = 1, 2, 4, ... until some candidate passes CRC.
+         // The memory buffer is allocated for the max list size, so only the limit is changed.
+         // Each stage starts from the first bit: the smaller list has already lost the paths
+         // the larger one keeps (all the stages cost about 2L).
+         for (dd->dc.peak_lsiz = 1; ; dd->dc.peak_lsiz *= 2) {
+            dd->dc.peak_lsiz = MIN(dd->dc.peak_lsiz, dd->max_lsiz);
+            lsiz = run_dec(dd, dec_input, x_crc);
+            if ((lsiz > 0) || (dd->dc.peak_lsiz == dd->max_lsiz)) break;
+         }
+         dd->last_lsiz = dd->dc.peak_lsiz;
+         dd->dc.peak_lsiz = dd->max_lsiz;
+      }
+      else if (dd->cascade_lsiz > 0) {
+         // First stage: list_size, no permutations. Second stage (only if
+         // no candidate passes CRC or the candidate is too far from the
+         // channel output): cascade_list_size, all permutations.
+         p_num = dd->dc.p_num;
+         dd->dc.peak_lsiz = dd->lsiz1;
+         dd->dc.p_num = 1;
+         dd->last_stage = 1;
+         lsiz = run_dec(dd, dec_input, x_crc);
+         dd->last_lsiz = dd->lsiz1;
+         dd->dc.p_num = p_num;
+         x1 = NULL;
+         if ((lsiz > 0) && (dd->cascade_t > 0.0)) {
+            y_dec = (double *)mem_buf_ptr;
+            mem_buf_ptr += dd->c_n * sizeof(double);
+            smrm_par0_enc_bpsk(dd->c_m, dd->c_m, dd->dc.node_table, x_crc, y_dec);
+            d1 = 0.0;
+            // d1 <-- dist(dec_input, y_dec).
+            for (i = 0; i < dd->c_n; i++)
+               d1 += (c_out[i] - y_dec[i]) * (c_out[i] - y_dec[i]);
+            d1 *= dd->sg22 / 2.0;
+            if (d1 >= dd->cascade_t) {
+               // Kept in case the second stage finds nothing.
+               x1 = (int *)mem_buf_ptr;
+               memcpy(x1, x_crc, dd->c_k * sizeof(int));
+               lsiz = 0;
+            }
+         }
+         if (lsiz == 0) {
+            dd->dc.peak_lsiz = dd->cascade_lsiz;
+            dd->last_stage = 2;
+            lsiz = run_dec(dd, dec_input, x_crc);
+            dd->last_lsiz = dd->cascade_lsiz;
+            if ((lsiz == 0) && (x1 != NULL)) {
+               memcpy(x_crc, x1, dd->c_k * sizeof(int));
+               lsiz = 1;
+            }
+         }
+         dd->dc.peak_lsiz = dd->max_lsiz;
+      }
+      else {
+         lsiz = run_dec(dd, dec_input, x_crc);
+      }
 #ifdef DBG
-      printf("best_ind: %d\n", best_ind);
+      printf("lsiz: %d\n", lsiz);
 #endif
-      if (best_ind < 0) {
-        is_erasure = 1;
-        best_ind = 0;
-      }
-      memcpy(x_dec, x_candidates + best_ind * dd->c_k, dd->eff_k * sizeof(int));
+      memcpy(x_dec, x_crc, dd->eff_k * sizeof(int));
    }
    else {
-      polar_dec(&(dd->dc), dec_input, x_dec, NULL);
+      lsiz = run_dec(dd, dec_input, x_dec);
    }
 
    free(mem_buf);
 
-   return is_erasure ? RC_DEC_ERASURE : RC_OK;
+   if (lsiz < 0) return RC_ERROR;
+   return (lsiz == 0) ? RC_DEC_ERASURE : RC_OK;
+}
+
+#ifdef DEC_HAS_SOFT
+int
+dec_soft(
+   void *cdc,
+   int nfr,
+   double c_out[],
+   double llr_cw[],
+   double llr_info[]
+)
+{
+   cdc_inst_type *dd;
+   double *llr_in, *info;
+   int *px;
+   int f, i;
+
+   dd = (cdc_inst_type *)cdc;
+
+   llr_in = (double *)malloc((dd->c_n + dd->c_k) * sizeof(double));
+   if (llr_in == NULL) {
+      err_msg("dec_soft: Short of memory.");
+      return RC_ERROR;
+   }
+   info = llr_in + dd->c_n;
+   px = dd->dc.pxarr;
+
+   for (f = 0; f < nfr; f++) {
+      // 0 is sent as -1.
+      for (i = 0; i < dd->c_n; i++) llr_in[i] = -c_out[f * dd->c_n + i] * dd->sg22;
+      polar_scan_dec(&(dd->dc), dd->scan_iters, dd->scan_buf, llr_in,
+         (llr_cw != NULL) ? llr_cw + f * dd->c_n : NULL, info);
+      // The CRC bits are the last ones.
+      if (llr_info != NULL) {
+         for (i = 0; i < dd->c_k; i++) {
+            if (px[i] < dd->eff_k) llr_info[f * dd->eff_k + px[i]] = info[i];
+         }
+      }
+   }
+
+   free(llr_in);
+   return RC_OK;
 }
+#endif // DEC_HAS_SOFT
@@ -0,0 +1,210 @@
+//=============================================================================
+// Polar belief propagation (BP) decoder.
+// Flooding schedule over the (u xor v | u) factor graph, BP-list over
+// the permuted graphs.
+//
+// Copyright 2019 and onwards Kirill Shabunov.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=============================================================================
+
+
+//-----------------------------------------------------------------------------
+// Includes.
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../common/typedefs.h"
+#include "../common//std_defs.h"
+#include "polar_scl_inner.h"
+
+
+//-----------------------------------------------------------------------------
+// Internal defines.
+
+// LLR of a frozen bit.
+#define BP_LLR_FROZEN 1e10
+
+// Scaling factor of the min-sum approximation.
+#define BP_MS_SCALE 0.9375
+
+// a xor b in terms of LLRs (scaled min-sum).
+#define BP_XOR(a, b) ((((a) < 0.0) != ((b) < 0.0)) ? \
+  -BP_MS_SCALE * MIN(fabs(a), fabs(b)) : BP_MS_SCALE * MIN(fabs(a), fabs(b)))
+
+
+//-----------------------------------------------------------------------------
+// Global data.
+
+// Level l of the graph holds c_n values: the codewords of all the nodes
+// of size 2^l. Level 0 - the bits at the leaves, level c_m - the codeword.
+static double **lbuf; // lbuf[l] - LLRs from the channel side.
+static double **rbuf; // rbuf[l] - LLRs from the frozen side.
+static int *u_hat; // Hard decisions at the leaves.
+static int *c_hat; // u_hat re-encoded.
+static int *x_best; // The best candidate (decoding order).
+
+
+//-----------------------------------------------------------------------------
+// Functions.
+
+size_t polar_bp_membuf_size(decoder_type *dd) {
+  size_t mem_buf_size = 0;
+
+  mem_buf_size += (dd->c_m + 1) * 2 * sizeof(double *); // lbuf, rbuf
+  mem_buf_size += (size_t)(dd->c_m + 1) * 2 * dd->c_n * sizeof(double); // lbuf[], rbuf[]
+  mem_buf_size += dd->c_n * sizeof(int); // u_hat
+  mem_buf_size += dd->c_n * sizeof(int); // c_hat
+  mem_buf_size += dd->c_k * sizeof(int); // x_best
+
+  return mem_buf_size;
+}
+
+// Right-to-left pass at level l: lbuf[l - 1] from lbuf[l] and rbuf[l - 1].
+static void bp_left(int c_n, int l) {
+  int n2 = 1 << (l - 1);
+  double *la = lbuf[l], *lc = lbuf[l - 1], *rc = rbuf[l - 1];
+  int b, j, a;
+
+  for (b = 0; b < c_n; b += 2 * n2) {
+    for (j = 0; j < n2; j++) {
+      a = b + j;
+      // v: y_1 xor (y_2 + u), u: (y_1 xor v) + y_2.
+      lc[a] = BP_XOR(la[a], la[a + n2] + rc[a + n2]);
+      lc[a + n2] = BP_XOR(la[a], rc[a]) + la[a + n2];
+    }
+  }
+}
+
+// Left-to-right pass at level l: rbuf[l] from rbuf[l - 1] and lbuf[l].
+static void bp_right(int c_n, int l) {
+  int n2 = 1 << (l - 1);
+  double *ra = rbuf[l], *la = lbuf[l], *rc = rbuf[l - 1];
+  int b, j, a;
+
+  for (b = 0; b < c_n; b += 2 * n2) {
+    for (j = 0; j < n2; j++) {
+      a = b + j;
+      // (v xor (u + y_2) | u + (v xor y_1)).
+      ra[a] = BP_XOR(rc[a], rc[a + n2] + la[a + n2]);
+      ra[a + n2] = rc[a + n2] + BP_XOR(rc[a], la[a]);
+    }
+  }
+}
+
+// Hard decisions at the leaves are re-encoded and compared with
+// the hard decisions of the codeword.
+// Returns 1 if they agree (u_hat is a codeword).
+static int bp_check(int c_n, int c_m) {
+  double *lc = lbuf[c_m], *rc = rbuf[c_m];
+  int n2, b, j, i;
+
+  for (i = 0; i < c_n; i++) c_hat[i] = u_hat[i] = (lbuf[0][i] + rbuf[0][i] < 0.0);
+  for (n2 = 1; n2 < c_n; n2 *= 2) {
+    for (b = 0; b < c_n; b += 2 * n2) {
+      for (j = b; j < b + n2; j++) c_hat[j] ^= c_hat[j + n2];
+    }
+  }
+  for (i = 0; i < c_n; i++) {
+    if (c_hat[i] != (lc[i] + rc[i] < 0.0)) return 0;
+  }
+  return 1;
+}
+
+// Decoding procedure.
+int
+polar_bp_dec(
+  decoder_type *dd, // Decoder instance data.
+  double *y_in, // Decoder input.
+  int *x_dec, // Decoded information sequence.
+  double *s_dec // Metric of x_dec (set NULL, if not needed).
+)
+{
+  int c_n = dd->c_n;
+  int c_m = dd->c_m;
+  int c_k = dd->c_k;
+  uint8 *mem_buf_ptr = dd->mem_buf;
+  int *p1;
+  uint32 *hp;
+  double s, s_best = -HUGE_VAL;
+  int p_best = 0, found = 0;
+  uint32 syn;
+  int i, j, l, t, pn;
+
+  // ----- Memory allocation.
+
+  lbuf = (double **)mem_buf_ptr;
+  mem_buf_ptr += (c_m + 1) * sizeof(double *);
+  rbuf = (double **)mem_buf_ptr;
+  mem_buf_ptr += (c_m + 1) * sizeof(double *);
+  for (l = 0; l <= c_m; l++) {
+    lbuf[l] = (double *)mem_buf_ptr;
+    mem_buf_ptr += c_n * sizeof(double);
+    rbuf[l] = (double *)mem_buf_ptr;
+    mem_buf_ptr += c_n * sizeof(double);
+  }
+  u_hat = (int *)mem_buf_ptr;
+  mem_buf_ptr += c_n * sizeof(int);
+  c_hat = (int *)mem_buf_ptr;
+  mem_buf_ptr += c_n * sizeof(int);
+  x_best = (int *)mem_buf_ptr;
+  mem_buf_ptr += c_k * sizeof(int);
+
+  // ----- Decoding of each permuted graph until a valid codeword is found.
+
+  dd->bp_done = 0;
+  for (pn = 0; (pn < dd->p_num) && !found; pn++) {
+    // The input is 2 * y / sg^2 and 0 is sent as -1.
+    p1 = dd->pyarr + pn * c_n;
+    for (i = 0; i < c_n; i++) lbuf[c_m][i] = -y_in[p1[i]];
+    for (l = 0; l < c_m; l++) memset(lbuf[l], 0, c_n * sizeof(double));
+    for (i = 0; i < c_n; i++) rbuf[0][i] = (dd->node_table[i] == 0) ? BP_LLR_FROZEN : 0.0;
+    for (l = 1; l <= c_m; l++) memset(rbuf[l], 0, c_n * sizeof(double));
+
+    for (t = 0; (t < dd->bp_iters) && !found; t++) {
+      for (l = c_m; l > 0; l--) bp_left(c_n, l);
+      for (l = 1; l <= c_m; l++) bp_right(c_n, l);
+      dd->bp_done++;
+      if (!bp_check(c_n, c_m)) continue;
+      found = 1;
+      if (dd->crc_hp == NULL) continue;
+      // Syndrome of the info bits.
+      hp = dd->crc_hp + pn * c_k;
+      syn = 0;
+      for (i = j = 0; i < c_n; i++) {
+        if (dd->node_table[i] == 0) continue;
+        if (u_hat[i]) syn ^= hp[j];
+        j++;
+      }
+      found = (syn == 0);
+    }
+
+    // Correlation of the last hard decision with the input.
+    s = 0.0;
+    for (i = 0; i < c_n; i++) s += c_hat[i] ? -lbuf[c_m][i] : lbuf[c_m][i];
+    if (found || (s > s_best)) {
+      s_best = s;
+      p_best = pn;
+      for (i = j = 0; i < c_n; i++) {
+        if (dd->node_table[i] != 0) x_best[j++] = u_hat[i];
+      }
+    }
+  }
+
+  p1 = dd->pxarr + c_k * p_best;
+  for (j = 0; j < c_k; j++) x_dec[p1[j]] = x_best[j];
+  if (s_dec != NULL) (*s_dec) = s_best;
+
+  return found;
+}
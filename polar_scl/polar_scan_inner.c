@@ -0,0 +1,151 @@
+//=============================================================================
+// Polar SCAN (soft cancellation) decoder.
+// Soft output: extrinsic LLRs of the codeword bits and LLRs of the info bits.
+// LLRs are ln(Pr{0} / Pr{1}) in double.
+//
+// Copyright 2019 and onwards Kirill Shabunov.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=============================================================================
+
+
+//-----------------------------------------------------------------------------
+// Includes.
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../common/typedefs.h"
+#include "../common//std_defs.h"
+#include "polar_scl_inner.h"
+
+
+//-----------------------------------------------------------------------------
+// Internal defines.
+
+// LLR of a frozen bit.
+#define SCAN_LLR_FROZEN 1e10
+
+
+//-----------------------------------------------------------------------------
+// Global data.
+
+static double **lbuf; // lbuf[m] - LLRs from the channel side for the current node at level m.
+static double **bbuf; // bbuf[m] - LLRs from the frozen side for all nodes at level m.
+static double *lleaf; // LLRs of the bits at the leaves.
+
+
+//-----------------------------------------------------------------------------
+// Functions.
+
+// a xor b in terms of LLRs (exact).
+static double llr_xor(double a, double b) {
+  double s = fabs(a + b), d = fabs(a - b);
+  double r = MIN(fabs(a), fabs(b)) + log1p(exp(-s)) - log1p(exp(-d));
+  return ((a < 0.0) != (b < 0.0)) ? -r : r;
+}
+
+size_t polar_scan_membuf_size(decoder_type *dd) {
+  size_t mem_buf_size = 0;
+
+  mem_buf_size += (dd->c_m + 1) * 2 * sizeof(double *); // lbuf, bbuf
+  mem_buf_size += dd->c_n * sizeof(double); // lbuf[]
+  mem_buf_size += (size_t)(dd->c_m + 1) * dd->c_n * sizeof(double); // bbuf[]
+  mem_buf_size += dd->c_n * sizeof(double); // lleaf
+
+  return mem_buf_size;
+}
+
+// The node (m, offset). Its LLRs from the channel side are in lbuf[m].
+// Both halves are (u xor v | u), v is decoded first.
+static void polar_scan_inner(int m, int offset) {
+  int n2 = (1 << m) / 2;
+  double *l1, *l2, *lc, *bv, *bu, *bp;
+  int j;
+
+  if (m == 0) {
+    lleaf[offset] = lbuf[0][0];
+    return;
+  }
+
+  l1 = lbuf[m];
+  l2 = l1 + n2;
+  lc = lbuf[m - 1];
+  bv = bbuf[m - 1] + offset;
+  bu = bv + n2;
+
+  // v: y_1 xor (y_2 + u).
+  for (j = 0; j < n2; j++) lc[j] = llr_xor(l1[j], l2[j] + bu[j]);
+  polar_scan_inner(m - 1, offset);
+
+  // u: (y_1 xor v) + y_2.
+  for (j = 0; j < n2; j++) lc[j] = llr_xor(l1[j], bv[j]) + l2[j];
+  polar_scan_inner(m - 1, offset + n2);
+
+  // Back to the parent: (v xor (u + y_2) | u + (v xor y_1)).
+  bp = bbuf[m] + offset;
+  for (j = 0; j < n2; j++) {
+    bp[j] = llr_xor(bv[j], bu[j] + l2[j]);
+    bp[j + n2] = bu[j] + llr_xor(bv[j], l1[j]);
+  }
+}
+
+// Decoding procedure (permutations are not used).
+void
+polar_scan_dec(
+  decoder_type *dd, // Decoder instance data.
+  int iters, // # of iterations.
+  uint8 *mem_buf, // polar_scan_membuf_size() bytes.
+  double *llr_in, // Channel LLRs (c_n).
+  double *llr_cw, // Extrinsic LLRs of the codeword bits (c_n, NULL if not needed).
+  double *llr_info // LLRs of the info bits (c_k, NULL if not needed).
+)
+{
+  int c_n = dd->c_n;
+  int c_m = dd->c_m;
+  uint8 *mem_buf_ptr = mem_buf;
+  int i, j, t;
+
+  // ----- Memory allocation.
+
+  lbuf = (double **)mem_buf_ptr;
+  mem_buf_ptr += (c_m + 1) * sizeof(double *);
+  bbuf = (double **)mem_buf_ptr;
+  mem_buf_ptr += (c_m + 1) * sizeof(double *);
+  // A single buffer for all levels below the root: 2^m items for level m.
+  for (i = 0; i < c_m; i++) {
+    lbuf[i] = (double *)mem_buf_ptr + (1 << i) - 1;
+  }
+  mem_buf_ptr += c_n * sizeof(double);
+  for (i = 0; i <= c_m; i++) {
+    bbuf[i] = (double *)mem_buf_ptr;
+    mem_buf_ptr += c_n * sizeof(double);
+  }
+  lleaf = (double *)mem_buf_ptr;
+  mem_buf_ptr += c_n * sizeof(double);
+
+  // ----- Initial assignments.
+
+  lbuf[c_m] = llr_in;
+  for (i = 0; i < c_n; i++) bbuf[0][i] = (dd->node_table[i] == 0) ? SCAN_LLR_FROZEN : 0.0;
+  for (i = 1; i <= c_m; i++) memset(bbuf[i], 0, c_n * sizeof(double));
+
+  for (t = 0; t < iters; t++) polar_scan_inner(c_m, 0);
+
+  if (llr_cw != NULL) memcpy(llr_cw, bbuf[c_m], c_n * sizeof(double));
+  if (llr_info != NULL) {
+    for (i = j = 0; i < c_n; i++) {
+      if (dd->node_table[i] != 0) llr_info[j++] = lleaf[i];
+    }
+  }
+}
@@ -0,0 +1,214 @@
+//=============================================================================
+// Polar SC-Flip decoder.
+// SC with the CRC check. If the check fails, SC is repeated with the
+// decisions at the least reliable positions flipped (dynamic SC-Flip:
+// the flip sets are ordered by the DSCF metric, up to flip_order
+// positions are flipped at once).
+// SC is polar_dec() with a single path. An attempt replays the first pass
+// decisions up to the earliest flipped bit and decodes on from there.
+//
+// Copyright 2019 and onwards Kirill Shabunov.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Includes.
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../common/typedefs.h"
+#include "../common//std_defs.h"
+#include "polar_scl_inner.h"
+
+
+//-----------------------------------------------------------------------------
+// Internal typedefs.
+
+// Flip set: the info bit indices (decoding order, ascending) and its metric.
+typedef struct {
+  double metric;
+  int num;
+  int pos[SCF_ORDER_MAX];
+} flip_item;
+
+
+//-----------------------------------------------------------------------------
+// Global data.
+
+static THREAD_LOCAL double *lrel; // |LLR| at the info bits.
+static THREAD_LOCAL flip_item *cand; // Flip sets to try, the best first.
+static THREAD_LOCAL int cand_num;
+
+
+//-----------------------------------------------------------------------------
+// Functions.
+
+size_t polar_scf_membuf_size(decoder_type *dd) {
+  size_t mem_buf_size = 0;
+
+  mem_buf_size += dd->flip_attempts * sizeof(flip_item); // cand
+  mem_buf_size += dd->c_k * sizeof(double); // lrel
+  mem_buf_size += dd->c_k * sizeof(double); // lrel_first
+  mem_buf_size += dd->c_n * sizeof(slitem); // sc_s
+  mem_buf_size += dd->c_n * sizeof(xlitem); // sc_x
+  mem_buf_size += dd->c_k * sizeof(int); // flip_at
+  mem_buf_size += dd->c_k * sizeof(int); // info_pos
+  mem_buf_size += dd->c_k * sizeof(int); // x_first
+  // polar_dec() buffers follow.
+  mem_buf_size = (mem_buf_size + sizeof(double) - 1) / sizeof(double) * sizeof(double);
+
+  return mem_buf_size;
+}
+
+// 1 - the info bits x pass the CRC check.
+static int scf_crc_ok(decoder_type *dd, int *x) {
+  uint32 syn = 0;
+  int j;
+
+  for (j = 0; j < dd->c_k; j++) {
+    if (x[dd->pxarr[j]]) syn ^= dd->crc_hp[j];
+  }
+  return syn == 0;
+}
+
+// Insert the flip set into cand[] (ascending metric) if it fits.
+static void scf_insert(flip_item *f, int cap) {
+  int i;
+
+  if ((cand_num == cap) && (f->metric >= cand[cap - 1].metric)) return;
+  i = MIN(cand_num, cap - 1);
+  while ((i > 0) && (cand[i - 1].metric > f->metric)) {
+    cand[i] = cand[i - 1];
+    i--;
+  }
+  cand[i] = *f;
+  if (cand_num < cap) cand_num++;
+}
+
+// Extensions of the flip set f by one position after the last one:
+// DSCF metric sum_{j in f} |L_j| + sum_{j <= max f} ln(1 + exp(-alpha * |L_j|)) / alpha.
+static void scf_extend(decoder_type *dd, flip_item *f, int cap) {
+  flip_item g;
+  double s = 0.0, acc = 0.0;
+  int j, j0;
+
+  for (j = 0; j < f->num; j++) s += lrel[f->pos[j]];
+  j0 = (f->num > 0) ? f->pos[f->num - 1] + 1 : 0;
+  for (j = 0; j < j0; j++) acc += log1p(exp(-dd->flip_alpha * lrel[j]));
+  g = *f;
+  g.num = f->num + 1;
+  for (j = j0; j < dd->c_k; j++) {
+    acc += log1p(exp(-dd->flip_alpha * lrel[j]));
+    g.pos[f->num] = j;
+    g.metric = s + lrel[j] + acc / dd->flip_alpha;
+    scf_insert(&g, cap);
+  }
+}
+
+// Decoding procedure.
+int
+polar_scf_dec(
+  decoder_type *dd, // Decoder instance data.
+  double *y_in, // Decoder input.
+  int *x_dec, // Decoded information sequence.
+  double *s_dec // Metric of x_dec (set NULL, if not needed).
+)
+{
+  int c_n = dd->c_n;
+  int c_k = dd->c_k;
+  uint8 *mem_buf_ptr = dd->mem_buf;
+  decoder_type sc = *dd; // SC: a single path, no CRC in the decoder.
+  double *lrel_first;
+  int *flip_at, *info_pos, *x_first;
+  flip_item f;
+  double s_first, s;
+  int found, i, t;
+
+  // ----- Memory allocation.
+
+  cand = (flip_item *)mem_buf_ptr;
+  mem_buf_ptr += dd->flip_attempts * sizeof(flip_item);
+  lrel = (double *)mem_buf_ptr;
+  mem_buf_ptr += c_k * sizeof(double);
+  lrel_first = (double *)mem_buf_ptr;
+  mem_buf_ptr += c_k * sizeof(double);
+  sc.sc_s = (slitem *)mem_buf_ptr;
+  mem_buf_ptr += c_n * sizeof(slitem);
+  sc.sc_x = (xlitem *)mem_buf_ptr;
+  mem_buf_ptr += c_n * sizeof(xlitem);
+  flip_at = (int *)mem_buf_ptr;
+  mem_buf_ptr += c_k * sizeof(int);
+  info_pos = (int *)mem_buf_ptr;
+  mem_buf_ptr += c_k * sizeof(int);
+  x_first = (int *)mem_buf_ptr;
+  sc.mem_buf = dd->mem_buf + polar_scf_membuf_size(dd);
+
+  sc.crc_hp = NULL;
+  sc.team = NULL;
+  sc.flip_at = flip_at;
+  sc.flip_llr = lrel;
+
+  // Leaf of each info bit.
+  for (t = i = 0; i < c_n; i++) {
+    if (dd->node_table[i] != 0) info_pos[t++] = i;
+  }
+
+  // ----- SC, the decisions are recorded for the replays.
+
+  memset(flip_at, 0, c_k * sizeof(int));
+  sc.sc_rec = 1;
+  sc.replay_end = 0;
+  polar_dec(&sc, y_in, x_dec, &s_first);
+  found = scf_crc_ok(dd, x_dec);
+  memcpy(x_first, x_dec, c_k * sizeof(int));
+  memcpy(lrel_first, lrel, c_k * sizeof(double));
+  s = s_first;
+
+  // ----- Flips.
+
+  // Each attempt restarts at the earliest flipped bit: the decisions
+  // before it are the same as in the first pass.
+  sc.sc_rec = 0;
+  dd->flip_done = 0;
+  cand_num = 0;
+  if (!found) {
+    f.num = 0;
+    scf_extend(dd, &f, dd->flip_attempts);
+  }
+  for (t = 0; (t < dd->flip_attempts) && (cand_num > 0) && !found; t++) {
+    f = cand[0];
+    cand_num--;
+    memmove(cand, cand + 1, cand_num * sizeof(flip_item));
+    for (i = 0; i < f.num; i++) flip_at[f.pos[i]] = 1;
+    memcpy(lrel, lrel_first, c_k * sizeof(double));
+    sc.replay_end = info_pos[f.pos[0]];
+    polar_dec(&sc, y_in, x_dec, &s);
+    dd->flip_done++;
+    found = scf_crc_ok(dd, x_dec);
+    // The remaining attempts limit the # of sets worth keeping.
+    if (!found && (f.num < dd->flip_order) && (t + 1 < dd->flip_attempts)) {
+      scf_extend(dd, &f, dd->flip_attempts - t - 1);
+    }
+    for (i = 0; i < f.num; i++) flip_at[f.pos[i]] = 0;
+  }
+
+  if (!found) {
+    memcpy(x_dec, x_first, c_k * sizeof(int));
+    s = s_first;
+  }
+  if (s_dec != NULL) (*s_dec) = s;
+
+  return found;
+}
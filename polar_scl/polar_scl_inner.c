@@ -57,6 +57,8 @@
 #define YLIST_POP(i) (yitems[i] + (1 << (i)) * (yfrindp[i]++))
 #endif // DBG2
 #define YLIST_RESET(i) { yfrindp[i] = 0; }
+// k rows at once (the rows of k YLIST_POP(i) in a row).
+#define YLIST_POP_N(i, k) (yfrindp[i] += (k), yitems[i] + (1 << (i)) * (yfrindp[i] - (k)))
 
 #define YLISTP(i, j) ylist[(i) * dd->c_m + (j)]
 #define YLISTPP(i, j) (ylist + (i) * dd->c_m + (j))
@@ -65,31 +67,74 @@
 //-----------------------------------------------------------------------------
 // Internal typedefs.
 
+// Per-path loop over lorder[i0..i1) run by the thread team. The list state
+// is passed explicitly: the globals are THREAD_LOCAL to the calling thread.
+typedef struct {
+  int c_m;
+  int c_n;
+  int m; // Node m.
+  ylitem **ylist;
+  int *lorder;
+  slitem *slist;
+  ylitem *yrows; // Rows reserved with YLIST_POP_N() for the paths in the lorder order.
+  ylitem *y_perm; // Permuted inputs (root node).
+  int *plist;
+} path_job;
+
+#define JYLISTP(jb, i, j) (jb)->ylist[(i) * (jb)->c_m + (j)]
 //-----------------------------------------------------------------------------
 // Global data.
 
-uint32 *node_table; // The table of list sizes at the border nodes.
-int node_counter;
+THREAD_LOCAL uint32 *node_table; // The table of list sizes at the border nodes.
+THREAD_LOCAL int node_counter;
+THREAD_LOCAL int lsiz_lim; // List size limit for the current decoding (dd->peak_lsiz).
 
-slitem *slist;
-xlist_item *xlist;
-int *plist; // Permutation index list.
-int *parent; // index of the parent list element.
-xlist_item **lind2xl; // list index to xlist
+// List size at the node i limited with lsiz_lim.
+// Paths dropped by the CRC check keep their places in the list.
+#define NODE_LSIZ(i) ((int)MIN(node_table[i], (uint32)lsiz_lim) - crc_drops)
 
-ylitem **yitems; // peak_lsiz * 2 * c_n
-ylitem **ylist; // current buffer - YLISTP(list_index, m)
-int yfrindp[32]; // yfrindp[i] points to the next available row for ylist in yitems[i].
+THREAD_LOCAL slitem *slist;
+THREAD_LOCAL xlist_item *xlist;
+THREAD_LOCAL int *plist; // Permutation index list.
+THREAD_LOCAL int *parent; // index of the parent list element.
+THREAD_LOCAL xlist_item **lind2xl; // list index to xlist
 
-int *lorder; // list ordering
-int cur_lsiz; // Current list size.
+THREAD_LOCAL ylitem **yitems; // peak_lsiz * 2 * c_n
+THREAD_LOCAL ylitem **ylist; // current buffer - YLISTP(list_index, m)
+THREAD_LOCAL int yfrindp[32]; // yfrindp[i] points to the next available row for ylist in yitems[i].
 
-int *frind; // Stack containing indexes of free list cells.
-int frindp; // frind pointer. Points to the next available element.
+THREAD_LOCAL int *lorder; // list ordering
+THREAD_LOCAL int cur_lsiz; // Current list size.
 
-xlist_item *next_xle_ptr; // pointer to the next available xlist element
+THREAD_LOCAL int *frind; // Stack containing indexes of free list cells.
+THREAD_LOCAL int frindp; // frind pointer. Points to the next available element.
 
-xlitem *xtmp;
+THREAD_LOCAL xlist_item *next_xle_ptr; // pointer to the next available xlist element
+
+THREAD_LOCAL xlitem *xtmp;
+THREAD_LOCAL ylitem *ytmp; // Folding buffer for REP nodes.
+
+// Fast-SSCL special nodes data.
+THREAD_LOCAL split_item *splits; // Split points of the current node (c_n / 2 per list element).
+THREAD_LOCAL xlitem *shd; // Base codewords of the current node (c_n / 2 per list element).
+THREAD_LOCAL int *sorig; // Index of the list element at the node start.
+THREAD_LOCAL int *sstate; // 1 - the parity bit of the current SPC code is flipped.
+THREAD_LOCAL int *sel_pos; // The least reliable positions.
+THREAD_LOCAL ylitem *sel_y; // ... and their reliabilities.
+
+// Incremental CRC check.
+THREAD_LOCAL uint32 *crc_hp; // Syndrome contributions of the info bits (NULL - no CRC).
+THREAD_LOCAL uint32 *crc_fin; // Syndrome bits that are final after each info bit.
+THREAD_LOCAL uint32 *crc_state; // CRC syndrome of each path.
+THREAD_LOCAL int info_counter; // # of decided info bits.
+THREAD_LOCAL int dec_done; // 1 - nothing is left to decide.
+THREAD_LOCAL int crc_drops; // # of paths dropped by the CRC check.
+
+// The best path dropped by the CRC check.
+THREAD_LOCAL xlist_item *drop_xle;
+THREAD_LOCAL slitem drop_s;
+THREAD_LOCAL int drop_perm;
+THREAD_LOCAL int drop_len; // # of info bits in the path.
 
 
 //-----------------------------------------------------------------------------
@@ -111,9 +156,44 @@ int branch(int i0, xlist_item *xle0) {
   lorder[cur_lsiz++] = i1;
   slist[i1] = slist[i0];
   plist[i1] = plist[i0];
+  if (crc_hp != NULL) crc_state[i1] = crc_state[i0];
   return i1;
 }
 
+// Add info bit x at position info_counter + j to the CRC syndrome of the path.
+// Returns 0 if the path fails the CRC check.
+static int crc_push(int c_k, int ind, int j, xlitem x) {
+  int k = plist[ind] * c_k + info_counter + j;
+  if (x) crc_state[ind] ^= crc_hp[k];
+  return (crc_state[ind] & crc_fin[k]) == 0;
+}
+
+// Remove lorder[i] from the list after a failed CRC check.
+// len is the # of info bits in the path.
+static void crc_drop(int i, int len) {
+  int ind = lorder[i];
+  if (slist[ind] > drop_s) {
+    drop_s = slist[ind];
+    drop_xle = lind2xl[ind];
+    drop_perm = plist[ind];
+    drop_len = len;
+  }
+  frind[--frindp] = ind;
+  lorder[i] = lorder[--cur_lsiz];
+  crc_drops++;
+}
+
+// No places are left in the list: drop all the paths.
+static void crc_drop_all(void) {
+  while (cur_lsiz > 0) crc_drop(cur_lsiz - 1, info_counter);
+  dec_done = 1;
+}
+
+// Stop when the only path has all info bits or no paths are left.
+#define CHECK_DEC_DONE(c_k) { \
+  if ((cur_lsiz == 0) || ((cur_lsiz == 1) && (info_counter == (c_k)))) dec_done = 1; \
+}
+
 #ifdef DBG
 int vgetx_all(int listInd, xlitem *res_x) {
   int i, n;
@@ -135,17 +215,22 @@ int vgetx_all(int listInd, xlitem *res_x) {
 }
 void print_list(char rem[]) {
   int i, j, n;
-  xlitem tmp[4096];
+  xlitem *tmp;
+  xlist_item *xle;
   if (rem != NULL) {
     printf("%s: ", rem);
   }
   for (i = 0; i < cur_lsiz; i++) {
     printf("%3.1f:", slist[lorder[i]]);
+    for (n = 0, xle = lind2xl[lorder[i]]; xle->p != NULL; xle = xle->p) n++;
+    tmp = (xlitem *)malloc((n + 1) * sizeof(xlitem));
+    if (tmp == NULL) break;
     n = vgetx_all(lorder[i], tmp);
     for (j = 0; j < n; j++) {
       printf("%1d", tmp[j]);
     }
     printf(" ");
+    free(tmp);
   }
   printf("\n");
 #ifdef DBG2
@@ -183,14 +268,36 @@ static int lst_comp(const void *i, const void *j)
    return -1;
 }
 
+// Drop the paths worse than the best one by more than prune_margin
+// (0 - no pruning) and update the peak # of active paths.
+static void prune_list(decoder_type *dd) {
+  slitem s_lim;
+  int i;
+
+  if ((dd->prune_margin > 0.0) && (cur_lsiz > 1)) {
+    s_lim = slist[lorder[0]];
+    for (i = 1; i < cur_lsiz; i++) s_lim = MAX(s_lim, slist[lorder[i]]);
+    s_lim -= dd->prune_margin;
+    for (i = 0; i < cur_lsiz; ) {
+      if (slist[lorder[i]] >= s_lim) {
+        i++;
+        continue;
+      }
+      frind[--frindp] = lorder[i];
+      lorder[i] = lorder[--cur_lsiz];
+    }
+  }
+  dd->act_lsiz = MAX(dd->act_lsiz, cur_lsiz);
+}
+
 void polar0_branch(
    decoder_type *dd, // Decoder instance data.
    int peak_lsiz
 ) {
   int cur_lsiz_old = cur_lsiz;
   int cur_ind0, cur_ind1;
-  ylitem y;
   xlitem x;
+  slitem s0, s1;
   ylitem *yp;
   int i;
 
@@ -206,20 +313,13 @@ void polar0_branch(
     cur_ind1 = branch(cur_ind0, lind2xl[cur_ind0]);
 
     yp = YLISTP(cur_ind0, 0);
-    if (CHECK_EST0(yp[0])) {
-      y = yp[0];
-      x = 0;
-    }
-    else {
-      y = INV_EST(yp[0]);
-      x = 1;
-    }
+    POLAR_BIT_DEC(yp[0], x, s0, s1);
 
     PUSHX(x, cur_ind0);
-    slist[cur_ind0] += EST0_TO_LNP0(y);
+    slist[cur_ind0] += s0;
 
     PUSHX(1 - x, cur_ind1);
-    slist[cur_ind1] += EST0_TO_LNP1(y);
+    slist[cur_ind1] += s1;
   }
 
 #ifdef DBG
@@ -231,6 +331,16 @@ void polar0_branch(
     qpartition(lorder, cur_lsiz, peak_lsiz);
     while (cur_lsiz > peak_lsiz) frind[--frindp] = lorder[--cur_lsiz];
   }
+  prune_list(dd);
+
+  // Drop the surviving paths failing the CRC check.
+  if (crc_hp != NULL) {
+    for (i = 0; i < cur_lsiz; ) {
+      if (crc_push(dd->c_k, lorder[i], 0, GETX(lorder[i]))) i++;
+      else crc_drop(i, info_counter + 1);
+    }
+  }
+  info_counter++;
 
   for (i = 0; i < cur_lsiz; i++) {
     cur_ind1 = lorder[i];
@@ -274,44 +384,571 @@ void polar0_skip(
 #endif
 }
 
-void polar_dec_inner(
+// In-place (u xor v | u) transform of n = 2^m bits (it is its own inverse).
+void polar_transform(int m, xlitem *x) {
+  int n = 1 << m;
+  int h, i, j;
+
+  for (h = 1; h < n; h <<= 1) {
+    for (i = 0; i < n; i += 2 * h) {
+      for (j = i; j < i + h; j++) x[j] ^= x[j + h];
+    }
+  }
+}
+
+// SC-Flip leaf: the decision is flipped if flip_at[] says so.
+static void polar0_flip(
+  decoder_type *dd // Decoder instance data.
+) {
+  int cur_ind0 = lorder[0];
+  xlitem x;
+  slitem s0, s1;
+  ylitem *yp;
+
+  yp = YLISTP(cur_ind0, 0);
+  POLAR_BIT_DEC(yp[0], x, s0, s1);
+  dd->flip_llr[info_counter] = s0 - s1;
+  if (dd->flip_at[info_counter]) {
+    x = 1 - x;
+    s0 = s1;
+  }
+  PUSHX(x, cur_ind0);
+  slist[cur_ind0] += s0;
+  info_counter++;
+  yp = YLISTP(cur_ind0, 0) = YLIST_POP(0);
+  yp[0] = x ? YLDEC1 : YLDEC0;
+}
+
+// SC-Flip: the decisions of the node are the recorded ones.
+// Only the node codeword and the path metric are restored.
+static void polar_replay(
   decoder_type *dd, // Decoder instance data.
   int m
 ) {
+  int n = 1 << m;
+  int cur_ind0 = lorder[0];
+  xlitem *xp = dd->sc_x + node_counter;
+  ylitem *yp;
+  int j;
+
+  for (j = 0; j < n; j++) {
+    if (node_table[node_counter + j] == 0) continue;
+    PUSHX(xp[j], cur_ind0);
+    info_counter++;
+  }
+  memcpy(xtmp, xp, n * sizeof(xlitem));
+  polar_transform(m, xtmp);
+  yp = YLISTP(cur_ind0, m) = YLIST_POP(m);
+  for (j = 0; j < n; j++) yp[j] = xtmp[j] ? YLDEC1 : YLDEC0;
+  slist[cur_ind0] = dd->sc_s[node_counter + n - 1];
+  node_counter += n;
+}
+
+// Insert position j with the reliability y into sel_pos[]/sel_y[] that keep
+// the t least reliable positions (the weakest first). Returns the new length.
+static int sel_insert(int len, int t, int j, ylitem y) {
+  int k;
+
+  if ((len == t) && !STRONGER_EST0(sel_y[len - 1], y)) return len;
+  if (len < t) len++;
+  for (k = len - 1; (k > 0) && STRONGER_EST0(sel_y[k - 1], y); k--) {
+    sel_y[k] = sel_y[k - 1];
+    sel_pos[k] = sel_pos[k - 1];
+  }
+  sel_y[k] = y;
+  sel_pos[k] = j;
+  return len;
+}
+
+// Split the list at the prepared points of a special node.
+// Each split point doubles the list: the bit at pos (and pos0) is kept or flipped.
+static void polar_node_splits(
+  decoder_type *dd, // Decoder instance data.
+  int nsplits,
+  int peak_lsiz
+) {
+  int cur_lsiz_old;
+  int cur_ind0, cur_ind1;
+  split_item *sp;
+  slitem s1, smin;
+  int i, t;
+
+  for (t = 0; t < nsplits; t++) {
+
+    // With the full list a new candidate worse than all the old ones is dropped anyway.
+    cur_lsiz_old = cur_lsiz;
+    smin = -FM_S_HUGE;
+    if (cur_lsiz_old >= peak_lsiz) {
+      smin = slist[lorder[0]];
+      for (i = 1; i < cur_lsiz_old; i++) smin = MIN(smin, slist[lorder[i]]);
+    }
 
+    for (i = 0; i < cur_lsiz_old; i++) {
+      cur_ind0 = lorder[i];
+      parent[cur_ind0] = -1;
+      sp = splits + sorig[cur_ind0] * (dd->c_n / 2) + t;
+      s1 = sp->s;
+      if (sp->pos0 >= 0) {
+        // Start of the next SPC code.
+        if ((t == 0) || (sp[-1].pos0 != sp->pos0)) sstate[cur_ind0] = sp->par0;
+        s1 += sstate[cur_ind0] ? -sp->s0 : sp->s0;
+      }
+      if (slist[cur_ind0] + s1 > smin) {
+        cur_ind1 = branch(cur_ind0, lind2xl[cur_ind0]);
+        sorig[cur_ind1] = sorig[cur_ind0];
+        sstate[cur_ind1] = sstate[cur_ind0] ^ (sp->pos0 >= 0);
+        PUSHONEX(cur_ind1);
+        slist[cur_ind1] += s1;
+      }
+      PUSHZEROX(cur_ind0);
+    }
+
+    // Partition and cut the list.
+    if (cur_lsiz > peak_lsiz) {
+      qpartition(lorder, cur_lsiz, peak_lsiz);
+      while (cur_lsiz > peak_lsiz) frind[--frindp] = lorder[--cur_lsiz];
+    }
+    prune_list(dd);
+
+    for (i = 0; i < cur_lsiz; i++) {
+      cur_ind1 = lorder[i];
+      cur_ind0 = parent[cur_ind1];
+      if (cur_ind0 >= 0) {
+        memcpy(YLISTPP(cur_ind1, 0), YLISTPP(cur_ind0, 0), dd->c_m * sizeof(ylitem *));
+      }
+    }
+  }
+}
+
+// Replace the split decisions with the info bits of the node and set y_dec.
+// The base codewords in shd have length 2^s and are repeated up to 2^m.
+static void polar_node_finish(
+  decoder_type *dd, // Decoder instance data.
+  int m,
+  int s,
+  int nsplits
+) {
   int n = 1 << m;
-  int n2 = n / 2;
+  int ns = 1 << s;
+  uint32 *nt = node_table + node_counter + n - ns;
   int cur_ind0;
+  xlist_item *xle;
+  split_item *sp;
+  ylitem *yp;
+  int i, j, t, kn, crc_ok;
+
+  for (i = 0; i < cur_lsiz; ) {
+    cur_ind0 = lorder[i];
+
+    // Codeword: the base one with the chosen flips.
+    memcpy(xtmp, shd + sorig[cur_ind0] * (dd->c_n / 2), ns * sizeof(xlitem));
+    sp = splits + sorig[cur_ind0] * (dd->c_n / 2);
+    xle = lind2xl[cur_ind0];
+    for (t = nsplits - 1; t >= 0; t--) {
+      if (xle->x) {
+        xtmp[sp[t].pos] ^= 1;
+        if (sp[t].pos0 >= 0) xtmp[sp[t].pos0] ^= 1;
+      }
+      xle = xle->p;
+    }
+    lind2xl[cur_ind0] = xle;
+
+    yp = YLISTP(cur_ind0, m) = YLIST_POP(m);
+    for (j = 0; j < n; j++) yp[j] = xtmp[j & (ns - 1)] ? YLDEC1 : YLDEC0;
+
+    // Info bits (all of them are among the last ns ones).
+    polar_transform(s, xtmp);
+    crc_ok = 1;
+    for (kn = j = 0; j < ns; j++) {
+      if (nt[j]) {
+        PUSHX(xtmp[j], cur_ind0);
+        if (crc_hp != NULL) crc_ok &= crc_push(dd->c_k, cur_ind0, kn, xtmp[j]);
+        kn++;
+      }
+    }
+    if (crc_ok) i++;
+    else crc_drop(i, info_counter + kn);
+  }
+  for (kn = j = 0; j < ns; j++) kn += (nt[j] != 0);
+  info_counter += kn;
+
+#ifdef DBG
+  print_list("c");
+#endif
+}
+
+// Path job for the node m of the current list.
+static void path_job_init(path_job *jb, decoder_type *dd, int m, ylitem *yrows) {
+  jb->c_m = dd->c_m;
+  jb->c_n = dd->c_n;
+  jb->m = m;
+  jb->ylist = ylist;
+  jb->lorder = lorder;
+  jb->slist = slist;
+  jb->yrows = yrows;
+  jb->y_perm = NULL;
+  jb->plist = plist;
+}
+
+// y_v = y_1 xor y_2.
+static void vxor_job(void *arg, int i0, int i1) {
+  path_job *jb = (path_job *)arg;
+  int n2 = 1 << (jb->m - 1);
+  int cur_ind0, i;
+  ylitem *yp1, *yp2, *vp;
+
+  for (i = i0; i < i1; i++) {
+    cur_ind0 = jb->lorder[i];
+    yp1 = JYLISTP(jb, cur_ind0, jb->m);
+    yp2 = yp1 + n2;
+    vp = JYLISTP(jb, cur_ind0, jb->m - 1) = jb->yrows + (size_t)i * n2;
+    VXOR_EST(yp1, yp2, vp, n2);
+  }
+}
+
+// y_u = y_1 xor v + y_2, ref to v is saved in y.
+static void yu_job(void *arg, int i0, int i1) {
+  path_job *jb = (path_job *)arg;
+  int n2 = 1 << (jb->m - 1);
+  int cur_ind0, i;
   ylitem *yp1, *yp2, *vp, *up;
+
+  for (i = i0; i < i1; i++) {
+    cur_ind0 = jb->lorder[i];
+    yp1 = JYLISTP(jb, cur_ind0, jb->m);
+    yp2 = yp1 + n2;
+    vp = JYLISTP(jb, cur_ind0, jb->m) = JYLISTP(jb, cur_ind0, jb->m - 1); // y <-- v
+    up = JYLISTP(jb, cur_ind0, jb->m - 1) = jb->yrows + (size_t)i * n2;
+    POLAR_U_EST(yp1, yp2, vp, up, n2);
+  }
+}
+
+// y_u = y_1 xor v + y_2 at the root (y is the permuted input).
+static void root_yu_job(void *arg, int i0, int i1) {
+  path_job *jb = (path_job *)arg;
+  int n2 = jb->c_n / 2;
+  int cur_ind0, i;
+  ylitem *yp, *vp, *up;
+
+  for (i = i0; i < i1; i++) {
+    cur_ind0 = jb->lorder[i];
+    vp = JYLISTP(jb, cur_ind0, jb->c_m - 1);
+    up = JYLISTP(jb, cur_ind0, jb->c_m - 1) = jb->yrows + (size_t)i * n2;
+    yp = jb->y_perm + (size_t)jb->c_n * jb->plist[cur_ind0];
+    POLAR_U_EST(yp, (yp + n2), vp, up, n2);
+  }
+}
+
+// y_dec <-- (u xor v | u).
+static void ydec_job(void *arg, int i0, int i1) {
+  path_job *jb = (path_job *)arg;
+  int n = 1 << jb->m;
+  int n2 = n / 2;
+  int cur_ind0, i;
+  ylitem *yp1, *yp2, *vp, *up;
+
+  for (i = i0; i < i1; i++) {
+    cur_ind0 = jb->lorder[i];
+    vp = JYLISTP(jb, cur_ind0, jb->m);
+    yp1 = JYLISTP(jb, cur_ind0, jb->m) = jb->yrows + (size_t)i * n;
+    yp2 = yp1 + n2;
+    up = JYLISTP(jb, cur_ind0, jb->m - 1);
+    POLAR_Y_DEC(vp, up, yp1, yp2, n2);
+  }
+}
+
+// polar_rate0_skip(): all zeroes.
+static void rate0_skip_job(void *arg, int i0, int i1) {
+  path_job *jb = (path_job *)arg;
+  int n = 1 << jb->m;
+  int cur_ind0, i, j;
+  slitem s1;
+  ylitem *yp1, *yp3;
+
+  for (i = i0; i < i1; i++) {
+    cur_ind0 = jb->lorder[i];
+    yp1 = JYLISTP(jb, cur_ind0, jb->m);
+    s1 = 0.0;
+    for (j = 0; j < n; j++) s1 += EST_TO_LNP0(yp1[j]);
+    jb->slist[cur_ind0] += s1;
+    yp3 = JYLISTP(jb, cur_ind0, jb->m) = jb->yrows + (size_t)i * n;
+    for (j = 0; j < n; j++) yp3[j] = YLDEC0;
+  }
+}
+
+// Rate-0 node: all bits are frozen.
+void polar_rate0_skip(
+  decoder_type *dd, // Decoder instance data.
+  int m
+) {
+  int n = 1 << m;
+  path_job jb;
+
+  path_job_init(&jb, dd, m, YLIST_POP_N(m, cur_lsiz));
+  team_run(dd->team, rate0_skip_job, &jb, cur_lsiz, (long)cur_lsiz * n);
+}
+
+// (Generalized) repetition node: only the last 2^s bits are info
+// (Rate-1 node if s == m).
+// The frozen halves are folded exactly as SC would do it. Then the list is
+// split at the min(L - 1, 2^s) least reliable positions of the folded vector.
+void polar_rep_branch(
+  decoder_type *dd, // Decoder instance data.
+  int m,
+  int s,
+  int peak_lsiz
+) {
+  int n = 1 << m;
+  int ns = 1 << s;
+  int nsplits = MIN(peak_lsiz - 1, ns);
+  int cur_ind0;
+  ylitem y1;
+  ylitem *yp1, *yp2;
+  xlitem *hd;
+  split_item *sp;
+  slitem s1;
+  int i, j, len;
+
+#ifdef DBG
+  printf("rep:    m=%d, s=%d.\n", m, s);
+  print_list("a");
+#endif
+
+  for (i = 0; i < cur_lsiz; i++) {
+
+    cur_ind0 = lorder[i];
+    sorig[cur_ind0] = i;
+    yp1 = YLISTP(cur_ind0, m);
+    s1 = 0.0;
+
+    // Fold: y_v = y_1 xor y_2 is frozen, y_u = y_1 + y_2.
+    for (len = n >> 1; len >= ns; len >>= 1) {
+      yp2 = yp1 + len;
+      for (j = 0; j < len; j++) {
+        y1 = XOR_EST(yp1[j], yp2[j]);
+        s1 += EST_TO_LNP0(y1);
+        ADD_EST(yp1[j], yp2[j], ytmp[j]);
+      }
+      yp1 = ytmp;
+    }
+
+    // Hard decisions and the least reliable positions.
+    hd = shd + i * (dd->c_n / 2);
+    for (len = j = 0; j < ns; j++) {
+      y1 = yp1[j];
+      if (CHECK_EST0(y1)) {
+        hd[j] = 0;
+      }
+      else {
+        y1 = INV_EST(y1);
+        hd[j] = 1;
+      }
+      s1 += EST0_TO_LNP0(y1);
+      len = sel_insert(len, nsplits, j, y1);
+    }
+    slist[cur_ind0] += s1;
+
+    sp = splits + i * (dd->c_n / 2);
+    for (j = 0; j < nsplits; j++) {
+      sp[j].pos = sel_pos[j];
+      sp[j].pos0 = -1;
+      sp[j].s = EST0_ADD_LNP1_SUB_LNP0(sel_y[j]);
+    }
+  }
+
+  polar_node_splits(dd, nsplits, peak_lsiz);
+  polar_node_finish(dd, m, s, nsplits);
+}
+
+// (Generalized) single parity check node: only the first 2^s bits are frozen.
+// It is the set of 2^s SPC codes of length 2^(m-s) interleaved with step 2^s.
+// In each SPC code the parity is fixed with the least reliable bit, then the
+// list is split at the next min(L, 2^(m-s)) - 1 least reliable positions
+// (each flip there also flips the least reliable bit back).
+void polar_spc_branch(
+  decoder_type *dd, // Decoder instance data.
+  int m,
+  int s,
+  int peak_lsiz
+) {
+  int n = 1 << m;
+  int ns = 1 << s;
+  int nsel = MIN(peak_lsiz, n >> s);
+  int cur_ind0;
   ylitem y1;
-  int i, j;
+  ylitem *yp1;
+  xlitem *hd;
+  split_item *sp;
+  slitem s1, sw;
+  int i, j, k, len, par;
+
+#ifdef DBG
+  printf("spc:    m=%d, s=%d.\n", m, s);
+  print_list("a");
+#endif
+
+  for (i = 0; i < cur_lsiz; i++) {
+
+    cur_ind0 = lorder[i];
+    sorig[cur_ind0] = i;
+    yp1 = YLISTP(cur_ind0, m);
+    hd = shd + i * (dd->c_n / 2);
+    sp = splits + i * (dd->c_n / 2);
+    s1 = 0.0;
+
+    for (j = 0; j < ns; j++) {
+
+      // Hard decisions and the least reliable positions of the SPC code.
+      par = 0;
+      for (len = 0, k = j; k < n; k += ns) {
+        y1 = yp1[k];
+        if (CHECK_EST0(y1)) {
+          hd[k] = 0;
+        }
+        else {
+          y1 = INV_EST(y1);
+          hd[k] = 1;
+          par ^= 1;
+        }
+        s1 += EST0_TO_LNP0(y1);
+        len = sel_insert(len, nsel, k, y1);
+      }
+
+      sw = EST0_ADD_LNP1_SUB_LNP0(sel_y[0]);
+      if (par) {
+        hd[sel_pos[0]] ^= 1;
+        s1 += sw;
+      }
+      for (k = 1; k < nsel; k++, sp++) {
+        sp->pos = sel_pos[k];
+        sp->pos0 = sel_pos[0];
+        sp->par0 = par;
+        sp->s = EST0_ADD_LNP1_SUB_LNP0(sel_y[k]);
+        sp->s0 = sw;
+      }
+    }
+    slist[cur_ind0] += s1;
+  }
+
+  polar_node_splits(dd, ns * (nsel - 1), peak_lsiz);
+  polar_node_finish(dd, m, m, ns * (nsel - 1));
+}
+
+// Classify the nodes of the decoding tree for Fast-SSCL.
+// node_spec[] has 2 * c_n items, see NODE_SPEC_IND().
+void polar_init_node_spec(
+  decoder_type *dd, // Decoder instance data.
+  int *node_spec
+) {
+  uint32 *nt;
+  int m, n, off, i, k, s, tail;
+
+  for (i = 0; i < 2 * dd->c_n; i++) node_spec[i] = NODE_GENERIC;
+
+  for (m = 1; m < dd->c_m; m++) {
+    n = 1 << m;
+    for (off = 0; off < dd->c_n; off += n) {
+      nt = dd->node_table + off;
+      for (k = 0, i = 0; i < n; i++) k += (nt[i] != 0);
+      if (k == 0) {
+        node_spec[NODE_SPEC_IND(dd->c_n, m, off)] = NODE_SPEC(NODE_RATE0, 0);
+        continue;
+      }
+      // Info bits only at the end?
+      for (s = 0; (1 << s) < k; s++);
+      if ((1 << s) == k) {
+        for (tail = 0, i = n - k; i < n; i++) tail += (nt[i] != 0);
+        if (tail == k) {
+          node_spec[NODE_SPEC_IND(dd->c_n, m, off)] = NODE_SPEC(NODE_REP, s);
+          continue;
+        }
+      }
+      // Frozen bits only at the beginning?
+      for (s = 0; (1 << s) < n - k; s++);
+      if (((1 << s) == n - k) && (m - s >= 2)) {
+        for (tail = 0, i = n - k; i < n; i++) tail += (nt[i] != 0);
+        if (tail == k) {
+          node_spec[NODE_SPEC_IND(dd->c_n, m, off)] = NODE_SPEC(NODE_SPC, s);
+        }
+      }
+    }
+  }
+}
+
+void polar_dec_inner(
+  decoder_type *dd, // Decoder instance data.
+  int m
+) {
+
+  int n = 1 << m;
+  int n2 = n / 2;
+  path_job jb;
+  int spec, peak;
+
+  if (node_counter + n <= dd->replay_end) {
+    polar_replay(dd, m);
+    return;
+  }
 
   if (m == 0) {
     if (node_table[node_counter] == 0) {
       polar0_skip(dd);
     }
+    else if (dd->flip_at != NULL) {
+      polar0_flip(dd);
+      CHECK_DEC_DONE(dd->c_k);
+    }
+    else if ((peak = NODE_LSIZ(node_counter)) <= 0) {
+      crc_drop_all();
+    }
     else {
-      polar0_branch(dd, node_table[node_counter]);
+      polar0_branch(dd, peak);
+      CHECK_DEC_DONE(dd->c_k);
+    }
+    if (dd->sc_rec) {
+      dd->sc_x[node_counter] = (node_table[node_counter] == 0) ? 0 : GETX(lorder[0]);
+      dd->sc_s[node_counter] = slist[lorder[0]];
     }
     node_counter++;
     return;
   }
 
+  // Fast-SSCL special nodes.
+  if (dd->node_spec != NULL) {
+    spec = dd->node_spec[NODE_SPEC_IND(dd->c_n, m, node_counter)];
+    if (NODE_SPEC_TYPE(spec) != NODE_GENERIC) {
+      peak = NODE_LSIZ(node_counter + n - 1);
+      if (NODE_SPEC_TYPE(spec) == NODE_RATE0) {
+        polar_rate0_skip(dd, m);
+      }
+      else if (peak <= 0) {
+        crc_drop_all();
+      }
+      else if (NODE_SPEC_TYPE(spec) == NODE_REP) {
+        polar_rep_branch(dd, m, NODE_SPEC_S(spec), peak);
+      }
+      else {
+        polar_spc_branch(dd, m, NODE_SPEC_S(spec), peak);
+      }
+      if (NODE_SPEC_TYPE(spec) != NODE_RATE0) CHECK_DEC_DONE(dd->c_k);
+      node_counter += n;
+      return;
+    }
+  }
+
 #ifdef DBG2
   printf("innr a: m=%d, n=%3d.\n", m, n);
   print_list("innr a");
 #endif
 
-  // Calculate y_v = y_1 xor y_2.
-  for (i = 0; i < cur_lsiz; i++) {
-     cur_ind0 = lorder[i];
-     yp1 = YLISTP(cur_ind0, m);
-     yp2 = yp1 + n2;
-     vp = YLISTP(cur_ind0, m - 1) = YLIST_POP(m - 1);
-     VXOR_EST(yp1, yp2, vp, n2);
+  // Calculate y_v = y_1 xor y_2 (not needed if v is replayed).
+  if (node_counter + n2 > dd->replay_end) {
+    path_job_init(&jb, dd, m, YLIST_POP_N(m - 1, cur_lsiz));
+    team_run(dd->team, vxor_job, &jb, cur_lsiz, (long)cur_lsiz * n2);
   }
 
   polar_dec_inner(dd, m - 1);
+  if (dec_done) return;
 
 #ifdef DBG2
   printf("innr b: m=%d, n=%3d.\n", m, n);
@@ -320,40 +957,23 @@ void polar_dec_inner(
 
   // Calculate y_u = y_1 xor v + y_2.
   // Also save ref to v in y.
-  for (i = 0; i < cur_lsiz; i++) {
-     cur_ind0 = lorder[i];
-     yp1 = YLISTP(cur_ind0, m);
-     yp2 = yp1 + n2;
-     vp = YLISTP(cur_ind0, m) = YLISTP(cur_ind0, m - 1); // y <-- v
-     up = YLISTP(cur_ind0, m - 1) = YLIST_POP(m - 1);
-     for (j = 0; j < n2; j++) {
-        y1 = EST_XOR_YLDEC(yp1[j], vp[j]); // y1 <-- y_1[j] xor v[j].
-        ADD_EST(y1, yp2[j], up[j]); // y_u <-- y1 + y_2[j];
-     }
-  }
+  path_job_init(&jb, dd, m, YLIST_POP_N(m - 1, cur_lsiz));
+  team_run(dd->team, yu_job, &jb, cur_lsiz, (long)cur_lsiz * n2);
 
 #ifdef DBG2
   printf("innr c: m=%d, n=%3d.\n", m, n);
 #endif
 
   polar_dec_inner(dd, m - 1);
+  if (dec_done) return;
 
 #ifdef DBG2
   printf("innr d: m=%d, n=%3d.\n", m, n);
 #endif
 
   // y_dec <-- (u xor v | u).
-  for (i = 0; i < cur_lsiz; i++) {
-     cur_ind0 = lorder[i];
-     vp = YLISTP(cur_ind0, m);
-     yp1 = YLISTP(cur_ind0, m) = YLIST_POP(m);
-     yp2 = yp1 + n2;
-     up = YLISTP(cur_ind0, m - 1);
-     for (j = 0; j < n2; j++) {
-        yp1[j] = XOR_YLDEC(vp[j], up[j]);
-        yp2[j] = up[j];
-     }
-  }
+  path_job_init(&jb, dd, m, YLIST_POP_N(m, cur_lsiz));
+  team_run(dd->team, ydec_job, &jb, cur_lsiz, (long)cur_lsiz * n2);
 
   YLIST_RESET(m - 1);
 }
@@ -371,23 +991,23 @@ polar_dec(
   int c_n = dd->c_n;
   int c_k = dd->c_k;
   int c_m = dd->c_m;
-  int peak_lsiz; // Peak list size.
   int flsiz; // Size of allocated list.
   ylitem *y_in;
+  ylitem *y_perm; // Permuted inputs, c_n per permutation.
+  ylitem *yp;
   int n2 = dd->c_n / 2; // Half of the current length (n).
-  int cur_ind0;
-  ylitem *vp, *up;
+  ylitem *vp;
   int *p1; // For permutations.
   slitem s1;
-  ylitem y1;
+  path_job jb;
   int *xp;
   uint8 *mem_buf_ptr;
-  int mem_buf_size;
+  size_t mem_buf_size;
 
   // ----- Shortcuts assignment.
 
   node_table = dd->node_table;
-  peak_lsiz = dd->peak_lsiz;
+  lsiz_lim = dd->peak_lsiz;
   flsiz = MAX(dd->peak_lsiz, dd->p_num) * FLSIZ_MULT;
 
   // ----- Memory allocation.
@@ -397,6 +1017,9 @@ polar_dec(
   y_in = (ylitem *)mem_buf_ptr;
   mem_buf_ptr += c_n * sizeof(ylitem);
 
+  y_perm = (ylitem *)mem_buf_ptr;
+  mem_buf_ptr += (size_t)dd->p_num * c_n * sizeof(ylitem);
+
   frind = (int *)mem_buf_ptr;
   mem_buf_ptr += flsiz * sizeof(int);
 
@@ -404,7 +1027,7 @@ polar_dec(
   mem_buf_ptr += flsiz * sizeof(int);
 
   xlist = (xlist_item *)mem_buf_ptr;
-  mem_buf_ptr += (c_k * flsiz + 1) * sizeof(xlist_item);
+  mem_buf_ptr += ((size_t)c_k * flsiz + 1) * sizeof(xlist_item);
 
   lind2xl = (xlist_item **)mem_buf_ptr;
   mem_buf_ptr += flsiz * sizeof(xlist_item *);
@@ -420,7 +1043,7 @@ polar_dec(
 #endif
   for (i = 0; i < dd->c_m; i++) {
     yitems[i] = (ylitem *)mem_buf_ptr;
-    mem_buf_ptr += (1 << i) * MAX(dd->peak_lsiz, dd->p_num) * 4 * sizeof(ylitem);
+    mem_buf_ptr += ((size_t)1 << i) * MAX(dd->peak_lsiz, dd->p_num) * 4 * sizeof(ylitem);
 #ifdef DBG2
     printf("Buffer %d: yitems[i]=%p, %ld\n", i, yitems[i], mem_buf_ptr - dd->mem_buf);
 #endif
@@ -438,6 +1061,36 @@ polar_dec(
   xtmp = (xlitem *)mem_buf_ptr;
   mem_buf_ptr += c_n * sizeof(xlitem);
 
+  if (dd->node_spec != NULL) {
+    ytmp = (ylitem *)mem_buf_ptr;
+    mem_buf_ptr += n2 * sizeof(ylitem);
+
+    sel_y = (ylitem *)mem_buf_ptr;
+    mem_buf_ptr += n2 * sizeof(ylitem);
+
+    splits = (split_item *)mem_buf_ptr;
+    mem_buf_ptr += (size_t)MAX(dd->peak_lsiz, dd->p_num) * n2 * sizeof(split_item);
+
+    shd = (xlitem *)mem_buf_ptr;
+    mem_buf_ptr += (size_t)MAX(dd->peak_lsiz, dd->p_num) * n2 * sizeof(xlitem);
+
+    sorig = (int *)mem_buf_ptr;
+    mem_buf_ptr += flsiz * sizeof(int);
+
+    sstate = (int *)mem_buf_ptr;
+    mem_buf_ptr += flsiz * sizeof(int);
+
+    sel_pos = (int *)mem_buf_ptr;
+    mem_buf_ptr += n2 * sizeof(int);
+  }
+
+  crc_hp = dd->crc_hp;
+  crc_fin = dd->crc_fin;
+  if (crc_hp != NULL) {
+    crc_state = (uint32 *)mem_buf_ptr;
+    mem_buf_ptr += flsiz * sizeof(uint32);
+  }
+
 #ifdef DBG2
   printf("\nAssigned buffer size: %ld\n", mem_buf_ptr - dd->mem_buf);
 #endif
@@ -446,10 +1099,21 @@ polar_dec(
 
   VY_TO_FORMAT(y_input, y_in, c_n);
 
+  // Gather the permuted inputs once, so that the root loops below
+  // (for all list paths) read them sequentially.
+  p1 = dd->pyarr;
+  yp = y_perm;
+  for (i = 0; i < dd->p_num * c_n; i++) yp[i] = y_in[p1[i]];
+
   for (i = 0; i < flsiz; i++) frind[i] = i;
   for (i = 0; i < 32; i++) YLIST_RESET(i);
 
   node_counter = 0;
+  info_counter = 0;
+  dec_done = 0;
+  crc_drops = 0;
+  drop_s = -FM_S_HUGE;
+  drop_xle = NULL;
 
   //---------- Root node.
 
@@ -461,13 +1125,18 @@ polar_dec(
     slist[i] = 0.0;
     lorder[i] = i;
     lind2xl[i] = xlist;
-    p1 = dd->pyarr + c_n * i;
+    yp = y_perm + c_n * i;
     vp = YLISTP(i, c_m - 1) = YLIST_POP(c_m - 1);
-    // TODO: Permutations are not usable with general Polar, but let's leave it as it is for now.
-    for (j = 0; j < n2; j++) vp[j] = XOR_EST(y_in[p1[j]], y_in[p1[j + n2]]);
+    // Only bit index permutations the info_bits_mask is invariant under (see cdc_init()).
+    // General affine automorphisms are decoded by independent decoders (ca_polar_scl_main.c).
+    if (n2 > dd->replay_end) {
+      for (j = 0; j < n2; j++) vp[j] = XOR_EST(yp[j], yp[j + n2]);
+    }
     plist[i] = i;
+    if (crc_hp != NULL) crc_state[i] = 0;
   }
   cur_lsiz = frindp = dd->p_num;
+  dd->act_lsiz = cur_lsiz;
   next_xle_ptr = xlist + 1;
   xlist[0].x = 0;
   xlist[0].p = NULL;
@@ -479,31 +1148,40 @@ polar_dec(
 
   // Decode v.
   polar_dec_inner(dd, c_m - 1);
+  if (dec_done) goto dec_end;
 
 #ifdef DBG2
   print_list("root b");
 #endif
 
   // Calculate y_u = y_1 xor v + y_2.
-  for (i = 0; i < cur_lsiz; i++) {
-    cur_ind0 = lorder[i];
-    vp = YLISTP(cur_ind0, c_m - 1);
-    up = YLISTP(cur_ind0, c_m - 1) = YLIST_POP(c_m - 1);
-    // TODO: Permutations.
-    p1 = dd->pyarr + c_n * plist[cur_ind0];
-    for (j = 0; j < n2; j++) {
-      y1 = EST_XOR_YLDEC(y_in[p1[j]], vp[j]); // y1 <-- y_1[j] xor v[j].
-      ADD_EST(y1, y_in[p1[j + n2]], up[j]); // y_u <-- y1 + y_2[j];
-    }
-  }
+  path_job_init(&jb, dd, c_m, YLIST_POP_N(c_m - 1, cur_lsiz));
+  jb.y_perm = y_perm;
+  team_run(dd->team, root_yu_job, &jb, cur_lsiz, (long)cur_lsiz * n2);
 
   // Decode u.
   polar_dec_inner(dd, c_m - 1);
 
+dec_end:
+
 #ifdef DBG
   print_list("final");
 #endif
 
+  if (cur_lsiz == 0) {
+    // All paths failed the CRC check: return the best dropped one.
+    xlist_item *xle = drop_xle;
+    for (j = c_k - 1; j >= drop_len; j--) xtmp[j] = 0;
+    for (; j >= 0; j--) {
+      xtmp[j] = xle->x;
+      xle = xle->p;
+    }
+    p1 = dd->pxarr + dd->c_k * drop_perm;
+    for (j = 0; j < c_k; j++) x_dec[p1[j]] = xtmp[j];
+    if (s_dec != NULL) (*s_dec) = drop_s;
+    return 0;
+  }
+
   if (dd->ret_list) {
 
     // Sort.
@@ -544,5 +1222,5 @@ polar_dec(
     }
   }
 
-  return 0;
+  return cur_lsiz;
 }
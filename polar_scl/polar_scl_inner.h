@@ -25,12 +25,67 @@
 
 #define FLSIZ_MULT 4
 
+// Fast-SSCL special node types (node_spec[] items).
+#define NODE_GENERIC 0 // Decoded recursively.
+#define NODE_RATE0 1 // All bits are frozen.
+#define NODE_REP 2 // Only the last 2^s bits are info (Rate-1 node if s == m).
+#define NODE_SPC 3 // Only the first 2^s bits are frozen.
+
+#define NODE_SPEC(type, s) (((s) << 2) | (type))
+#define NODE_SPEC_TYPE(spec) ((spec) & 3)
+#define NODE_SPEC_S(spec) ((spec) >> 2)
+
+// Max # of positions flipped at once by the SC-Flip decoder.
+#define SCF_ORDER_MAX 4
+
+// Index of the node (m, offset) in node_spec[].
+#define NODE_SPEC_IND(c_n, m, offset) (((c_n) >> (m)) + ((offset) >> (m)))
+
+// Node kernels of the SC based decoders (SCL, SCS, SC-Flip).
+// The node y = (y_1 | y_2) is decoded as v with y_v = y_1 xor y_2 (VXOR_EST()),
+// then as u with POLAR_U_EST() and the result is POLAR_Y_DEC().
+
+// y_u = y_1 xor v + y_2.
+#define POLAR_U_EST(yp1, yp2, vp, up, n2) { \
+  int j_; \
+  ylitem y_; \
+  for (j_ = 0; j_ < (n2); j_++) { \
+    y_ = EST_XOR_YLDEC((yp1)[j_], (vp)[j_]); \
+    ADD_EST(y_, (yp2)[j_], (up)[j_]); \
+  } \
+}
+
+// y_dec = (yp1 | yp2) <-- (u xor v | u).
+#define POLAR_Y_DEC(vp, up, yp1, yp2, n2) { \
+  int j_; \
+  for (j_ = 0; j_ < (n2); j_++) { \
+    (yp1)[j_] = XOR_YLDEC((vp)[j_], (up)[j_]); \
+    (yp2)[j_] = (up)[j_]; \
+  } \
+}
+
+// Info bit with the estimate y: x - the hard decision,
+// s0, s1 - the metric increments for x and 1 - x.
+#define POLAR_BIT_DEC(y, x, s0, s1) { \
+  ylitem y_ = (y); \
+  if (CHECK_EST0(y_)) { \
+    x = 0; \
+  } \
+  else { \
+    y_ = INV_EST(y_); \
+    x = 1; \
+  } \
+  s0 = EST0_TO_LNP0(y_); \
+  s1 = EST0_TO_LNP1(y_); \
+}
+
 
 //-----------------------------------------------------------------------------
 // Includes.
 
 #include "../common/typedefs.h"
 #include "../formats/formats.h"
+#include "../common/thread_team.h"
 
 
 //-----------------------------------------------------------------------------
@@ -41,6 +96,15 @@ typedef struct xlist_item {
   struct xlist_item* p;
 } xlist_item;
 
+// Split point of a Fast-SSCL special node.
+typedef struct {
+  int pos; // Position to flip.
+  int pos0; // Parity bit of the SPC code flipped together with pos (-1 - none).
+  int par0; // 1 - pos0 is flipped in the base codeword.
+  slitem s; // Metric increment for flipping pos.
+  slitem s0; // Metric increment for flipping pos0.
+} split_item;
+
 typedef struct {
   int c_m; // code m parameter.
   int c_n; // Code length.
@@ -52,6 +116,28 @@ typedef struct {
   int *pxarr; // permutations for inf. seq. (after decoding).
   int *pyarr; // perm. for ch. output vector (before decoding).
   int ret_list; // If 1 - return the list of all candidate inf. sequences (not just the best).
+  int *node_spec; // Special node types for Fast-SSCL (NULL - plain SCL).
+  uint32 *crc_hp; // CRC syndrome contribution of each info bit in the decoding order
+                  // (c_k per permutation, NULL - no CRC check in the decoder).
+  uint32 *crc_fin; // CRC syndrome bits that are final after each info bit (c_k per permutation).
+  double prune_margin; // Paths worse than the best one by more than this are dropped (0 - no pruning).
+  int act_lsiz; // Peak # of paths in the list during the last polar_dec() call.
+  int stack_size; // Max # of paths in the stack of the SCS decoder.
+  int scs_pops; // # of paths extended by the last polar_scs_dec() call.
+  int bp_iters; // Max # of BP iterations per permutation (0 - no BP).
+  int bp_done; // # of BP iterations done by the last polar_bp_dec() call.
+  int flip_attempts; // Max # of SC-Flip attempts after SC (0 - no SC-Flip).
+  int flip_order; // Max # of positions flipped at once.
+  double flip_alpha; // Weight of the DSCF metric.
+  int flip_done; // # of attempts made by the last polar_scf_dec() call.
+  // polar_dec() state of SC-Flip (list size 1, no CRC in the decoder).
+  int *flip_at; // 1 - flip the decision at the info bit (NULL - no SC-Flip).
+  double *flip_llr; // |LLR| at the info bits.
+  xlitem *sc_x; // Decision at each leaf (0 at the frozen ones) ...
+  slitem *sc_s; // ... and the path metric after it.
+  int sc_rec; // 1 - record sc_x[] and sc_s[].
+  int replay_end; // The leaves before it are replayed from sc_x[] and sc_s[].
+  thread_team *team; // Threads for the per-path loops of polar_dec() (NULL - the calling thread only).
   uint8 *mem_buf;
 } decoder_type;
 
@@ -59,8 +145,17 @@ typedef struct {
 //-----------------------------------------------------------------------------
 // Prototypes.
 
+// Classify the nodes of the decoding tree for Fast-SSCL.
+// node_spec[] has 2 * c_n items.
+void polar_init_node_spec(
+  decoder_type *dd, // Decoder instance data.
+  int *node_spec
+);
 
 // Decoding procedure.
+// Returns the number of candidates in the final list.
+// With CRC (crc_hp != NULL) all of them pass the CRC check. If no candidate
+// passes, returns 0 and x_dec is the best path dropped by the CRC check.
 int
 polar_dec(
   decoder_type *dd, // Decoder instance data.
@@ -69,4 +164,65 @@ polar_dec(
   double *s_dec // Metric of x_dec (set NULL, if not needed).
 );
 
+// Size of the memory buffer for polar_scs_dec().
+size_t polar_scs_membuf_size(decoder_type *dd);
+
+// SCS (stack) decoding procedure: the best path is extended first,
+// peak_lsiz limits the # of paths extended at each info bit.
+// Returns 1 if a complete path is found (with CRC - passing the check).
+// Otherwise (the stack runs out) returns 0 and x_dec is the SC completion of
+// the best dropped partial path or the better complete path dropped from the stack.
+int
+polar_scs_dec(
+  decoder_type *dd, // Decoder instance data.
+  double *y_in, // Decoder input.
+  int *x_dec, // Decoded information sequence.
+  double *s_dec // Metric of x_dec (set NULL, if not needed).
+);
+
+// Size of the memory buffer for polar_bp_dec().
+size_t polar_bp_membuf_size(decoder_type *dd);
+
+// BP decoding procedure: up to bp_iters iterations on the graph of each
+// permutation until a codeword (with CRC - passing the check) is found.
+// Returns 1 if it is found. Otherwise returns 0 and x_dec is the hard
+// decision closest to the input.
+int
+polar_bp_dec(
+  decoder_type *dd, // Decoder instance data.
+  double *y_in, // Decoder input.
+  int *x_dec, // Decoded information sequence.
+  double *s_dec // Metric of x_dec (set NULL, if not needed).
+);
+
+// Size of the SC-Flip buffers of polar_scf_dec() (the polar_dec() ones follow them).
+size_t polar_scf_membuf_size(decoder_type *dd);
+
+// SC-Flip decoding procedure (needs CRC, permutations are not used):
+// SC, then up to flip_attempts SC decodings with the decisions flipped
+// at the sets of the least reliable info bits until the CRC check passes.
+// Returns 1 if it passes. Otherwise returns 0 and x_dec is the SC result.
+int
+polar_scf_dec(
+  decoder_type *dd, // Decoder instance data.
+  double *y_in, // Decoder input.
+  int *x_dec, // Decoded information sequence.
+  double *s_dec // Metric of x_dec (set NULL, if not needed).
+);
+
+// Size of the memory buffer for polar_scan_dec().
+size_t polar_scan_membuf_size(decoder_type *dd);
+
+// SCAN (soft cancellation) decoding procedure. Permutations are not used.
+// LLRs are ln(Pr{0} / Pr{1}).
+void
+polar_scan_dec(
+  decoder_type *dd, // Decoder instance data.
+  int iters, // # of iterations.
+  uint8 *mem_buf, // polar_scan_membuf_size() bytes.
+  double *llr_in, // Channel LLRs (c_n).
+  double *llr_cw, // Extrinsic LLRs of the codeword bits (c_n, NULL if not needed).
+  double *llr_info // LLRs of the info bits in the decoding order (c_k, NULL if not needed).
+);
+
 #endif // #ifndef POLAR_SCL_INNER_H
\ No newline at end of file
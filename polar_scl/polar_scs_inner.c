@@ -0,0 +1,500 @@
+//=============================================================================
+// Polar SCS (successive cancellation stack) decoder.
+// Best-first search: only the most likely partial path is extended.
+// Uses the same internal format and path metric as polar_scl_inner.c.
+//
+// Copyright 2019 and onwards Kirill Shabunov.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=============================================================================
+
+
+//-----------------------------------------------------------------------------
+// Includes.
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../common/typedefs.h"
+#include "../common//std_defs.h"
+#include "polar_scl_inner.h"
+
+
+//-----------------------------------------------------------------------------
+// Internal defines.
+
+// Level l arrays of the SC state (2^l items) start at (2^l - 1).
+#define LVL(p, l) ((p) + (1 << (l)) - 1)
+
+// SC state of the slot: LLRs and decisions of the v-children for levels 0..c_m-1.
+#define SLOT_Y(k) (slot_buf + (size_t)(k) * 2 * (c_n - 1))
+#define SLOT_V(k) (SLOT_Y(k) + (c_n - 1))
+
+// Slot of the path failed the CRC check (-1 - the path is complete).
+#define SLOT_CRC_FAIL (-2)
+
+
+//-----------------------------------------------------------------------------
+// Internal typedefs.
+
+// Partial path in the stack.
+typedef struct {
+  slitem s; // Path metric.
+  xlist_item *xle; // Info bits of the path (the last one first).
+  int i; // # of decided bits (c_n - the path is complete).
+  int j; // # of decided info bits.
+  int slot; // SC state (-1 for the complete path, SLOT_CRC_FAIL).
+  int pend; // 1 - the decision x of the bit i - 1 is not applied to the slot yet.
+  xlitem x;
+  int perm; // Permutation index.
+  uint32 crc; // CRC syndrome.
+} scs_entry;
+
+
+//-----------------------------------------------------------------------------
+// Global data.
+
+static THREAD_LOCAL int c_n, c_m, c_k;
+static THREAD_LOCAL scs_entry *heap; // Max-heap of the paths by metric.
+static THREAD_LOCAL int heap_len, heap_max;
+static THREAD_LOCAL ylitem *y_perm; // Permuted inputs, c_n per permutation.
+static THREAD_LOCAL ylitem *slot_buf;
+static THREAD_LOCAL int *slot_ref; // # of stack entries referring to the slot.
+static THREAD_LOCAL int *slot_free; // Stack of free slots.
+static THREAD_LOCAL int slot_freep;
+static THREAD_LOCAL ylitem *comb; // Buffer for the decisions combined on the way up.
+static THREAD_LOCAL xlist_item *next_xle_ptr;
+static THREAD_LOCAL int *pops; // # of paths extended at each info bit.
+static THREAD_LOCAL int pops_total;
+static THREAD_LOCAL int sat_j; // The last info bit extended lsiz times.
+static THREAD_LOCAL int crc_drops; // # of popped paths failed the CRC check.
+
+// The best complete path and the best partial one (not failed
+// the CRC check) dropped from the stack.
+static THREAD_LOCAL scs_entry drop_full;
+static THREAD_LOCAL scs_entry drop;
+
+
+//-----------------------------------------------------------------------------
+// Functions.
+
+size_t polar_scs_membuf_size(decoder_type *dd) {
+  int n = dd->c_n;
+  int lsiz = MAX(dd->peak_lsiz, dd->p_num);
+  int slots = dd->stack_size + dd->p_num + 2;
+  size_t mem_buf_size = 0;
+
+  mem_buf_size += dd->stack_size * sizeof(scs_entry); // heap
+  mem_buf_size += (2 * (size_t)lsiz * dd->c_k + 1) * sizeof(xlist_item); // xlist
+  mem_buf_size += n * sizeof(ylitem); // y_in
+  mem_buf_size += (size_t)dd->p_num * n * sizeof(ylitem); // y_perm
+  mem_buf_size += (size_t)slots * 2 * (n - 1) * sizeof(ylitem); // slot_buf
+  mem_buf_size += 2 * n * sizeof(ylitem); // comb
+  mem_buf_size += n * sizeof(xlitem); // xtmp
+  mem_buf_size += slots * sizeof(int); // slot_ref
+  mem_buf_size += slots * sizeof(int); // slot_free
+  mem_buf_size += (dd->c_k + 1) * sizeof(int); // pops
+
+  return mem_buf_size;
+}
+
+static int slot_get(void) {
+  int k = slot_free[--slot_freep];
+  slot_ref[k] = 1;
+  return k;
+}
+
+static void slot_release(int k) {
+  if ((k >= 0) && (--slot_ref[k] == 0)) slot_free[slot_freep++] = k;
+}
+
+// The entry leaves the stack without being extended.
+static void scs_drop(scs_entry *e) {
+  if (e->i == c_n) {
+    if ((e->slot != SLOT_CRC_FAIL) && (e->s > drop_full.s)) drop_full = *e;
+  }
+  else if ((e->slot != SLOT_CRC_FAIL) && (e->s > drop.s)) {
+    drop = *e;
+  }
+  slot_release(e->slot);
+}
+
+static void heap_up(int k) {
+  scs_entry e = heap[k];
+  while ((k > 0) && (heap[(k - 1) / 2].s < e.s)) {
+    heap[k] = heap[(k - 1) / 2];
+    k = (k - 1) / 2;
+  }
+  heap[k] = e;
+}
+
+static void heap_down(int k) {
+  scs_entry e = heap[k];
+  int c;
+  while ((c = 2 * k + 1) < heap_len) {
+    if ((c + 1 < heap_len) && (heap[c + 1].s > heap[c].s)) c++;
+    if (heap[c].s <= e.s) break;
+    heap[k] = heap[c];
+    k = c;
+  }
+  heap[k] = e;
+}
+
+// Push the path. With the full stack the worst path is dropped.
+static void heap_push(scs_entry *e) {
+  int k, kmin;
+
+  if (heap_len < heap_max) {
+    heap[heap_len++] = *e;
+    heap_up(heap_len - 1);
+    return;
+  }
+  // The worst path is one of the leaves.
+  kmin = heap_len / 2;
+  for (k = kmin + 1; k < heap_len; k++) {
+    if (heap[k].s < heap[kmin].s) kmin = k;
+  }
+  if (heap[kmin].s >= e->s) {
+    scs_drop(e);
+    return;
+  }
+  scs_drop(heap + kmin);
+  heap[kmin] = *e;
+  heap_up(kmin);
+}
+
+static void heap_pop(scs_entry *e) {
+  *e = heap[0];
+  heap[0] = heap[--heap_len];
+  if (heap_len > 0) heap_down(0);
+}
+
+// ln(Pr{0} + Pr{1}) in terms of the metric increments s0 >= s1 of POLAR_BIT_DEC().
+// The formats give ln(Pr) up to a constant (e.g. ln(2 * Pr) for eps), it is
+// the same for all paths in SCL, but here paths of different lengths are compared.
+static slitem lnp_norm(slitem s0, slitem s1) {
+#ifdef PM_LLR_APPROX
+  // Max-log.
+  return s0;
+#else
+  return s0 + FM_SLOG(FM_S(1.0) + FM_SEXP(s1 - s0));
+#endif
+}
+
+// Calculate the LLR of the bit i in the slot (bits 0..i-1 are applied).
+static ylitem scs_llr(int slot, int i, ylitem *y_top) {
+  ylitem *yb = SLOT_Y(slot);
+  ylitem *vb = SLOT_V(slot);
+  ylitem *yp1, *vp, *yp;
+  int l, h, k;
+
+  if (i == 0) k = c_m;
+  else {
+    // i is in the u-subtree of the level k + 1 node.
+    for (k = 0; ((i >> k) & 1) == 0; k++);
+    h = 1 << k;
+    yp1 = (k + 1 == c_m) ? y_top : LVL(yb, k + 1);
+    vp = LVL(vb, k);
+    yp = LVL(yb, k);
+    POLAR_U_EST(yp1, (yp1 + h), vp, yp, h);
+  }
+
+  // Then the v-subtrees down to the bit: y_v = y_1 xor y_2.
+  for (l = k - 1; l >= 0; l--) {
+    h = 1 << l;
+    yp1 = (l + 1 == c_m) ? y_top : LVL(yb, l + 1);
+    yp = LVL(yb, l);
+    VXOR_EST(yp1, (yp1 + h), yp, h);
+  }
+
+  return yb[0];
+}
+
+// Apply the decision x of the bit i to the slot: update v of the first
+// level where the bit is in the v-subtree.
+static void scs_apply(int slot, int i, xlitem x) {
+  ylitem *vb = SLOT_V(slot);
+  ylitem *cur, *nxt, *vp;
+  int l, h;
+
+  cur = comb;
+  cur[0] = x ? YLDEC1 : YLDEC0;
+  // y_dec while the bit is in the u-subtree.
+  for (l = 0; (l < c_m) && ((i >> l) & 1); l++) {
+    h = 1 << l;
+    nxt = LVL(comb, l + 1);
+    vp = LVL(vb, l);
+    POLAR_Y_DEC(vp, cur, nxt, (nxt + h), h);
+    cur = nxt;
+  }
+  if (l < c_m) memcpy(LVL(vb, l), cur, (1 << l) * sizeof(ylitem));
+}
+
+// SC decoding of the dropped partial path e to the end: its bits are kept,
+// the rest are the hard decisions. The info bits are returned in x.
+static void scs_complete(decoder_type *dd, scs_entry *e, xlitem *x) {
+  ylitem *y_top = y_perm + e->perm * c_n;
+  xlist_item *xle = e->xle;
+  xlitem x1;
+  slitem s0, s1;
+  int slot, i, j;
+
+  for (j = e->j - 1; j >= 0; j--) {
+    x[j] = xle->x;
+    xle = xle->p;
+  }
+
+  // The metric is recalculated along the way.
+  slot = slot_get();
+  e->s = 0.0;
+  for (i = j = 0; i < c_n; i++) {
+    POLAR_BIT_DEC(scs_llr(slot, i, y_top), x1, s0, s1);
+    e->s -= lnp_norm(s0, s1);
+    if (dd->node_table[i] == 0) {
+      e->s += x1 ? s1 : s0;
+      x1 = 0;
+    }
+    else {
+      if (j >= e->j) {
+        x[j] = x1;
+        if ((dd->crc_hp != NULL) && x1) e->crc ^= dd->crc_hp[e->perm * c_k + j];
+      }
+      e->s += (x[j] == x1) ? s0 : s1;
+      x1 = x[j++];
+    }
+    scs_apply(slot, i, x1);
+  }
+  slot_release(slot);
+  e->i = c_n;
+  e->j = c_k;
+}
+
+// Decoding procedure.
+int
+polar_scs_dec(
+  decoder_type *dd, // Decoder instance data.
+  double *y_input, // Decoder input.
+  int *x_dec, // Decoded information sequence.
+  double *s_dec // Metric of x_dec (set NULL, if not needed).
+)
+{
+  int lsiz = MAX(dd->peak_lsiz, dd->p_num);
+  int slots = dd->stack_size + dd->p_num + 2;
+  ylitem *y_in, *y_top;
+  xlitem *xtmp;
+  xlist_item *xle;
+  scs_entry e, ch[2];
+  int nch, found = 0;
+  ylitem y;
+  xlitem x;
+  slitem s0, s1;
+  int *p1;
+  int i, j, k, k0;
+  uint8 *mem_buf_ptr;
+
+  // ----- Shortcuts assignment.
+
+  c_n = dd->c_n;
+  c_m = dd->c_m;
+  c_k = dd->c_k;
+  heap_max = dd->stack_size;
+
+  // ----- Memory allocation.
+
+  mem_buf_ptr = dd->mem_buf;
+
+  heap = (scs_entry *)mem_buf_ptr;
+  mem_buf_ptr += dd->stack_size * sizeof(scs_entry);
+
+  next_xle_ptr = (xlist_item *)mem_buf_ptr;
+  mem_buf_ptr += (2 * (size_t)lsiz * c_k + 1) * sizeof(xlist_item);
+
+  y_in = (ylitem *)mem_buf_ptr;
+  mem_buf_ptr += c_n * sizeof(ylitem);
+
+  y_perm = (ylitem *)mem_buf_ptr;
+  mem_buf_ptr += (size_t)dd->p_num * c_n * sizeof(ylitem);
+
+  slot_buf = (ylitem *)mem_buf_ptr;
+  mem_buf_ptr += (size_t)slots * 2 * (c_n - 1) * sizeof(ylitem);
+
+  comb = (ylitem *)mem_buf_ptr;
+  mem_buf_ptr += 2 * c_n * sizeof(ylitem);
+
+  xtmp = (xlitem *)mem_buf_ptr;
+  mem_buf_ptr += c_n * sizeof(xlitem);
+
+  slot_ref = (int *)mem_buf_ptr;
+  mem_buf_ptr += slots * sizeof(int);
+
+  slot_free = (int *)mem_buf_ptr;
+  mem_buf_ptr += slots * sizeof(int);
+
+  pops = (int *)mem_buf_ptr;
+  mem_buf_ptr += (c_k + 1) * sizeof(int);
+
+  // ----- Initial assignments.
+
+  VY_TO_FORMAT(y_input, y_in, c_n);
+  p1 = dd->pyarr;
+  for (i = 0; i < dd->p_num * c_n; i++) y_perm[i] = y_in[p1[i]];
+
+  for (k = 0; k < slots; k++) slot_free[k] = slots - 1 - k;
+  slot_freep = slots;
+  memset(pops, 0, (c_k + 1) * sizeof(int));
+  pops_total = 0;
+  sat_j = -1;
+  crc_drops = 0;
+  heap_len = 0;
+  drop_full.s = -FM_S_HUGE;
+
+  // The root of the list of each permutation.
+  next_xle_ptr->x = 0;
+  next_xle_ptr->p = NULL;
+
+  // Nothing is dropped: SC of the first permutation.
+  drop.s = -FM_S_HUGE;
+  drop.xle = next_xle_ptr;
+  drop.i = drop.j = 0;
+  drop.perm = 0;
+  drop.crc = 0;
+  for (k = 0; k < dd->p_num; k++) {
+    e.s = 0.0;
+    e.xle = next_xle_ptr;
+    e.i = e.j = 0;
+    e.slot = slot_get();
+    e.pend = 0;
+    e.x = 0;
+    e.perm = k;
+    e.crc = 0;
+    heap_push(&e);
+  }
+  next_xle_ptr++;
+
+  // ----- Best-first search.
+
+  while (heap_len > 0) {
+
+    heap_pop(&e);
+    if ((e.i == c_n) && (e.slot != SLOT_CRC_FAIL)) {
+      // The best path is complete.
+      found = 1;
+      break;
+    }
+
+    // Each info bit is extended at most lsiz times. Then the shorter
+    // paths are dropped as well.
+    if ((e.j <= sat_j) || (pops[e.j] >= lsiz - crc_drops)) {
+      scs_drop(&e);
+      continue;
+    }
+    if (++pops[e.j] >= lsiz - crc_drops) sat_j = e.j;
+
+    // The paths failed the CRC check keep their places as in the SCL list,
+    // so the CRC keeps its error detection ability.
+    if (e.slot == SLOT_CRC_FAIL) {
+      crc_drops++;
+      scs_drop(&e);
+      continue;
+    }
+    pops_total++;
+
+    // Copy the state shared with the sibling.
+    if (slot_ref[e.slot] > 1) {
+      k0 = e.slot;
+      slot_ref[k0]--;
+      e.slot = slot_get();
+      memcpy(SLOT_Y(e.slot), SLOT_Y(k0), 2 * (c_n - 1) * sizeof(ylitem));
+    }
+    if (e.pend) scs_apply(e.slot, e.i - 1, e.x);
+
+    // Frozen bits up to the next info bit.
+    y_top = y_perm + e.perm * c_n;
+    for (;;) {
+      if (e.i == c_n) break;
+      y = scs_llr(e.slot, e.i, y_top);
+      if (dd->node_table[e.i] != 0) break;
+      POLAR_BIT_DEC(y, x, s0, s1);
+      e.s += (x ? s1 : s0) - lnp_norm(s0, s1);
+      scs_apply(e.slot, e.i, 0);
+      e.i++;
+    }
+
+    if (e.i == c_n) {
+      // Back to the stack with the final metric.
+      slot_release(e.slot);
+      e.slot = -1;
+      e.pend = 0;
+      heap_push(&e);
+      continue;
+    }
+
+    // Branch at the info bit.
+    POLAR_BIT_DEC(y, x, s0, s1);
+    e.s -= lnp_norm(s0, s1);
+    e.i++;
+    e.pend = 1;
+    e.j++;
+    nch = 0;
+    for (k = 0; k < 2; k++) {
+      ch[k] = e;
+      ch[k].x = k ? (1 - x) : x;
+      ch[k].s += k ? s1 : s0;
+      next_xle_ptr->x = ch[k].x;
+      next_xle_ptr->p = e.xle;
+      ch[k].xle = next_xle_ptr++;
+      if (dd->crc_hp != NULL) {
+        j = e.perm * c_k + e.j - 1;
+        if (ch[k].x) ch[k].crc ^= dd->crc_hp[j];
+        if (ch[k].crc & dd->crc_fin[j]) ch[k].slot = SLOT_CRC_FAIL;
+      }
+      if (ch[k].slot >= 0) nch++;
+    }
+    // The children share the state.
+    if (nch == 0) slot_release(e.slot);
+    else slot_ref[e.slot] = nch;
+    heap_push(ch);
+    heap_push(ch + 1);
+  }
+
+  dd->scs_pops = pops_total;
+
+  if (found) {
+    xle = e.xle;
+    for (j = c_k - 1; j >= 0; j--) {
+      xtmp[j] = xle->x;
+      xle = xle->p;
+    }
+  }
+  else {
+    // The stack ran out: SC completion of the best dropped partial path,
+    // unless a better complete one (with CRC - passing the check) is dropped.
+    // The CRC keeps its error detection ability: 0 is returned anyway.
+    e = drop;
+    scs_complete(dd, &e, xtmp);
+    if ((drop_full.s > -FM_S_HUGE)
+        && (((dd->crc_hp != NULL) && (e.crc != 0)) || (drop_full.s > e.s))) {
+      e = drop_full;
+      xle = e.xle;
+      for (j = c_k - 1; j >= 0; j--) {
+        xtmp[j] = xle->x;
+        xle = xle->p;
+      }
+    }
+  }
+  p1 = dd->pxarr + c_k * e.perm;
+  for (j = 0; j < c_k; j++) x_dec[p1[j]] = xtmp[j];
+  if (s_dec != NULL) (*s_dec) = e.s;
+
+  return found;
+}
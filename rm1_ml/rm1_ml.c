@@ -54,7 +54,7 @@ int rm1_dec_sh(
 #ifdef FORMAT_EPS
    // Convert y_in to the epsilon format.
    for (i = 0; i < c_n; i++) {
-      ylist[i] = exp(y_in[i]);
+      ylist[i] = FM_EXP(y_in[i]);
       ylist[i] = (1.0 - ylist[i]) / (1.0 + ylist[i]);
    }
 #endif // FORMAT_EPS
@@ -62,7 +62,7 @@ int rm1_dec_sh(
 #ifdef FORMAT_GAMMA
    // Convert y_in to the gamma format.
    for (i = 0; i < c_n; i++) {
-      ylist[i] = exp(y_in[i]);
+      ylist[i] = FM_EXP(y_in[i]);
       ylist[i] = (1.0 - ylist[i]) / (1.0 + ylist[i]);
       ylist[i] = ((ylist[i] > 0.0) ? 1.0 : -1.0) - ylist[i];
    }
@@ -138,28 +138,31 @@ int rm1_dec_sh(
 int rm1_dec_lst(
    int c_m,
    double y_in[],
-   int lsiz, // size of the list (currently <= 4096).
+   int lsiz, // size of the list (<= 2^c_m).
    int x_dec[]
 )
 {
    int c_n = 1 << c_m;
-   int m, n, n2, i, j, ja[4096];
+   int m, n, n2, i, j, *ja;
    ylitem *ylist, *yp1, *yp2, *yp3, *yp4, y1;
-   slitem *slist, s1, s2, sa[4096];
+   slitem *slist, s1, s2, sa;
    uint8 *mem_buf;
 
+   if (lsiz > c_n) lsiz = c_n;
+
    // Allocate memory.
-   mem_buf = (uint8 *)malloc(c_n * (c_m + 1) * sizeof(ylitem) + c_n * 2 * sizeof(slitem));
+   mem_buf = (uint8 *)malloc((size_t)c_n * (c_m + 1) * sizeof(ylitem) + c_n * 2 * sizeof(slitem) + lsiz * sizeof(int));
    if (mem_buf == NULL) return 1;
    slist = (slitem *)mem_buf;
    ylist = (ylitem *)(mem_buf + c_n * 2 * sizeof(slitem));
+   ja = (int *)(mem_buf + c_n * 2 * sizeof(slitem) + (size_t)c_n * (c_m + 1) * sizeof(ylitem));
 
    // Calc. initial vector.
 
 #ifdef FORMAT_EPS
    // Convert y_in to the epsilon format.
    for (i = 0; i < c_n; i++) {
-      ylist[i] = exp(y_in[i]);
+      ylist[i] = FM_EXP(y_in[i]);
       ylist[i] = (1.0 - ylist[i]) / (1.0 + ylist[i]);
    }
 #endif // FORMAT_EPS
@@ -167,7 +170,7 @@ int rm1_dec_lst(
 #ifdef FORMAT_GAMMA
    // Convert y_in to the gamma format.
    for (i = 0; i < c_n; i++) {
-      ylist[i] = exp(y_in[i]);
+      ylist[i] = FM_EXP(y_in[i]);
       ylist[i] = (1.0 - ylist[i]) / (1.0 + ylist[i]);
       ylist[i] = ((ylist[i] > 0.0) ? 1.0 : -1.0) - ylist[i];
    }
@@ -220,17 +223,17 @@ int rm1_dec_lst(
 
    // Last end node (0, 0).
    for (j = 0; j < lsiz; j++) {
-      sa[j] = -1e300;
+      sa = -1e300;
       ja[j] = 1000;
       for (i = 0; i < c_n; i++) {
          s1 = slist[i] + EST_TO_LNP0(yp1[i]);
-         if (s1 > sa[j]) {
-            sa[j] = s1; ja[j] = i << 1; 
+         if (s1 > sa) {
+            sa = s1; ja[j] = i << 1; 
             m = i;
          }
          s1 = slist[i] + EST_TO_LNP1(yp1[i]);
-         if (s1 > sa[j]) {
-            sa[j] = s1; ja[j] = (i << 1) + 1; 
+         if (s1 > sa) {
+            sa = s1; ja[j] = (i << 1) + 1; 
             m = i;
          }
       }
@@ -238,8 +241,6 @@ int rm1_dec_lst(
    }
 
    // "Unpack" ja[] to get information bits.
-   if (lsiz > c_n) lsiz = c_n;
-   if (lsiz > 4096) lsiz = 4096;
    for (j = 0; j < lsiz; j++) {
       for (i = (j + 1) * (c_m + 1) - 1; i >= j * (c_m + 1); i--) {
          x_dec[i] = ja[j] & 1;
@@ -413,3 +414,196 @@ int rm1_dec_sh_dotp(
 
    return 0;
 }
+
+//-----------------------------------------------------------------------------
+// Fast Hadamard transform (FHT) decoders.
+// Info bits x[0..c_m] map to the codeword (mrm_enc_bsc(c_m, 1, x, c)) as
+// c_i = x[c_m] xor (a . ~i), where bit (c_m - 1 - k) of a is x[k].
+// Thus the correlation of the codeword with LLRs is
+// (-1)^(x[c_m] xor parity(a)) * FHT(llr)[a].
+
+// In-place FHT: v[a] <-- sum_i (-1)^(a . i) v[i].
+// Inner loops run over contiguous halves so the compiler can vectorize them.
+void rm1_fht(
+   int c_m,
+   double v[]
+)
+{
+   int c_n = 1 << c_m;
+   int h, i, j;
+   double a, b, c, d;
+   double *p, *q;
+
+   h = 1;
+   if (c_m >= 2) {
+      // The first two stages at once (radix 4).
+      for (i = 0; i < c_n; i += 4) {
+         a = v[i] + v[i + 1];
+         b = v[i] - v[i + 1];
+         c = v[i + 2] + v[i + 3];
+         d = v[i + 2] - v[i + 3];
+         v[i] = a + c;
+         v[i + 1] = b + d;
+         v[i + 2] = a - c;
+         v[i + 3] = b - d;
+      }
+      h = 4;
+   }
+
+   for (; h < c_n; h <<= 1) {
+      for (i = 0; i < c_n; i += 2 * h) {
+         p = v + i;
+         q = p + h;
+         for (j = 0; j < h; j++) {
+            a = p[j];
+            b = q[j];
+            p[j] = a + b;
+            q[j] = a - b;
+         }
+      }
+   }
+}
+
+static int parity(int a)
+{
+   int p = 0;
+   while (a) {
+      p ^= 1;
+      a &= a - 1;
+   }
+   return p;
+}
+
+// Candidate (a, x[c_m]) --> info bits.
+static void rm1_unpack(
+   int c_m,
+   int a,
+   int b,
+   int x_dec[]
+)
+{
+   int k;
+   for (k = 0; k < c_m; k++) x_dec[k] = (a >> (c_m - 1 - k)) & 1;
+   x_dec[c_m] = b;
+}
+
+double rm1_dec_fht(
+   int c_m,
+   double llr[],
+   int x_dec[]
+)
+{
+   int c_n = 1 << c_m;
+   int a, a_best;
+   double s_best;
+
+   rm1_fht(c_m, llr);
+
+   a_best = 0;
+   s_best = fabs(llr[0]);
+   for (a = 1; a < c_n; a++) {
+      if (fabs(llr[a]) > s_best) {
+         s_best = fabs(llr[a]);
+         a_best = a;
+      }
+   }
+   rm1_unpack(c_m, a_best, (llr[a_best] < 0.0) ^ parity(a_best), x_dec);
+
+   return 0.5 * s_best;
+}
+
+void rm1_dec_fht_il(
+   int c_m,
+   int nb,
+   double llr[],
+   int x_dec[]
+)
+{
+   int c_n = 1 << c_m;
+   int a, a_best, f, h, i, j, k;
+   double u, w, s_best;
+   double *p, *q;
+
+   // Radix 2 stages over the nb interleaved vectors: the same sums as in
+   // rm1_fht(), so the decisions are the same as of rm1_dec_fht().
+   for (h = 1; h < c_n; h <<= 1) {
+      for (i = 0; i < c_n; i += 2 * h) {
+         p = llr + (size_t)i * nb;
+         q = p + (size_t)h * nb;
+         for (j = 0; j < h * nb; j++) {
+            u = p[j];
+            w = q[j];
+            p[j] = u + w;
+            q[j] = u - w;
+         }
+      }
+   }
+
+   for (f = 0; f < nb; f++) {
+      a_best = 0;
+      s_best = fabs(llr[f]);
+      for (a = 1; a < c_n; a++) {
+         if (fabs(llr[a * nb + f]) > s_best) {
+            s_best = fabs(llr[a * nb + f]);
+            a_best = a;
+         }
+      }
+      for (k = 0; k < c_m; k++) x_dec[k * nb + f] = (a_best >> (c_m - 1 - k)) & 1;
+      x_dec[c_m * nb + f] = (llr[a_best * nb + f] < 0.0) ^ parity(a_best);
+   }
+}
+
+int rm1_dec_fht_lst(
+   int c_m,
+   double llr[],
+   int lsiz,
+   int x_dec[],
+   double s_dec[]
+)
+{
+   return rm1_dec_fht_lst_th(c_m, llr, lsiz, -HUGE_VAL, x_dec, s_dec);
+}
+
+int rm1_dec_fht_lst_th(
+   int c_m,
+   double llr[],
+   int lsiz,
+   double s_min,
+   int x_dec[],
+   double s_dec[]
+)
+{
+   int c_n = 1 << c_m;
+   int k = c_m + 1;
+   int len = 0;
+   int a, b, i, id;
+   double s;
+
+   if (lsiz > 2 * c_n) lsiz = 2 * c_n;
+
+   rm1_fht(c_m, llr);
+
+   // Keep the best candidates sorted in s_dec[], their ids (a << 1 | b)
+   // are kept in the first item of the x_dec[] rows.
+   for (a = 0; a < c_n; a++) {
+      for (b = 0; b < 2; b++) {
+         s = (b ^ parity(a)) ? -0.5 * llr[a] : 0.5 * llr[a];
+         if (s < s_min) continue;
+         if ((len == lsiz) && (s <= s_dec[len - 1])) continue;
+         if (len < lsiz) len++;
+         for (i = len - 1; (i > 0) && (s > s_dec[i - 1]); i--) {
+            s_dec[i] = s_dec[i - 1];
+            x_dec[i * k] = x_dec[(i - 1) * k];
+         }
+         s_dec[i] = s;
+         x_dec[i * k] = (a << 1) | b;
+      }
+   }
+
+   for (i = 0; i < len; i++) {
+      id = x_dec[i * k];
+      rm1_unpack(c_m, id >> 1, id & 1, x_dec + i * k);
+   }
+
+   return len;
+}
@@ -32,7 +32,7 @@ int rm1_dec_sh(
 int rm1_dec_lst(
    int c_m,
    double y_in[], // in y format.
-   int lsiz, // size of the list (currently <= 4096).
+   int lsiz, // size of the list (<= 2^c_m).
    int x_dec[]
 );
 
@@ -51,4 +51,52 @@ int rm1_dec_sh_dotp(
    int x_dec[]
 );
 
+// In-place fast Hadamard transform of v[0..2^c_m).
+void rm1_fht(
+   int c_m,
+   double v[]
+);
+
+// ML decoder based on the fast Hadamard transform. No memory allocation.
+// llr[] - LLRs ln(P(0) / P(1)), replaced with their transform.
+// Returns the metric of x_dec: sum_i (-1)^c_i * llr[i] / 2
+// (ln P(c | y) up to a constant).
+double rm1_dec_fht(
+   int c_m,
+   double llr[],
+   int x_dec[]
+);
+
+// rm1_dec_fht() of nb interleaved words: item i of word f is llr[i * nb + f],
+// info bit j of word f is x_dec[j * nb + f].
+void rm1_dec_fht_il(
+   int c_m,
+   int nb,
+   double llr[],
+   int x_dec[]
+);
+
+// List version of rm1_dec_fht(). Returns the lsiz (<= 2^(c_m + 1)) best
+// candidates sorted by the metric: x_dec[] - lsiz * (c_m + 1) info bits,
+// s_dec[] - lsiz metrics.
+// Returns the number of candidates.
+int rm1_dec_fht_lst(
+   int c_m,
+   double llr[],
+   int lsiz,
+   int x_dec[],
+   double s_dec[]
+);
+
+// rm1_dec_fht_lst() without the candidates with the metric below s_min
+// (may return less than lsiz or no candidates).
+int rm1_dec_fht_lst_th(
+   int c_m,
+   double llr[],
+   int lsiz,
+   double s_min,
+   int x_dec[],
+   double s_dec[]
+);
+
 #endif // #ifndef RM1_DEC_H
\ No newline at end of file
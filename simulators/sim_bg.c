@@ -1,5 +1,5 @@
 //=============================================================================
-// Simulation in the binary Gaussian channel
+// Simulation in the binary Gaussian channel and in the BSC
 //
 // Copyright 2001 and onwards Kirill Shabunov
 //
@@ -33,6 +33,7 @@
 #include <string.h>
 #include <time.h>
 #include "../common/std_defs.h"
+#include "../common/typedefs.h"
 #include "../common/spf_par.h"
 #include "../interfaces/simul.h"
 #include "../interfaces/codec.h"
@@ -52,6 +53,9 @@
 // Max length of file names.
 #define FN_LEN_MAX         1000
 
+// Max gap between two BSC errors (a practically infinite one).
+#define BSC_GAP_MAX        1e18
+
 // Defines for pseudorandom numbers generator.
 #ifdef USE_STDLIB_RND
 #define RND ((double)rand() / RAND_MAX)
@@ -75,6 +79,11 @@ typedef struct {
   int er_n;
   int trn_ml;
   int enml_bl;
+  double dec_time; // Total decoding time, s.
+  double lsiz_sum; // Sum of list sizes used (DEC_HAS_STATS).
+  int lsiz_max; // Max list size used (DEC_HAS_STATS).
+  int st2_n; // # of words decoded by the second stage (DEC_HAS_STAGES).
+  double st2_time; // Total decoding time of these words, s (DEC_HAS_STAGES).
 } sim_point;
 
 typedef struct {
@@ -85,6 +94,8 @@ typedef struct {
   int code_k;
   int use_rndcw; // If 1 use random codeword.
   double fixedR; // If set, simulate as if the code has this rate (error rate vs 1/R * Es/N0).
+  int bsc; // If 1 simulate the BSC, the SNR values are crossover probabilities.
+  int bsc_skip_clean; // If 1 don't decode the words without channel errors (BSC).
   int snr_num;
   int csnrn;
   double snr_db[SNR_NUM_MAX];
@@ -110,6 +121,7 @@ char snr_val_trn_token[] = "SNR_val_trn";
 char ml_lb_token[] = "ml_lb";
 char random_codeword_token[] = "random_codeword";
 char fixedR_token[] = "fixed_R";
+char channel_token[] = "channel";
 
 //-----------------------------------------------------------------------------
 // Functions.
@@ -133,6 +145,40 @@ static void sleep(clock_t wait) {
   while (goal > clock());
 }
 
+// Geometric skip: # of correct bits before the next error of the BSC,
+// lq = ln(1 - p).
+static int64 bsc_gap(double lq) {
+  double u = RND;
+  double d;
+
+  if (u <= 0.0) return (int64)BSC_GAP_MAX;
+  d = floor(log(u) / lq);
+  return (int64)MIN(d, BSC_GAP_MAX);
+}
+
+// Copy and flip the signs of the BPSK symbols at the error positions of the BSC.
+// The error positions are a single stream across the words: *next is the
+// position of the next error counted from the beginning of this word.
+// Return: # of errors.
+static int copy_add_bsc_errors(
+  double const ys[],
+  int n, // Length of y[].
+  double lq, // ln(1 - p).
+  int64 *next,
+  double yd[]
+) {
+  int ne = 0;
+
+  memcpy(yd, ys, n * sizeof(double));
+  while (*next < n) {
+    yd[*next] = -yd[*next];
+    ne++;
+    *next += 1 + bsc_gap(lq);
+  }
+  *next -= n;
+  return ne;
+}
+
 // Copy and add Gaussian noise using Marsaglia polar method.
 static void copy_add_noise(
   double const ys[],
@@ -172,6 +218,11 @@ void add_sim_points(sim_point *dst, sim_point *src1, sim_point *src2) {
   dst->er_n = src1->er_n + src2->er_n;
   dst->trn_ml = src1->trn_ml + src2->trn_ml;
   dst->enml_bl = src1->enml_bl + src2->enml_bl;
+  dst->dec_time = src1->dec_time + src2->dec_time;
+  dst->lsiz_sum = src1->lsiz_sum + src2->lsiz_sum;
+  dst->lsiz_max = MAX(src1->lsiz_max, src2->lsiz_max);
+  dst->st2_n = src1->st2_n + src2->st2_n;
+  dst->st2_time = src1->st2_time + src2->st2_time;
 }
 
 void sub_sim_points(sim_point *dst, sim_point *src1, sim_point *src2) {
@@ -181,6 +232,11 @@ void sub_sim_points(sim_point *dst, sim_point *src1, sim_point *src2) {
   dst->er_n = src1->er_n - src2->er_n;
   dst->trn_ml = src1->trn_ml - src2->trn_ml;
   dst->enml_bl = src1->enml_bl - src2->enml_bl;
+  dst->dec_time = src1->dec_time - src2->dec_time;
+  dst->lsiz_sum = src1->lsiz_sum - src2->lsiz_sum;
+  dst->lsiz_max = src1->lsiz_max; // Max can't be subtracted.
+  dst->st2_n = src1->st2_n - src2->st2_n;
+  dst->st2_time = src1->st2_time - src2->st2_time;
 }
 
 // Allocate and init a simulation instance.
@@ -190,6 +246,7 @@ int sim_init(
 ) {
   char *sp_str; // Simulation parameters string.
   sim_bg_inst *sim; // Simulator instance.
+  int bsc_p_given = 0; // 1 - BSC_p_values are given.
   // Temporary variables.
   char *token, *str1;
 
@@ -205,7 +262,7 @@ int sim_init(
   memset(sim, 0, sizeof(sim_bg_inst));
 
   // Allocate temporary string for parsing.
-  str1 = (char *)malloc(SP_STR_MAX);
+  str1 = (char *)malloc(strlen(sp_str) + 1);
   if (str1 == NULL) {
     err_msg("sim_bg init error: short of memory!");
     return RC_ERROR;
@@ -258,6 +315,22 @@ int sim_init(
     TRYGET_ONOFF_TOKEN(token, random_codeword_token, sim->use_rndcw);
     TRYGET_ONOFF_TOKEN(token, "ml_lb_hard", sim->do_ml_hd);
     TRYGET_FLOAT_TOKEN(token, fixedR_token, sim->fixedR);
+    if (strcmp(token, channel_token) == 0) {
+      token = strtok(NULL, tk_seps_prepared);
+      if (strcmp(token, "bsc") == 0) sim->bsc = 1;
+      else if (strcmp(token, "awgn") == 0) sim->bsc = 0;
+      else {
+        err_msg("sim_bg init error: unknown channel.");
+        return RC_ERROR;
+      }
+      token = strtok(NULL, tk_seps_prepared);
+      continue;
+    }
+    if (strcmp(token, "BSC_p_values") == 0) bsc_p_given = 1;
+    if (sim->snr_num < 1) {
+      TRYGET_GRDOUBLE_TOKEN(token, "BSC_p_values", sim->snr_db, sim->snr_num, SNR_NUM_MAX, "sim_bg init error: too many BSC_p values!");
+    }
+    TRYGET_ONOFF_TOKEN(token, "bsc_skip_error_free", sim->bsc_skip_clean);
 
     SPF_SKIP_UNKNOWN_PARAMETER(token);
   }
@@ -287,6 +360,18 @@ int sim_init(
     err_msg("sim_bg init error: code_n or code_k are not specified.");
     return RC_ERROR;
   }
+  if (bsc_p_given && !sim->bsc) {
+    err_msg("sim_bg init error: BSC_p_values needs channel bsc.");
+    return RC_ERROR;
+  }
+  if (sim->bsc) {
+    for (int i = 0; i < sim->snr_num; i++) {
+      if ((sim->snr_db[i] <= 0.0) || (sim->snr_db[i] >= 0.5)) {
+        err_msg("sim_bg init error: BSC crossover probability must be in (0, 0.5).");
+        return RC_ERROR;
+      }
+    }
+  }
 
   // Assign other settings and init counters in the simulation instance.
   for (int i = 0; i < sim->snr_num; i++) {
@@ -348,13 +433,21 @@ int sim_run(
   int csnrn; // Current SNR value number.
   // int trn; // (Current) trials number.
   double noise_sg; // Current value of sigma.
+  double bsc_lq = 0.0; // ln(1 - p) for the BSC.
+  int64 bsc_next = 0; // Position of the next BSC error.
   int *x; // Information vector.
   int *x_dec; // Decoded information vector.
   double *c_in; // Channel input.
   double *c_out; // Channel output.
+  int nbw = 1; // # of words decoded at once.
+  int nfr; // # of words in the current batch.
+  int *xw, *xdw; // x and x_dec of the word in the batch.
+  double *ciw, *cow; // c_in and c_out of the word in the batch.
   time_t start_time;
+  clock_t dec_start;
+  double dec_time;
   int en = 0;
-  int i;
+  int rc, i, w;
 
   sim = (sim_bg_inst *)inst;
 
@@ -365,11 +458,15 @@ int sim_run(
 
   time(&start_time); // Remember start time.
 
+#ifdef DEC_HAS_BATCH
+  nbw = MAX(1, cdc_get_batch(sim->dc_inst));
+#endif // DEC_HAS_BATCH
+
   // Allocate buffers.
-  x = (int *)malloc(c_n * sizeof(int));
-  x_dec = (int *)malloc(c_n * sizeof(int));
-  c_in = (double *)malloc(c_n * sizeof(double));
-  c_out = (double *)malloc(c_n * sizeof(double));
+  x = (int *)malloc((size_t)nbw * c_n * sizeof(int));
+  x_dec = (int *)malloc((size_t)nbw * c_n * sizeof(int));
+  c_in = (double *)malloc((size_t)nbw * c_n * sizeof(double));
+  c_out = (double *)malloc((size_t)nbw * c_n * sizeof(double));
   if ((x == NULL) || (x_dec == NULL) || (c_in == NULL) || (c_out == NULL)) {
     err_msg("sim_bg run error: short of memory.");
     return RC_ERROR;
@@ -378,7 +475,16 @@ int sim_run(
   // Main simulation loop.
   while (csnrn < sim->snr_num) {
 
-    noise_sg = 1 / sqrt(2 * c_R * db2val(sim->snr_db[csnrn]));
+    if (sim->bsc) {
+      // LLR of the hard decision is +-ln((1 - p) / p) = +-2 / sg^2.
+      double p = sim->snr_db[csnrn];
+      noise_sg = sqrt(2.0 / log((1.0 - p) / p));
+      bsc_lq = log1p(-p);
+      bsc_next = bsc_gap(bsc_lq);
+    }
+    else {
+      noise_sg = 1 / sqrt(2 * c_R * db2val(sim->snr_db[csnrn]));
+    }
 
 #ifdef DEC_NEEDS_CSNRN
     // Set current SNR # in the codec.
@@ -392,59 +498,111 @@ int sim_run(
 
     while (sim->pt[csnrn].trn < sim->trn_req[csnrn]) {
 
-      sim->pt[csnrn].trn++;
+      // Channel outputs of up to nbw words (the same random sequence as
+      // for one word at a time).
+      nfr = 0;
+      while ((nfr < nbw) && (sim->pt[csnrn].trn < sim->trn_req[csnrn])) {
 
-      // Generate random or zero code word.
-      if (sim->use_rndcw) {
-        for (i = 0; i < c_k; i++) x[i] = (RND > 0.5) ? 1 : 0;
-        enc_bpsk(sim->dc_inst, x, c_in);
-      }
-      else {
-        for (i = 0; i < c_k; i++) x[i] = 0;
-        for (i = 0; i < c_n; i++) c_in[i] = -1.0;
-      }
+        sim->pt[csnrn].trn++;
+        xw = x + nfr * c_n;
+        ciw = c_in + nfr * c_n;
+        cow = c_out + nfr * c_n;
+
+        // Generate random or zero code word.
+        if (sim->use_rndcw) {
+          for (i = 0; i < c_k; i++) xw[i] = (RND > 0.5) ? 1 : 0;
+          enc_bpsk(sim->dc_inst, xw, ciw);
+        }
+        else {
+          for (i = 0; i < c_k; i++) xw[i] = 0;
+          for (i = 0; i < c_n; i++) ciw[i] = -1.0;
+        }
 
-      // Generate channel output for the simulated codeword.
-      // (Channel simulation.)
-      // c_out <-- c_in + noise.
-      copy_add_noise(c_in, c_n, noise_sg, c_out);
+        // Generate channel output for the simulated codeword.
+        // (Channel simulation.)
+        if (sim->bsc) {
+          // c_out <-- c_in with the signs flipped at the error positions.
+          int ne = copy_add_bsc_errors(ciw, c_n, bsc_lq, &bsc_next, cow);
+          if ((ne == 0) && sim->bsc_skip_clean) {
+            // Nothing to decode: the word is decoded correctly, the ML decoder
+            // would not fail too.
+            if (sim->do_ml) sim->pt[csnrn].trn_ml++;
+            update_trn_req(sim, csnrn);
+            continue;
+          }
+        }
+        else {
+          // c_out <-- c_in + noise.
+          copy_add_noise(ciw, c_n, noise_sg, cow);
+        }
+        nfr++;
+      }
+      if (nfr == 0) continue;
 
       // Decode.
-      int rc = dec_bpsk(sim->dc_inst, c_out, x_dec);
+      dec_start = clock();
+#ifdef DEC_HAS_BATCH
+      if (nfr > 1) rc = dec_bpsk_batch(sim->dc_inst, nfr, c_out, x_dec);
+      else rc = dec_bpsk(sim->dc_inst, c_out, x_dec);
+#else
+      rc = dec_bpsk(sim->dc_inst, c_out, x_dec);
+#endif // DEC_HAS_BATCH
+      dec_time = (double)(clock() - dec_start) / CLOCKS_PER_SEC;
+      sim->pt[csnrn].dec_time += dec_time;
       if (rc == RC_ERROR) {
         err_msg("sim_bg run error: error while decoding.");
         return RC_ERROR;
       }
 
-      // Count the number of incorrect information bits.
-      en = 0;
-      for (i = 0; i < c_k; i++) if (x_dec[i] != x[i]) en++;
-      // Adjust error counters.
-      if (en) {
-        sim->pt[csnrn].en_bit += en;
-        sim->pt[csnrn].en_bl++;
-      }
+      for (w = 0; w < nfr; w++) {
+
+        xw = x + w * c_n;
+        xdw = x_dec + w * c_k;
+        ciw = c_in + w * c_n;
+        cow = c_out + w * c_n;
+
+#ifdef DEC_HAS_STATS
+        int lsiz = cdc_get_lsiz(sim->dc_inst);
+        sim->pt[csnrn].lsiz_sum += lsiz;
+        sim->pt[csnrn].lsiz_max = MAX(sim->pt[csnrn].lsiz_max, lsiz);
+#endif // DEC_HAS_STATS
+#ifdef DEC_HAS_STAGES
+        if (cdc_get_stage(sim->dc_inst) > 1) {
+          sim->pt[csnrn].st2_n++;
+          sim->pt[csnrn].st2_time += dec_time;
+        }
+#endif // DEC_HAS_STAGES
+
+        // Count the number of incorrect information bits.
+        en = 0;
+        for (i = 0; i < c_k; i++) if (xdw[i] != xw[i]) en++;
+        // Adjust error counters.
+        if (en) {
+          sim->pt[csnrn].en_bit += en;
+          sim->pt[csnrn].en_bl++;
+        }
 
-      // Count erasures.
-      if (rc == RC_DEC_ERASURE) {
-        sim->pt[csnrn].er_n++;
-      }
+        // Count erasures.
+        if (rc == RC_DEC_ERASURE) {
+          sim->pt[csnrn].er_n++;
+        }
 
-      // Check if the ML decoding would fail too.
-      if (sim->do_ml && rc != RC_DEC_ERASURE) {
-        sim->pt[csnrn].trn_ml++;
-        double d1 = 0.0, d2 = 0.0;
-        if (sim->do_ml_hd)
-          for (i = 0; i < c_n; i++) c_out[i] = (c_out[i] > 0.0) ? 1.0 : -1.0;
-        // d1 <-- dist(c_in, c_out).
-        for (i = 0; i < c_n; i++) d1 += (c_in[i] - c_out[i]) * (c_in[i] - c_out[i]);
-        // d2 <-- dist[encode(x_dec), c_out].
-        enc_bpsk(sim->dc_inst, x_dec, c_in);
-        for (i = 0; i < c_n; i++) d2 += (c_in[i] - c_out[i]) * (c_in[i] - c_out[i]);
-        if (d1 > d2) sim->pt[csnrn].enml_bl++;
-      }
+        // Check if the ML decoding would fail too.
+        if (sim->do_ml && rc != RC_DEC_ERASURE) {
+          sim->pt[csnrn].trn_ml++;
+          double d1 = 0.0, d2 = 0.0;
+          if (sim->do_ml_hd)
+            for (i = 0; i < c_n; i++) cow[i] = (cow[i] > 0.0) ? 1.0 : -1.0;
+          // d1 <-- dist(c_in, c_out).
+          for (i = 0; i < c_n; i++) d1 += (ciw[i] - cow[i]) * (ciw[i] - cow[i]);
+          // d2 <-- dist[encode(x_dec), c_out].
+          enc_bpsk(sim->dc_inst, xdw, ciw);
+          for (i = 0; i < c_n; i++) d2 += (ciw[i] - cow[i]) * (ciw[i] - cow[i]);
+          if (d1 > d2) sim->pt[csnrn].enml_bl++;
+        }
 
-      update_trn_req(sim, csnrn);
+        update_trn_req(sim, csnrn);
+      }
 
       // Check elapsed time.
       if (time(NULL) - start_time > sim->ret_int) {
@@ -478,18 +636,24 @@ sim_state_str(
 
   sim = (sim_bg_inst *)inst;
   n = sim->csnrn;
+  if (sim->bsc) {
+    sprintf(ds, "p: %.3e", sim->snr_db[n]);
+  }
+  else {
+    sprintf(ds, "SNR: %3.2f", sim->snr_db[n]);
+  }
   if (sim->do_ml) {
-    sprintf(ds,
-      "SNR: %3.2f (%d / %d), trn: %d / %d, en: %d, ML en: %d.",
-      sim->snr_db[n], n + 1, sim->snr_num,
+    sprintf(ds + strlen(ds),
+      " (%d / %d), trn: %d / %d, en: %d, ML en: %d.",
+      n + 1, sim->snr_num,
       sim->pt[n].trn, sim->trn_req[n],
       sim->pt[n].en_bl, sim->pt[n].enml_bl
     );
   }
   else {
-    sprintf(ds,
-      "SNR: %3.2f (%d / %d), trn: %d / %d, en: %d.",
-      sim->snr_db[n], n + 1, sim->snr_num,
+    sprintf(ds + strlen(ds),
+      " (%d / %d), trn: %d / %d, en: %d.",
+      n + 1, sim->snr_num,
       sim->pt[n].trn, sim->trn_req[n],
       sim->pt[n].en_bl
     );
@@ -509,29 +673,32 @@ sim_cur_res_str(
   sim = (sim_bg_inst *)inst;
   snrs_to_show = (sim->csnrn < sim->snr_num) ? sim->csnrn + 1 : sim->snr_num;
   if (sim->do_ml) {
-    sprintf(ds, "SNR\t ep_bit\t\t ep_bl\t\t epml_bl");
-    for (n = 0; n < snrs_to_show; n++) {
-      sprintf(str1,
-        "\n%3.2f\t %.3e\t %.3e\t %.3e",
-        sim->snr_db[n],
-        (double)(sim->pt[n].en_bit) / (sim->pt[n].trn * sim->code_k),
-        (double)(sim->pt[n].en_bl) / sim->pt[n].trn,
-        sim->pt[n].trn_ml ? (double)(sim->pt[n].enml_bl) / sim->pt[n].trn_ml : 0
-      );
-      strcat(ds, str1);
-    }
+    sprintf(ds, "%s\t ep_bit\t\t ep_bl\t\t epml_bl\t t, ms", sim->bsc ? "p" : "SNR");
   }
   else {
-    sprintf(ds, "SNR\t ep_bit\t\t ep_bl");
-    for (n = 0; n < snrs_to_show; n++) {
-      sprintf(str1,
-        "\n%3.2f\t %.3e\t %.3e",
-        sim->snr_db[n],
-        (double)(sim->pt[n].en_bit) / (sim->pt[n].trn * sim->code_k),
-        (double)(sim->pt[n].en_bl) / sim->pt[n].trn
-      );
+    sprintf(ds, "%s\t ep_bit\t\t ep_bl\t\t t, ms", sim->bsc ? "p" : "SNR");
+  }
+#ifdef DEC_HAS_STATS
+  strcat(ds, "\t avg L");
+#endif // DEC_HAS_STATS
+  for (n = 0; n < snrs_to_show; n++) {
+    sprintf(str1,
+      sim->bsc ? "\n%.2e\t %.3e\t %.3e" : "\n%3.2f\t %.3e\t %.3e",
+      sim->snr_db[n],
+      (double)(sim->pt[n].en_bit) / (sim->pt[n].trn * sim->code_k),
+      (double)(sim->pt[n].en_bl) / sim->pt[n].trn
+    );
+    strcat(ds, str1);
+    if (sim->do_ml) {
+      sprintf(str1, "\t %.3e", sim->pt[n].trn_ml ? (double)(sim->pt[n].enml_bl) / sim->pt[n].trn_ml : 0);
       strcat(ds, str1);
     }
+    sprintf(str1, "\t %.3g", 1000.0 * sim->pt[n].dec_time / sim->pt[n].trn);
+    strcat(ds, str1);
+#ifdef DEC_HAS_STATS
+    sprintf(str1, "\t %.3g", sim->pt[n].lsiz_sum / sim->pt[n].trn);
+    strcat(ds, str1);
+#endif // DEC_HAS_STATS
   }
 }
 
@@ -553,6 +720,11 @@ sim_save_res(
   int en_bl_n = 0;
   int er_n_n = 0;
   int enml_bl_n = 0;
+  int dec_time_n = 0;
+  int lsiz_sum_n = 0;
+  int lsiz_max_n = 0;
+  int st2_n_n = 0;
+  int st2_time_n = 0;
   char err_reading_str[] = "sim_bg saving error: error reading old res file.";
   int i, j, n, snrs_to_save;
 
@@ -619,6 +791,31 @@ sim_save_res(
       );
       if (rc == RC_OK) continue;
       if (rc == RC_ERROR) return RC_ERROR;
+      rc = tryread_group_double_param(
+        &token, dec_time_token, &pt_file[0].dec_time, sizeof(sim_point), &dec_time_n, SNR_NUM_MAX, err_reading_str
+      );
+      if (rc == RC_OK) continue;
+      if (rc == RC_ERROR) return RC_ERROR;
+      rc = tryread_group_double_param(
+        &token, lsiz_sum_token, &pt_file[0].lsiz_sum, sizeof(sim_point), &lsiz_sum_n, SNR_NUM_MAX, err_reading_str
+      );
+      if (rc == RC_OK) continue;
+      if (rc == RC_ERROR) return RC_ERROR;
+      rc = tryread_group_int_param(
+        &token, lsiz_max_token, &pt_file[0].lsiz_max, sizeof(sim_point), &lsiz_max_n, SNR_NUM_MAX, err_reading_str
+      );
+      if (rc == RC_OK) continue;
+      if (rc == RC_ERROR) return RC_ERROR;
+      rc = tryread_group_int_param(
+        &token, stage2_num_token, &pt_file[0].st2_n, sizeof(sim_point), &st2_n_n, SNR_NUM_MAX, err_reading_str
+      );
+      if (rc == RC_OK) continue;
+      if (rc == RC_ERROR) return RC_ERROR;
+      rc = tryread_group_double_param(
+        &token, stage2_time_token, &pt_file[0].st2_time, sizeof(sim_point), &st2_time_n, SNR_NUM_MAX, err_reading_str
+      );
+      if (rc == RC_OK) continue;
+      if (rc == RC_ERROR) return RC_ERROR;
       SPF_SKIP_UNKNOWN_PARAMETER(token);
     }
     free(str1);
@@ -629,13 +826,30 @@ sim_save_res(
       err_msg("sim_bg saving error: invalid old res file.");
       return RC_ERROR;
     }
+    // Decoding time and list sizes may be missing in older files.
+    if (((dec_time_n != 0) && (dec_time_n != trn_n)) || ((lsiz_sum_n != 0) && (lsiz_sum_n != trn_n))
+        || ((lsiz_max_n != 0) && (lsiz_max_n != trn_n))
+        || ((st2_n_n != 0) && (st2_n_n != trn_n)) || ((st2_time_n != 0) && (st2_time_n != trn_n))) {
+      err_msg("sim_bg saving error: invalid old res file.");
+      return RC_ERROR;
+    }
+    for (n = 0; n < snr_num; n++) {
+      if (dec_time_n == 0) pt_file[n].dec_time = 0.0;
+      if (lsiz_sum_n == 0) pt_file[n].lsiz_sum = 0.0;
+      if (lsiz_max_n == 0) pt_file[n].lsiz_max = 0;
+      if (st2_n_n == 0) pt_file[n].st2_n = 0;
+      if (st2_time_n == 0) pt_file[n].st2_time = 0.0;
+    }
 
     // Update the data.
     for (i = 0; (i <= sim->csnrn) && (i < sim->snr_num); i++) {
       if (sim->pt[i].trn == sim->pt_saved[i].trn) continue;
-      n = 0;
-      while ((snr_db[n] < sim->snr_db[i]) && (n < snr_num)) n++;
-      if ((snr_db[n] > sim->snr_db[i]) || (n >= snr_num)) {
+      // The points may be in any order (e.g. descending crossover probabilities),
+      // so look for the same value first.
+      for (n = 0; (n < snr_num) && (snr_db[n] != sim->snr_db[i]); n++);
+      if (n >= snr_num) {
+        n = 0;
+        while ((n < snr_num) && (snr_db[n] < sim->snr_db[i])) n++;
         // Make room for the new at n if required.
         for (j = snr_num; j > n; j--) {
           snr_db[j] = snr_db[j - 1];
@@ -675,6 +889,7 @@ sim_save_res(
   }
 
   fprintf(fp, "code_n %d\ncode_k %d\n\n", sim->code_n, sim->code_k);
+  if (sim->bsc) fprintf(fp, "%s bsc\n\n", channel_token);
 
   fprintf(fp, "SNR { ");
   for (n = 0; n < snrs_to_save; n++) fprintf(fp, "%g ", snr_db[n]);
@@ -716,17 +931,56 @@ sim_save_res(
   for (n = 0; n < snrs_to_save; n++) fprintf(fp, "%.3e ", pt_file[n].trn_ml ? (double)pt_file[n].enml_bl / pt_file[n].trn_ml : 0.0);
   fprintf(fp, "}\n");
 
+  fprintf(fp, "%s { ", dec_time_token);
+  for (n = 0; n < snrs_to_save; n++) fprintf(fp, "%.6e ", pt_file[n].dec_time);
+  fprintf(fp, "}\n");
+
+#ifdef DEC_HAS_STATS
+  fprintf(fp, "%s { ", lsiz_sum_token);
+  for (n = 0; n < snrs_to_save; n++) fprintf(fp, "%.0f ", pt_file[n].lsiz_sum);
+  fprintf(fp, "}\n");
+
+  fprintf(fp, "%s { ", lsiz_max_token);
+  for (n = 0; n < snrs_to_save; n++) fprintf(fp, "%d ", pt_file[n].lsiz_max);
+  fprintf(fp, "}\n");
+#endif // DEC_HAS_STATS
+
+#ifdef DEC_HAS_STAGES
+  fprintf(fp, "%s { ", stage2_num_token);
+  for (n = 0; n < snrs_to_save; n++) fprintf(fp, "%d ", pt_file[n].st2_n);
+  fprintf(fp, "}\n");
+
+  fprintf(fp, "%s { ", stage2_time_token);
+  for (n = 0; n < snrs_to_save; n++) fprintf(fp, "%.6e ", pt_file[n].st2_time);
+  fprintf(fp, "}\n");
+#endif // DEC_HAS_STAGES
+
   fprintf(fp, "\n");
-  fprintf(fp, "%% SNR   BER        WER        ERR        ML LB");
+  fprintf(fp, sim->bsc ? "%% p         BER        WER        ERR        ML LB      T, ms"
+    : "%% SNR   BER        WER        ERR        ML LB      T, ms");
+#ifdef DEC_HAS_STATS
+  fprintf(fp, "      avg L  max L");
+#endif // DEC_HAS_STATS
+#ifdef DEC_HAS_STAGES
+  fprintf(fp, "  St2 rate   St2 T, ms");
+#endif // DEC_HAS_STAGES
   for (n = 0; n < snrs_to_save; n++) {
     fprintf(fp,
-      "\n%% %3.2f  %.3e  %.3e  %.3e  %.3e",
+      sim->bsc ? "\n%% %.3e  %.3e  %.3e  %.3e  %.3e  %.3e" : "\n%% %3.2f  %.3e  %.3e  %.3e  %.3e  %.3e",
       snr_db[n],
       (double)pt_file[n].en_bit / ((double)pt_file[n].trn * sim->code_k),
       (double)pt_file[n].en_bl / pt_file[n].trn,
       (double)pt_file[n].er_n / pt_file[n].trn,
-      pt_file[n].trn_ml ? (double)pt_file[n].enml_bl / pt_file[n].trn_ml : 0.0
+      pt_file[n].trn_ml ? (double)pt_file[n].enml_bl / pt_file[n].trn_ml : 0.0,
+      1000.0 * pt_file[n].dec_time / pt_file[n].trn
     );
+#ifdef DEC_HAS_STATS
+    fprintf(fp, "  %5.2f  %5d", pt_file[n].lsiz_sum / pt_file[n].trn, pt_file[n].lsiz_max);
+#endif // DEC_HAS_STATS
+#ifdef DEC_HAS_STAGES
+    fprintf(fp, "  %.3e  %.3e", (double)pt_file[n].st2_n / pt_file[n].trn,
+      pt_file[n].st2_n ? 1000.0 * pt_file[n].st2_time / pt_file[n].st2_n : 0.0);
+#endif // DEC_HAS_STAGES
   }
 
   // Delete busy flag file.
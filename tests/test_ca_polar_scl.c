@@ -1,3 +1,6 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "../common/std_defs.h"
 #include "../interfaces/codec.h"
 #include "../formats/formats.h"
@@ -166,3 +169,996 @@ TEST(cdc_face, dec_bpsk_withNoise_erasure) {
   }
   REQUIRE_TRUE(isFailed);
 }
+
+// Both halves of the code are special nodes: (G-)REP and SPC.
+static char config_polar04_ca1_k8_l8_fast[] =
+  "c_m\1 4\1"
+  "info_bits_mask\1""0000001101111111\1"
+  "ca_polar_crc\1""1\1"
+  "list_size\1 8\1"
+  "fast_scl\1on";
+
+TEST(cdc_face, dec_bpsk_fast_noNoise) {
+  void *cdc;
+  int x[8];
+  double y[16];
+  int xd[8];
+  int rc;
+
+  rc = cdc_init(config_polar04_ca1_k8_l8_fast, &cdc);
+  REQUIRE_EQ(rc, RC_OK);
+  cdc_set_sg(cdc, 1.0);
+
+  for (int u = 0; u < 256; u++) {
+    for (int j = 0; j < 8; j++) {
+      x[j] = (u >> j) & 1;
+    }
+    enc_bpsk(cdc, x, y);
+    rc = dec_bpsk(cdc, y, xd);
+    REQUIRE_EQ(rc, RC_OK);
+    for (int i = 0; i < 8; i++) {
+      REQUIRE_EQ(xd[i], x[i]);
+    }
+  }
+}
+
+TEST(cdc_face, dec_bpsk_fast_withNoise_corrected) {
+  void *cdc;
+  int x[8];
+  double y[16];
+  int xd[8];
+  int rc;
+
+  rc = cdc_init(config_polar04_ca1_k8_l8_fast, &cdc);
+  REQUIRE_EQ(rc, RC_OK);
+  cdc_set_sg(cdc, 1.0);
+
+  for (int u = 0; u < 256; u++) {
+    for (int j = 0; j < 8; j++) {
+      x[j] = (u >> j) & 1;
+    }
+    enc_bpsk(cdc, x, y);
+    y[u % 16] = INV_EST(y[u % 16]) * 0.5;
+    rc = dec_bpsk(cdc, y, xd);
+    REQUIRE_EQ(rc, RC_OK);
+    for (int i = 0; i < 8; i++) {
+      REQUIRE_EQ(xd[i], x[i]);
+    }
+  }
+}
+
+// CRC-4 (x^4 + x + 1), checked incrementally by the decoder.
+static char config_polar04_ca4_k8_l4[] =
+  "c_m\1 4\1"
+  "info_bits_mask\1""0011011101111111\1"
+  "ca_polar_crc\1""0011\1"
+  "list_size\1 4";
+
+TEST(basic_init, cdc_init_longCrc) {
+  void *cdc;
+  char config[] =
+    "c_m\1 6\1"
+    "info_bits_mask\1""0000000000000000000000001111111111111111111111111111111111111111\1"
+    "ca_polar_crc\1""000000000000000000000000000000001\1"
+    "list_size\1 8";
+  int rc = cdc_init(config, &cdc);
+  REQUIRE_EQ(rc, RC_ERROR);
+}
+
+TEST(cdc_face, dec_bpsk_crc4_withNoise_corrected) {
+  void *cdc;
+  int x[8];
+  double y[16];
+  int xd[8];
+  int rc;
+
+  rc = cdc_init(config_polar04_ca4_k8_l4, &cdc);
+  REQUIRE_EQ(rc, RC_OK);
+  REQUIRE_EQ(cdc_get_k(cdc), 8);
+  cdc_set_sg(cdc, 1.0);
+
+  for (int u = 0; u < 256; u++) {
+    for (int j = 0; j < 8; j++) {
+      x[j] = (u >> j) & 1;
+    }
+    enc_bpsk(cdc, x, y);
+    y[u % 16] = INV_EST(y[u % 16]) * 0.5;
+    rc = dec_bpsk(cdc, y, xd);
+    REQUIRE_EQ(rc, RC_OK);
+    for (int i = 0; i < 8; i++) {
+      REQUIRE_EQ(xd[i], x[i]);
+    }
+  }
+  cdc_close(cdc);
+}
+
+static char config_polar04_ca4_k8_l4_adaptive[] =
+  "c_m\1 4\1"
+  "info_bits_mask\1""0011011101111111\1"
+  "ca_polar_crc\1""0011\1"
+  "list_size\1 4\1"
+  "adaptive_list\1on";
+
+TEST(basic_init, cdc_init_adaptiveNoCrc) {
+  void *cdc;
+  char config[] =
+    "c_m\1 4\1"
+    "info_bits_mask\1""0000001101111111\1"
+    "list_size\1 8\1"
+    "adaptive_list\1on";
+  int rc = cdc_init(config, &cdc);
+  REQUIRE_EQ(rc, RC_ERROR);
+}
+
+TEST(cdc_face, dec_bpsk_adaptive) {
+  void *cdc;
+  int x[8];
+  double y[16];
+  int xd[8];
+  int rc;
+
+  rc = cdc_init(config_polar04_ca4_k8_l4_adaptive, &cdc);
+  REQUIRE_EQ(rc, RC_OK);
+  cdc_set_sg(cdc, 1.0);
+
+  for (int u = 0; u < 256; u++) {
+    for (int j = 0; j < 8; j++) {
+      x[j] = (u >> j) & 1;
+    }
+    enc_bpsk(cdc, x, y);
+
+    // No noise: SC is enough.
+    rc = dec_bpsk(cdc, y, xd);
+    REQUIRE_EQ(rc, RC_OK);
+    REQUIRE_EQ(cdc_get_lsiz(cdc), 1);
+    for (int i = 0; i < 8; i++) {
+      REQUIRE_EQ(xd[i], x[i]);
+    }
+
+    y[u % 16] = INV_EST(y[u % 16]) * 0.5;
+    rc = dec_bpsk(cdc, y, xd);
+    REQUIRE_EQ(rc, RC_OK);
+    REQUIRE_LE(cdc_get_lsiz(cdc), 4);
+    for (int i = 0; i < 8; i++) {
+      REQUIRE_EQ(xd[i], x[i]);
+    }
+  }
+  cdc_close(cdc);
+}
+
+static char config_polar04_ca4_k8_l4_scs[] =
+  "c_m\1 4\1"
+  "info_bits_mask\1""0011011101111111\1"
+  "ca_polar_crc\1""0011\1"
+  "list_size\1 4\1"
+  "stack_size\1 16";
+
+TEST(basic_init, cdc_init_stackFast) {
+  void *cdc;
+  char config[] =
+    "c_m\1 4\1"
+    "info_bits_mask\1""0000001101111111\1"
+    "list_size\1 8\1"
+    "fast_scl\1on\1"
+    "stack_size\1 16";
+  int rc = cdc_init(config, &cdc);
+  REQUIRE_EQ(rc, RC_ERROR);
+}
+
+TEST(cdc_face, dec_bpsk_scs) {
+  void *cdc;
+  int x[8];
+  double y[16];
+  int xd[8];
+  int rc;
+
+  rc = cdc_init(config_polar04_ca4_k8_l4_scs, &cdc);
+  REQUIRE_EQ(rc, RC_OK);
+  cdc_set_sg(cdc, 1.0);
+
+  for (int u = 0; u < 256; u++) {
+    for (int j = 0; j < 8; j++) {
+      x[j] = (u >> j) & 1;
+    }
+    enc_bpsk(cdc, x, y);
+
+    // No noise: a single path is extended.
+    rc = dec_bpsk(cdc, y, xd);
+    REQUIRE_EQ(rc, RC_OK);
+    REQUIRE_EQ(cdc_get_lsiz(cdc), 1);
+    for (int i = 0; i < 8; i++) {
+      REQUIRE_EQ(xd[i], x[i]);
+    }
+
+    y[u % 16] = INV_EST(y[u % 16]) * 0.5;
+    rc = dec_bpsk(cdc, y, xd);
+    REQUIRE_EQ(rc, RC_OK);
+    REQUIRE_LE(cdc_get_lsiz(cdc), 4);
+    for (int i = 0; i < 8; i++) {
+      REQUIRE_EQ(xd[i], x[i]);
+    }
+  }
+  cdc_close(cdc);
+}
+
+TEST(cdc_face, dec_bpsk_scs_erasure) {
+  void *cdc;
+  int x[] = {0, 0, 0, 0, 0, 0, 0, 0};
+  double y[16];
+  int xd[8];
+  int rc;
+
+  rc = cdc_init(config_polar04_ca4_k8_l4_scs, &cdc);
+  REQUIRE_EQ(rc, RC_OK);
+  cdc_set_sg(cdc, 1.0);
+  enc_bpsk(cdc, x, y);
+  y[0] = INV_EST(y[0]);
+  y[2] = INV_EST(y[2]);
+  y[4] = INV_EST(y[4]);
+  y[5] = INV_EST(y[5]);
+
+  rc = dec_bpsk(cdc, y, xd);
+  REQUIRE_EQ(rc, RC_DEC_ERASURE);
+  cdc_close(cdc);
+}
+
+static char config_polar04_ca1_k8_scan[] =
+  "c_m\1 4\1"
+  "info_bits_mask\1""0000001101111111\1"
+  "ca_polar_crc\1""1\1"
+  "list_size\1 1\1"
+  "scan_iterations\1 2";
+
+TEST(basic_init, cdc_init_scanNegative) {
+  void *cdc;
+  char config[] =
+    "c_m\1 4\1"
+    "info_bits_mask\1""0000001101111111\1"
+    "list_size\1 1\1"
+    "scan_iterations\1 -1";
+  int rc = cdc_init(config, &cdc);
+  REQUIRE_EQ(rc, RC_ERROR);
+}
+
+TEST(cdc_face, dec_soft_noNoise) {
+  void *cdc;
+  int x[8];
+  double y[16];
+  double llr_cw[16], llr_info[8];
+  int rc;
+
+  rc = cdc_init(config_polar04_ca1_k8_scan, &cdc);
+  REQUIRE_EQ(rc, RC_OK);
+  cdc_set_sg(cdc, 1.0);
+
+  for (int u = 0; u < 256; u++) {
+    for (int j = 0; j < 8; j++) {
+      x[j] = (u >> j) & 1;
+    }
+    enc_bpsk(cdc, x, y);
+    rc = dec_soft(cdc, 1, y, llr_cw, llr_info);
+    REQUIRE_EQ(rc, RC_OK);
+    for (int i = 0; i < 8; i++) {
+      REQUIRE_EQ(llr_info[i] < 0.0, x[i]);
+    }
+    // 0 is sent as -1.
+    for (int i = 0; i < 16; i++) {
+      REQUIRE_EQ(llr_cw[i] < 0.0, y[i] > 0.0);
+    }
+  }
+  cdc_close(cdc);
+}
+
+TEST(cdc_face, dec_soft_batch) {
+  void *cdc;
+  int x[4 * 8];
+  double y[4 * 16];
+  double llr_cw[4 * 16], llr_info[4 * 8];
+  int rc;
+
+  rc = cdc_init(config_polar04_ca1_k8_scan, &cdc);
+  REQUIRE_EQ(rc, RC_OK);
+  cdc_set_sg(cdc, 1.0);
+
+  for (int u = 0; u < 256; u++) {
+    for (int f = 0; f < 4; f++) {
+      for (int j = 0; j < 8; j++) {
+        x[f * 8 + j] = ((u + 67 * f) >> j) & 1;
+      }
+      enc_bpsk(cdc, x + f * 8, y + f * 16);
+      y[f * 16 + (u + f) % 16] = INV_EST(y[f * 16 + (u + f) % 16]) * 0.5;
+    }
+    rc = dec_soft(cdc, 4, y, llr_cw, NULL);
+    REQUIRE_EQ(rc, RC_OK);
+    rc = dec_soft(cdc, 4, y, NULL, llr_info);
+    REQUIRE_EQ(rc, RC_OK);
+    for (int i = 0; i < 4 * 8; i++) {
+      REQUIRE_EQ(llr_info[i] < 0.0, x[i]);
+    }
+    // The flipped symbol is corrected by the extrinsic information.
+    for (int f = 0; f < 4; f++) {
+      int i = f * 16 + (u + f) % 16;
+      REQUIRE_EQ(llr_cw[i] - 2.0 * y[i] < 0.0, INV_EST(y[i]) > 0.0);
+    }
+  }
+  cdc_close(cdc);
+}
+
+static char config_polar04_ca4_k8_bp[] =
+  "c_m\1 4\1"
+  "info_bits_mask\1""0011011101111111\1"
+  "ca_polar_crc\1""0011\1"
+  "list_size\1 1\1"
+  "bp_iterations\1 30";
+
+TEST(basic_init, cdc_init_bpStack) {
+  void *cdc;
+  char config[] =
+    "c_m\1 4\1"
+    "info_bits_mask\1""0000001101111111\1"
+    "list_size\1 4\1"
+    "stack_size\1 16\1"
+    "bp_iterations\1 30";
+  int rc = cdc_init(config, &cdc);
+  REQUIRE_EQ(rc, RC_ERROR);
+}
+
+TEST(cdc_face, dec_bpsk_bp) {
+  void *cdc;
+  int x[8];
+  double y[16];
+  int xd[8];
+  int rc;
+
+  rc = cdc_init(config_polar04_ca4_k8_bp, &cdc);
+  REQUIRE_EQ(rc, RC_OK);
+  cdc_set_sg(cdc, 1.0);
+
+  for (int u = 0; u < 256; u++) {
+    for (int j = 0; j < 8; j++) {
+      x[j] = (u >> j) & 1;
+    }
+    enc_bpsk(cdc, x, y);
+
+    // No noise: stops after the first iteration.
+    rc = dec_bpsk(cdc, y, xd);
+    REQUIRE_EQ(rc, RC_OK);
+    REQUIRE_EQ(cdc_get_lsiz(cdc), 1);
+    for (int i = 0; i < 8; i++) {
+      REQUIRE_EQ(xd[i], x[i]);
+    }
+
+    y[u % 16] = INV_EST(y[u % 16]) * 0.5;
+    rc = dec_bpsk(cdc, y, xd);
+    REQUIRE_EQ(rc, RC_OK);
+    for (int i = 0; i < 8; i++) {
+      REQUIRE_EQ(xd[i], x[i]);
+    }
+  }
+  cdc_close(cdc);
+}
+
+// RM(1, 4) with the cyclic permutations.
+static char config_rm0104_bp_perm[] =
+  "c_m\1 4\1"
+  "info_bits_mask\1""0000000100010111\1"
+  "list_size\1 1\1"
+  "bp_iterations\1 10\1"
+  "permutations\1{\1"
+  "0\1" "1\1" "2\1" "3\1"
+  "1\1" "2\1" "3\1" "0\1"
+  "2\1" "3\1" "0\1" "1\1"
+  "3\1" "0\1" "1\1" "2\1"
+  "}";
+
+TEST(basic_init, cdc_init_permNotInvariant) {
+  void *cdc;
+  char config[] =
+    "c_m\1 4\1"
+    "info_bits_mask\1""0011011101111111\1"
+    "list_size\1 1\1"
+    "permutations\1{\1"
+    "0\1" "1\1" "2\1" "3\1"
+    "1\1" "2\1" "3\1" "0\1"
+    "}";
+  int rc = cdc_init(config, &cdc);
+  REQUIRE_EQ(rc, RC_ERROR);
+}
+
+TEST(cdc_face, dec_bpsk_bp_perm) {
+  void *cdc;
+  int x[5];
+  double y[16];
+  int xd[5];
+  int rc;
+
+  rc = cdc_init(config_rm0104_bp_perm, &cdc);
+  REQUIRE_EQ(rc, RC_OK);
+  REQUIRE_EQ(cdc_get_k(cdc), 5);
+  cdc_set_sg(cdc, 1.0);
+
+  for (int u = 0; u < 32; u++) {
+    for (int j = 0; j < 5; j++) {
+      x[j] = (u >> j) & 1;
+    }
+    enc_bpsk(cdc, x, y);
+    rc = dec_bpsk(cdc, y, xd);
+    REQUIRE_EQ(rc, RC_OK);
+    for (int i = 0; i < 5; i++) {
+      REQUIRE_EQ(xd[i], x[i]);
+    }
+
+    // d = 8: any 3 errors are corrected by ML.
+    y[u % 16] = INV_EST(y[u % 16]);
+    y[(u + 5) % 16] = INV_EST(y[(u + 5) % 16]);
+    y[(u + 11) % 16] = INV_EST(y[(u + 11) % 16]) * 0.5;
+    rc = dec_bpsk(cdc, y, xd);
+    REQUIRE_EQ(rc, RC_OK);
+    for (int i = 0; i < 5; i++) {
+      REQUIRE_EQ(xd[i], x[i]);
+    }
+  }
+  cdc_close(cdc);
+}
+
+static char config_polar04_ca4_k8_cascade[] =
+  "c_m\1 4\1"
+  "info_bits_mask\1""0011011101111111\1"
+  "ca_polar_crc\1""0011\1"
+  "list_size\1 1\1"
+  "cascade_list_size\1 4";
+
+TEST(basic_init, cdc_init_cascadeNoCrc) {
+  void *cdc;
+  char config[] =
+    "c_m\1 4\1"
+    "info_bits_mask\1""0000001101111111\1"
+    "list_size\1 1\1"
+    "cascade_list_size\1 4";
+  int rc = cdc_init(config, &cdc);
+  REQUIRE_EQ(rc, RC_ERROR);
+}
+
+TEST(cdc_face, dec_bpsk_cascade) {
+  void *cdc;
+  int x[8];
+  double y[16];
+  int xd[8];
+  int rc, st2_n = 0;
+
+  rc = cdc_init(config_polar04_ca4_k8_cascade, &cdc);
+  REQUIRE_EQ(rc, RC_OK);
+  cdc_set_sg(cdc, 1.0);
+
+  for (int u = 0; u < 256; u++) {
+    for (int j = 0; j < 8; j++) {
+      x[j] = (u >> j) & 1;
+    }
+    enc_bpsk(cdc, x, y);
+
+    // No noise: SC is enough.
+    rc = dec_bpsk(cdc, y, xd);
+    REQUIRE_EQ(rc, RC_OK);
+    REQUIRE_EQ(cdc_get_stage(cdc), 1);
+    REQUIRE_EQ(cdc_get_lsiz(cdc), 1);
+
+    y[u % 16] = INV_EST(y[u % 16]);
+    rc = dec_bpsk(cdc, y, xd);
+    REQUIRE_EQ(rc, RC_OK);
+    for (int i = 0; i < 8; i++) {
+      REQUIRE_EQ(xd[i], x[i]);
+    }
+    if (cdc_get_stage(cdc) == 2) {
+      REQUIRE_EQ(cdc_get_lsiz(cdc), 4);
+      st2_n++;
+    }
+  }
+  // Some words need the second stage.
+  REQUIRE_GT(st2_n, 0);
+  REQUIRE_LT(st2_n, 256);
+  cdc_close(cdc);
+}
+
+TEST(basic_init, cdc_init_cascadeThreshold) {
+  void *cdc;
+  char config_neg[] =
+    "c_m\1 4\1"
+    "info_bits_mask\1""0011011101111111\1"
+    "ca_polar_crc\1""0011\1"
+    "list_size\1 1\1"
+    "cascade_list_size\1 4\1"
+    "cascade_threshold\1 -1";
+  char config_nocascade[] =
+    "c_m\1 4\1"
+    "info_bits_mask\1""0011011101111111\1"
+    "ca_polar_crc\1""0011\1"
+    "list_size\1 1\1"
+    "cascade_threshold\1 1";
+  REQUIRE_EQ(cdc_init(config_neg, &cdc), RC_ERROR);
+  REQUIRE_EQ(cdc_init(config_nocascade, &cdc), RC_ERROR);
+}
+
+TEST(cdc_face, dec_bpsk_cascadeThreshold) {
+  void *cdc;
+  char config[] =
+    "c_m\1 4\1"
+    "info_bits_mask\1""0011011101111111\1"
+    "ca_polar_crc\1""0011\1"
+    "list_size\1 1\1"
+    "cascade_list_size\1 4\1"
+    "cascade_threshold\1 1";
+  int x[8];
+  double y[16];
+  int xd[8];
+  int rc;
+
+  rc = cdc_init(config, &cdc);
+  REQUIRE_EQ(rc, RC_OK);
+  cdc_set_sg(cdc, 1.0);
+
+  for (int u = 0; u < 256; u++) {
+    for (int j = 0; j < 8; j++) {
+      x[j] = (u >> j) & 1;
+    }
+    enc_bpsk(cdc, x, y);
+
+    // Distance 0.
+    rc = dec_bpsk(cdc, y, xd);
+    REQUIRE_EQ(rc, RC_OK);
+    REQUIRE_EQ(cdc_get_stage(cdc), 1);
+
+    // Distance 2.25: the second stage even if SC passes the CRC check.
+    y[u % 16] = INV_EST(y[u % 16]) * 0.5;
+    rc = dec_bpsk(cdc, y, xd);
+    REQUIRE_EQ(rc, RC_OK);
+    REQUIRE_EQ(cdc_get_stage(cdc), 2);
+    for (int i = 0; i < 8; i++) {
+      REQUIRE_EQ(xd[i], x[i]);
+    }
+  }
+  cdc_close(cdc);
+}
+
+TEST(basic_init, cdc_init_maskLength) {
+  void *cdc;
+  char config[] =
+    "c_m\1 5\1"
+    "info_bits_mask\1""0000001101111111\1"
+    "list_size\1 1";
+  int rc = cdc_init(config, &cdc);
+  REQUIRE_EQ(rc, RC_ERROR);
+}
+
+TEST(cdc_face, dec_bpsk_long) {
+  // RM(8, 17) as a polar code: n = 2^17, k = 2^16.
+  int m = 17, n = 1 << 17, k = 0;
+  char *config = (char *)malloc(n + 64);
+  int *x, *xd;
+  double *y;
+  void *cdc;
+  int rc, i, j, w;
+
+  sprintf(config, "c_m\1 %d\1list_size\1 2\1info_bits_mask\1", m);
+  w = strlen(config);
+  for (i = 0; i < n; i++) {
+    for (j = 0, rc = 0; j < m; j++) rc += (i >> j) & 1;
+    config[w + i] = (rc > 8) ? '1' : '0';
+    k += config[w + i] - '0';
+  }
+  config[w + n] = 0;
+  rc = cdc_init(config, &cdc);
+  free(config);
+  REQUIRE_EQ(rc, RC_OK);
+  REQUIRE_EQ(cdc_get_n(cdc), n);
+  REQUIRE_EQ(cdc_get_k(cdc), k);
+  cdc_set_sg(cdc, 1.0);
+
+  x = (int *)malloc(k * sizeof(int));
+  xd = (int *)malloc(k * sizeof(int));
+  y = (double *)malloc(n * sizeof(double));
+  for (i = 0; i < k; i++) x[i] = (i * 7 + i / 3) & 1;
+  enc_bpsk(cdc, x, y);
+  for (i = 0; i < n; i += 1000) y[i] = INV_EST(y[i]) * 0.5;
+  rc = dec_bpsk(cdc, y, xd);
+  REQUIRE_EQ(rc, RC_OK);
+  for (i = 0; i < k; i++) {
+    REQUIRE_EQ(xd[i], x[i]);
+  }
+  free(x);
+  free(xd);
+  free(y);
+  cdc_close(cdc);
+}
+
+// Polar m = 5, k = 16 (GA at 2 dB) with CRC: 4 transvections
+// j_a <-- j_a + j_b (a < b) keep the code.
+static char config_polar05_ca4_k16_ae[] =
+  "c_m\1 5\1"
+  "info_bits_mask\1""00000000000101110001011111111111\1"
+  "ca_polar_crc\1""0011\1"
+  "list_size\1 1\1"
+  "automorphisms\1 8";
+
+// RM(2, 5): all the transvections keep the code.
+static char config_rm0205_ae[] =
+  "c_m\1 5\1"
+  "info_bits_mask\1""00000001000101110001011101111111\1"
+  "list_size\1 1\1"
+  "automorphisms\1 8";
+
+static char config_rm0205_sc[] =
+  "c_m\1 5\1"
+  "info_bits_mask\1""00000001000101110001011101111111\1"
+  "list_size\1 1";
+
+TEST(basic_init, cdc_init_aeNoAutomorphisms) {
+  // Polar m = 7, k = 64 (GA at 2 dB): only the lower triangular ones.
+  void *cdc;
+  char config[] =
+    "c_m\1 7\1"
+    "info_bits_mask\1""00000000000000000000000000000001000000000001011100010111011111110000000100010111000111111111111100111111111111111111111111111111\1"
+    "list_size\1 1\1"
+    "automorphisms\1 2";
+  int rc = cdc_init(config, &cdc);
+  REQUIRE_EQ(rc, RC_ERROR);
+}
+
+TEST(basic_init, cdc_init_aeTooMany) {
+  // The group has 16 elements.
+  void *cdc;
+  char config[] =
+    "c_m\1 5\1"
+    "info_bits_mask\1""00000000000101110001011111111111\1"
+    "list_size\1 1\1"
+    "automorphisms\1 17";
+  int rc = cdc_init(config, &cdc);
+  REQUIRE_EQ(rc, RC_ERROR);
+}
+
+TEST(basic_init, cdc_init_aeCascade) {
+  void *cdc;
+  char config[] =
+    "c_m\1 5\1"
+    "info_bits_mask\1""00000000000101110001011111111111\1"
+    "ca_polar_crc\1""0011\1"
+    "list_size\1 1\1"
+    "cascade_list_size\1 4\1"
+    "automorphisms\1 4";
+  int rc = cdc_init(config, &cdc);
+  REQUIRE_EQ(rc, RC_ERROR);
+}
+
+TEST(cdc_face, dec_bpsk_ae_noNoise) {
+  void *cdc;
+  int x[12], xd[12];
+  double y[32];
+  int rc;
+
+  rc = cdc_init(config_polar05_ca4_k16_ae, &cdc);
+  REQUIRE_EQ(rc, RC_OK);
+  REQUIRE_EQ(cdc_get_k(cdc), 12);
+  cdc_set_sg(cdc, 1.0);
+
+  for (int u = 0; u < 4096; u += 7) {
+    for (int j = 0; j < 12; j++) {
+      x[j] = (u >> j) & 1;
+    }
+    enc_bpsk(cdc, x, y);
+    rc = dec_bpsk(cdc, y, xd);
+    REQUIRE_EQ(rc, RC_OK);
+    REQUIRE_EQ(cdc_get_lsiz(cdc), 8);
+    for (int i = 0; i < 12; i++) {
+      REQUIRE_EQ(xd[i], x[i]);
+    }
+  }
+  cdc_close(cdc);
+}
+
+TEST(cdc_face, dec_bpsk_ae) {
+  void *cdc_ae, *cdc_sc;
+  int x[16], xd[16], xs[16];
+  double y[32];
+  unsigned int rnd = 1;
+  int rc, err_ae = 0, err_sc = 0;
+
+  rc = cdc_init(config_rm0205_ae, &cdc_ae);
+  REQUIRE_EQ(rc, RC_OK);
+  rc = cdc_init(config_rm0205_sc, &cdc_sc);
+  REQUIRE_EQ(rc, RC_OK);
+  REQUIRE_EQ(cdc_get_k(cdc_ae), 16);
+  cdc_set_sg(cdc_ae, 0.7);
+  cdc_set_sg(cdc_sc, 0.7);
+
+  for (int u = 0; u < 2000; u++) {
+    for (int j = 0; j < 16; j++) {
+      rnd = rnd * 1103515245 + 12345;
+      x[j] = (rnd >> 16) & 1;
+    }
+    enc_bpsk(cdc_ae, x, y);
+    // Noise with sigma 0.7: the sum of 12 uniform numbers.
+    for (int i = 0; i < 32; i++) {
+      double s = -6.0;
+      for (int j = 0; j < 12; j++) {
+        rnd = rnd * 1103515245 + 12345;
+        s += ((rnd >> 8) & 0xFFFF) / 65536.0;
+      }
+      y[i] += 0.7 * s;
+    }
+    rc = dec_bpsk(cdc_ae, y, xd);
+    REQUIRE_EQ(rc, RC_OK);
+    rc = dec_bpsk(cdc_sc, y, xs);
+    REQUIRE_EQ(rc, RC_OK);
+    for (int i = 0; i < 16; i++) {
+      if (xd[i] != x[i]) {
+        err_ae++;
+        break;
+      }
+    }
+    for (int i = 0; i < 16; i++) {
+      if (xs[i] != x[i]) {
+        err_sc++;
+        break;
+      }
+    }
+  }
+  // The ensemble of 8 SC decoders is much better than a single one
+  // (about 3 times less errors, close to ML).
+  REQUIRE_GT(err_sc, 20);
+  REQUIRE_LT(err_ae * 2, err_sc);
+  cdc_close(cdc_ae);
+  cdc_close(cdc_sc);
+}
+
+static char config_polar05_ca4_k16_flip[] =
+  "c_m\1 5\1"
+  "info_bits_mask\1""00000000000101110001011111111111\1"
+  "ca_polar_crc\1""0011\1"
+  "list_size\1 1\1"
+  "flip_attempts\1 8\1"
+  "flip_order\1 2";
+
+static char config_polar05_ca4_k16_sc[] =
+  "c_m\1 5\1"
+  "info_bits_mask\1""00000000000101110001011111111111\1"
+  "ca_polar_crc\1""0011\1"
+  "list_size\1 1";
+
+TEST(basic_init, cdc_init_flipNoCrc) {
+  void *cdc;
+  char config[] =
+    "c_m\1 5\1"
+    "info_bits_mask\1""00000000000101110001011111111111\1"
+    "list_size\1 1\1"
+    "flip_attempts\1 8";
+  int rc = cdc_init(config, &cdc);
+  REQUIRE_EQ(rc, RC_ERROR);
+}
+
+TEST(basic_init, cdc_init_flipList) {
+  void *cdc;
+  char config[] =
+    "c_m\1 5\1"
+    "info_bits_mask\1""00000000000101110001011111111111\1"
+    "ca_polar_crc\1""0011\1"
+    "list_size\1 2\1"
+    "flip_attempts\1 8";
+  int rc = cdc_init(config, &cdc);
+  REQUIRE_EQ(rc, RC_ERROR);
+}
+
+TEST(basic_init, cdc_init_flipOrder) {
+  void *cdc;
+  char config[] =
+    "c_m\1 5\1"
+    "info_bits_mask\1""00000000000101110001011111111111\1"
+    "ca_polar_crc\1""0011\1"
+    "list_size\1 1\1"
+    "flip_attempts\1 8\1"
+    "flip_order\1 5";
+  int rc = cdc_init(config, &cdc);
+  REQUIRE_EQ(rc, RC_ERROR);
+}
+
+TEST(cdc_face, dec_bpsk_flip_noNoise) {
+  void *cdc;
+  int x[12], xd[12];
+  double y[32];
+  int rc;
+
+  rc = cdc_init(config_polar05_ca4_k16_flip, &cdc);
+  REQUIRE_EQ(rc, RC_OK);
+  REQUIRE_EQ(cdc_get_k(cdc), 12);
+  cdc_set_sg(cdc, 1.0);
+
+  for (int u = 0; u < 4096; u += 7) {
+    for (int j = 0; j < 12; j++) {
+      x[j] = (u >> j) & 1;
+    }
+    enc_bpsk(cdc, x, y);
+    rc = dec_bpsk(cdc, y, xd);
+    REQUIRE_EQ(rc, RC_OK);
+    REQUIRE_EQ(cdc_get_lsiz(cdc), 1);
+    REQUIRE_EQ(cdc_get_stage(cdc), 1);
+    for (int i = 0; i < 12; i++) {
+      REQUIRE_EQ(xd[i], x[i]);
+    }
+  }
+  cdc_close(cdc);
+}
+
+TEST(cdc_face, dec_bpsk_flip) {
+  void *cdc_f, *cdc_sc;
+  int x[12], xd[12], xs[12];
+  double y[32];
+  unsigned int rnd = 1;
+  int rc, lsiz, err_f = 0, err_sc = 0, flipped = 0;
+
+  rc = cdc_init(config_polar05_ca4_k16_flip, &cdc_f);
+  REQUIRE_EQ(rc, RC_OK);
+  rc = cdc_init(config_polar05_ca4_k16_sc, &cdc_sc);
+  REQUIRE_EQ(rc, RC_OK);
+  cdc_set_sg(cdc_f, 0.7);
+  cdc_set_sg(cdc_sc, 0.7);
+
+  for (int u = 0; u < 2000; u++) {
+    for (int j = 0; j < 12; j++) {
+      rnd = rnd * 1103515245 + 12345;
+      x[j] = (rnd >> 16) & 1;
+    }
+    enc_bpsk(cdc_f, x, y);
+    // Noise with sigma 0.7: the sum of 12 uniform numbers.
+    for (int i = 0; i < 32; i++) {
+      double s = -6.0;
+      for (int j = 0; j < 12; j++) {
+        rnd = rnd * 1103515245 + 12345;
+        s += ((rnd >> 8) & 0xFFFF) / 65536.0;
+      }
+      y[i] += 0.7 * s;
+    }
+    rc = dec_bpsk(cdc_f, y, xd);
+    REQUIRE_NE(rc, RC_ERROR);
+    lsiz = cdc_get_lsiz(cdc_f);
+    REQUIRE_GE(lsiz, 1);
+    REQUIRE_LE(lsiz, 9);
+    REQUIRE_EQ(cdc_get_stage(cdc_f), (lsiz > 1) ? 2 : 1);
+    if (lsiz > 1) flipped++;
+    dec_bpsk(cdc_sc, y, xs);
+    // Without flips it is SC.
+    if (lsiz == 1) {
+      for (int i = 0; i < 12; i++) {
+        REQUIRE_EQ(xd[i], xs[i]);
+      }
+    }
+    for (int i = 0; i < 12; i++) {
+      if (xd[i] != x[i]) {
+        err_f++;
+        break;
+      }
+    }
+    for (int i = 0; i < 12; i++) {
+      if (xs[i] != x[i]) {
+        err_sc++;
+        break;
+      }
+    }
+  }
+  // The words SC gets wrong are mostly fixed by a few flips.
+  REQUIRE_GT(err_sc, 20);
+  REQUIRE_LT(err_f * 2, err_sc);
+  REQUIRE_GE(flipped, err_sc / 2);
+  cdc_close(cdc_f);
+  cdc_close(cdc_sc);
+}
+
+static char config_polar04_ca1_k8_l8_prune[] =
+  "c_m\1 4\1"
+  "info_bits_mask\1""0000001101111111\1"
+  "ca_polar_crc\1""1\1"
+  "list_size\1 8\1"
+  "prune_margin\1 6";
+
+TEST(basic_init, cdc_init_pruneStack) {
+  void *cdc;
+  char config[] =
+    "c_m\1 4\1"
+    "info_bits_mask\1""0000001101111111\1"
+    "list_size\1 8\1"
+    "stack_size\1 16\1"
+    "prune_margin\1 6";
+  int rc = cdc_init(config, &cdc);
+  REQUIRE_EQ(rc, RC_ERROR);
+}
+
+TEST(cdc_face, dec_bpsk_prune) {
+  void *cdc;
+  int x[8];
+  double y[16];
+  int xd[8];
+  int rc;
+
+  rc = cdc_init(config_polar04_ca1_k8_l8_prune, &cdc);
+  REQUIRE_EQ(rc, RC_OK);
+
+  // Strong input: only the best path survives.
+  cdc_set_sg(cdc, 0.5);
+  for (int u = 0; u < 256; u++) {
+    for (int j = 0; j < 8; j++) {
+      x[j] = (u >> j) & 1;
+    }
+    enc_bpsk(cdc, x, y);
+    rc = dec_bpsk(cdc, y, xd);
+    REQUIRE_EQ(rc, RC_OK);
+    REQUIRE_EQ(cdc_get_lsiz(cdc), 1);
+    for (int i = 0; i < 8; i++) {
+      REQUIRE_EQ(xd[i], x[i]);
+    }
+  }
+
+  // Weak input: the list grows.
+  cdc_set_sg(cdc, 2.0);
+  enc_bpsk(cdc, x, y);
+  rc = dec_bpsk(cdc, y, xd);
+  REQUIRE_EQ(rc, RC_OK);
+  REQUIRE_GT(cdc_get_lsiz(cdc), 1);
+  REQUIRE_LE(cdc_get_lsiz(cdc), 8);
+  cdc_close(cdc);
+}
+
+// Polar m = 7, k = 64 (GA at 2 dB), L = 256: 256 * 64 LLRs at the root
+// is above TEAM_MIN_WORK.
+#define POLAR07_K64_L256_CFG \
+  "c_m\1 7\1" \
+  "info_bits_mask\1""00000000000000000000000000000001000000000001011100010111011111110000000100010111000111111111111100111111111111111111111111111111\1" \
+  "list_size\1 256"
+
+TEST(basic_init, cdc_init_listThreads) {
+  void *cdc;
+  char config_zero[] = POLAR07_K64_L256_CFG "\1list_threads\1 0";
+  char config_ae[] =
+    "c_m\1 5\1"
+    "info_bits_mask\1""00000001000101110001011101111111\1"
+    "list_size\1 1\1"
+    "automorphisms\1 8\1"
+    "list_threads\1 2";
+  REQUIRE_EQ(cdc_init(config_zero, &cdc), RC_ERROR);
+  REQUIRE_EQ(cdc_init(config_ae, &cdc), RC_ERROR);
+}
+
+// The per-path loops split between threads: the same decisions as with one thread.
+static void list_threads_check(char *config_1, char *config_t) {
+  void *cdc_1, *cdc_t;
+  int x[64], x1[64], xt[64];
+  double y[128];
+  unsigned int seed = 12345;
+
+  REQUIRE_EQ(cdc_init(config_1, &cdc_1), RC_OK);
+  REQUIRE_EQ(cdc_init(config_t, &cdc_t), RC_OK);
+  REQUIRE_EQ(cdc_get_k(cdc_1), 64);
+  cdc_set_sg(cdc_1, 0.8);
+  cdc_set_sg(cdc_t, 0.8);
+  for (int u = 0; u < 16; u++) {
+    for (int j = 0; j < 64; j++) x[j] = ((u * 37 + 11) >> (j % 7)) & 1;
+    enc_bpsk(cdc_1, x, y);
+    for (int i = 0; i < 128; i++) {
+      seed = seed * 1103515245 + 12345;
+      y[i] += 2.4 * ((double)(seed >> 8) / (1 << 24) - 0.5);
+    }
+    REQUIRE_EQ(dec_bpsk(cdc_1, y, x1), RC_OK);
+    REQUIRE_EQ(dec_bpsk(cdc_t, y, xt), RC_OK);
+    for (int i = 0; i < 64; i++) REQUIRE_EQ(xt[i], x1[i]);
+  }
+  cdc_close(cdc_1);
+  cdc_close(cdc_t);
+}
+
+TEST(cdc_face, dec_bpsk_listThreads) {
+  char config_1[] = POLAR07_K64_L256_CFG;
+  char config_t[] = POLAR07_K64_L256_CFG "\1list_threads\1 4";
+  list_threads_check(config_1, config_t);
+}
+
+TEST(cdc_face, dec_bpsk_listThreadsFast) {
+  char config_1[] = POLAR07_K64_L256_CFG "\1fast_scl\1on";
+  char config_t[] = POLAR07_K64_L256_CFG "\1fast_scl\1on\1list_threads\1 4";
+  list_threads_check(config_1, config_t);
+}
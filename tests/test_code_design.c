@@ -0,0 +1,112 @@
+#include <stdlib.h>
+#include <math.h>
+#include "../common/std_defs.h"
+#include "../common/srm_utils.h"
+#include "../common/code_design.h"
+#include <tau/tau.h>
+
+TAU_MAIN()
+
+TEST(polar, ga_mask_n8) {
+  double mean[8];
+  uint32 mask[8];
+  uint32 ref[8] = {0, 0, 0, 1, 0, 1, 1, 1};
+
+  polar_ga_means(3, design_sigma(2.0, 0.5), mean);
+  REQUIRE_EQ(polar_design_mask(3, 4, mean, mask), 0);
+  for (int i = 0; i < 8; i++) {
+    REQUIRE_EQ(mask[i], ref[i]);
+  }
+}
+
+TEST(polar, ga_monotone) {
+  double mean[16];
+
+  // The bit channels are ordered by the partial order of polarization.
+  polar_ga_means(4, design_sigma(1.0, 0.5), mean);
+  REQUIRE_LT(mean[0], mean[1]);
+  REQUIRE_LT(mean[1], mean[3]);
+  REQUIRE_LT(mean[7], mean[15]);
+  REQUIRE_LT(mean[14], mean[15]);
+}
+
+TEST(polar, ga_long) {
+  int m = 16, n = 1 << 16, k = 0;
+  double *mean = (double *)malloc(n * sizeof(double));
+  uint32 *mask = (uint32 *)malloc(n * sizeof(uint32));
+
+  polar_ga_means(m, design_sigma(1.5, 0.5), mean);
+  for (int i = 0; i < n; i++) {
+    REQUIRE(isfinite(mean[i]));
+  }
+  REQUIRE_EQ(polar_design_mask(m, n / 2, mean, mask), 0);
+  for (int i = 0; i < n; i++) k += mask[i];
+  REQUIRE_EQ(k, n / 2);
+  REQUIRE_EQ(mask[0], 0);
+  REQUIRE_EQ(mask[n - 1], 1);
+  free(mean);
+  free(mask);
+}
+
+TEST(polar, mc_errors) {
+  double pe[16], mean[16];
+  double sg = design_sigma(1.0, 0.5);
+
+  REQUIRE_EQ(polar_mc_errors(4, sg, 2000, 1, pe), 0);
+  REQUIRE_GT(pe[0], pe[15]);
+  REQUIRE_GT(pe[0], 0.1);
+  REQUIRE_LT(pe[15], 0.01);
+  // MC agrees with GA on the best channel.
+  polar_ga_means(4, sg, mean);
+  REQUIRE_LT(fabs(pe[0] - exp(ln_q_func(sqrt(mean[0] / 2.0)))), 0.1);
+}
+
+TEST(polar, mc_agrees_with_ga) {
+  int n = 1 << 10;
+  double *pe = (double *)malloc(n * sizeof(double));
+  double *mean = (double *)malloc(n * sizeof(double));
+  double sg = design_sigma(2.0, 0.5);
+
+  REQUIRE_EQ(polar_mc_errors(10, sg, 500, 1, pe), 0);
+  polar_ga_means(10, sg, mean);
+  // The reliable channels by GA are reliable in the simulation too.
+  for (int i = 0; i < n; i++) {
+    if (mean[i] > 30.0) {
+      REQUIRE_LT(pe[i], 0.05);
+    }
+  }
+  free(pe);
+  free(mean);
+}
+
+TEST(polar, ga_long_mc) {
+  int m = 17, n = 1 << 17;
+  double *pe = (double *)malloc(n * sizeof(double));
+  double *mean = (double *)malloc(n * sizeof(double));
+  uint32 *mask = (uint32 *)malloc(n * sizeof(uint32));
+  double sg = design_sigma(2.0, 0.5), s = 0.0;
+
+  // The GA design of a long code holds in the simulation.
+  polar_ga_means(m, sg, mean);
+  REQUIRE_EQ(polar_design_mask(m, n / 2, mean, mask), 0);
+  REQUIRE_EQ(polar_mc_errors(m, sg, 5, 1, pe), 0);
+  for (int i = 0; i < n; i++) {
+    if (mask[i]) s += pe[i];
+  }
+  REQUIRE_LT(s, 0.2);
+  free(pe);
+  free(mean);
+  free(mask);
+}
+
+TEST(srm, border_nodes) {
+  uint32 node_table[6];
+
+  REQUIRE_EQ(srm_border_node_num(4, 2), 6);
+  REQUIRE_EQ(srm_design_mask(4, 2, 11, design_sigma(3.0, 0.7), node_table), 11);
+  for (int i = 0; i < 6; i++) {
+    REQUIRE_EQ(node_table[i], 1);
+  }
+  REQUIRE_EQ(srm_design_mask(4, 2, 10, design_sigma(3.0, 0.7), node_table), 10);
+  REQUIRE_EQ(calc_srm_k(4, 2, node_table), 10);
+}
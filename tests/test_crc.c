@@ -1,3 +1,4 @@
+#include <string.h>
 #include <tau/tau.h>
 #include "../common/crc.h"
 
@@ -30,4 +31,65 @@ TEST(face, is_valid_crc) {
 
   REQUIRE_TRUE(is_valid_crc(x_valid, 8, crc, 3, buf));
   REQUIRE_FALSE(is_valid_crc(x_invalid, 8, crc, 3, buf));
-}
\ No newline at end of file
+}
+TEST(engine, calc_crc_example) {
+  int x[] = {1, 0, 0, 1, 0, 0, 0, 0};
+  int crc_poly[] = {0, 1, 1};
+  uint8 xp[1];
+  crc_engine *ce = crc_engine_init(crc_poly, 3);
+
+  REQUIRE(ce != NULL);
+  crc_pack_bits(x, 8, xp);
+  REQUIRE_EQ(xp[0], 0x90);
+  REQUIRE_EQ(crc_calc_bits(ce, x, 8), 7);
+  REQUIRE_EQ(crc_calc_packed(ce, xp, 8), 7);
+  crc_engine_free(ce);
+}
+
+TEST(engine, init_badLen) {
+  int crc_poly[CRC_LEN_MAX + 1] = {0};
+
+  REQUIRE(crc_engine_init(crc_poly, 0) == NULL);
+  REQUIRE(crc_engine_init(crc_poly, CRC_LEN_MAX + 1) == NULL);
+}
+
+// Both engine paths against the bit-serial calc_crc() and is_valid_crc().
+TEST(engine, crossCheck) {
+  int x[300], buf[300], poly[CRC_LEN_MAX];
+  uint8 xp[300 / 8 + 1];
+  unsigned int rnd = 12345;
+
+  for (int t = 0; t < 2000; t++) {
+    int crc_len = 1 + t % CRC_LEN_MAX;
+    int x_len = crc_len + (t * 7) % (300 - crc_len + 1);
+    uint64 s = 0;
+    int *crc;
+    crc_engine *ce;
+
+    for (int j = 0; j < crc_len; j++) {
+      rnd = rnd * 1103515245 + 12345;
+      poly[j] = (rnd >> 16) & 1;
+    }
+    for (int j = 0; j < x_len; j++) {
+      rnd = rnd * 1103515245 + 12345;
+      x[j] = (rnd >> 16) & 1;
+    }
+    ce = crc_engine_init(poly, crc_len);
+    REQUIRE(ce != NULL);
+
+    crc = calc_crc(x, x_len, poly, crc_len, buf);
+    for (int j = 0; j < crc_len; j++) s |= (uint64)crc[j] << (crc_len - 1 - j);
+    crc_pack_bits(x, x_len, xp);
+    REQUIRE_EQ(crc_calc_bits(ce, x, x_len), s);
+    REQUIRE_EQ(crc_calc_packed(ce, xp, x_len), s);
+
+    if (x_len >= 2 * crc_len) {
+      int info_len = x_len - crc_len;
+      REQUIRE_EQ(crc_check_bits(ce, x, info_len), is_valid_crc(x, info_len, poly, crc_len, buf));
+      crc = calc_crc(x, info_len, poly, crc_len, buf);
+      memcpy(x + info_len, crc, crc_len * sizeof(int));
+      REQUIRE_TRUE(crc_check_bits(ce, x, info_len));
+    }
+    crc_engine_free(ce);
+  }
+}
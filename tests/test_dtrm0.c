@@ -137,3 +137,55 @@ TEST(cdc_face, dec_bpsk_withNoise_error) {
   }
   REQUIRE_TRUE(isFailed);
 }
+
+TEST(basic_init, cdc_init_badBatch) {
+  void *cdc;
+  char config[] =
+    "RM_m\1 4\1"
+    "RM_r\1 2\1"
+    "batch_size\1 0";
+  int rc = cdc_init(config, &cdc);
+  REQUIRE_NE(rc, 0);
+}
+
+// Batch decoding gives the same words as one at a time.
+TEST(cdc_face, dec_bpsk_batch) {
+  void *cdc;
+  char config[] =
+    "RM_m\1 6\1"
+    "RM_r\1 3\1"
+    "batch_size\1 8";
+  int nfr = 8, n, k, f, i;
+  unsigned int rnd = 12345;
+  double y[8 * 64];
+  int x[8 * 42], xd[8 * 42], xb[8 * 42];
+
+  int rc = cdc_init(config, &cdc);
+  REQUIRE_EQ(rc, 0);
+  REQUIRE_EQ(cdc_get_batch(cdc), 8);
+  n = cdc_get_n(cdc);
+  k = cdc_get_k(cdc);
+  cdc_set_sg(cdc, 0.7);
+
+  for (f = 0; f < nfr; f++) {
+    for (i = 0; i < k; i++) {
+      rnd = rnd * 1103515245 + 12345;
+      x[f * k + i] = (rnd >> 16) & 1;
+    }
+    enc_bpsk(cdc, x + f * k, y + f * n);
+    for (i = 0; i < n; i++) {
+      rnd = rnd * 1103515245 + 12345;
+      y[f * n + i] += 0.7 * (((rnd >> 16) & 0x7fff) / 16384.0 - 1.0);
+    }
+  }
+  // dec_bpsk_batch() changes nothing in y.
+  rc = dec_bpsk_batch(cdc, nfr, y, xb);
+  REQUIRE_EQ(rc, 0);
+  for (f = 0; f < nfr; f++) {
+    dec_bpsk(cdc, y + f * n, xd + f * k);
+  }
+  for (i = 0; i < nfr * k; i++) {
+    REQUIRE_EQ(xb[i], xd[i]);
+  }
+  cdc_close(cdc);
+}
@@ -0,0 +1,82 @@
+#include "../interfaces/codec.h"
+#include <tau/tau.h>
+
+TAU_MAIN()
+
+TEST(basic_init, cdc_init_ok) {
+  void *cdc;
+  char config[] =
+    "RM_m\1 6\1"
+    "RM_r\1 3";
+  int rc = cdc_init(config, &cdc);
+  REQUIRE_EQ(rc, 0);
+  REQUIRE_EQ(cdc_get_batch(cdc), 1);
+  cdc_close(cdc);
+}
+
+TEST(basic_init, cdc_init_badBatch) {
+  void *cdc;
+  char config[] =
+    "RM_m\1 6\1"
+    "RM_r\1 3\1"
+    "batch_size\1 65";
+  int rc = cdc_init(config, &cdc);
+  REQUIRE_NE(rc, 0);
+}
+
+// Batch sizes 1 and 8 give the same words on noisy input
+// (11 words: a full batch and a partial one).
+TEST(cdc_face, dec_bpsk_batch) {
+  void *cdc1, *cdc8;
+  char config1[] =
+    "RM_m\1 6\1"
+    "RM_r\1 3";
+  char config8[] =
+    "RM_m\1 6\1"
+    "RM_r\1 3\1"
+    "batch_size\1 8";
+  int nfr = 11, n, k, f, i;
+  unsigned int rnd = 12345;
+  double y[11 * 64];
+  int x[11 * 42], x1[11 * 42], x8[11 * 42];
+
+  int rc = cdc_init(config1, &cdc1);
+  REQUIRE_EQ(rc, 0);
+  rc = cdc_init(config8, &cdc8);
+  REQUIRE_EQ(rc, 0);
+  REQUIRE_EQ(cdc_get_batch(cdc8), 8);
+  n = cdc_get_n(cdc1);
+  k = cdc_get_k(cdc1);
+  REQUIRE_EQ(n, 64);
+  REQUIRE_EQ(k, 42);
+  cdc_set_sg(cdc1, 0.7);
+  cdc_set_sg(cdc8, 0.7);
+
+  for (f = 0; f < nfr; f++) {
+    for (i = 0; i < k; i++) {
+      rnd = rnd * 1103515245 + 12345;
+      x[f * k + i] = (rnd >> 16) & 1;
+    }
+    enc_bpsk(cdc1, x + f * k, y + f * n);
+    for (i = 0; i < n; i++) {
+      rnd = rnd * 1103515245 + 12345;
+      y[f * n + i] += 0.7 * (((rnd >> 16) & 0x7fff) / 16384.0 - 1.0);
+    }
+  }
+  rc = dec_bpsk_batch(cdc1, nfr, y, x1);
+  REQUIRE_EQ(rc, 0);
+  rc = dec_bpsk_batch(cdc8, nfr, y, x8);
+  REQUIRE_EQ(rc, 0);
+  for (i = 0; i < nfr * k; i++) {
+    REQUIRE_EQ(x8[i], x1[i]);
+  }
+  // dec_bpsk() is the same as batch size 1.
+  for (f = 0; f < nfr; f++) {
+    dec_bpsk(cdc8, y + f * n, x8 + f * k);
+  }
+  for (i = 0; i < nfr * k; i++) {
+    REQUIRE_EQ(x8[i], x1[i]);
+  }
+  cdc_close(cdc1);
+  cdc_close(cdc8);
+}
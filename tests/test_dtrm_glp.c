@@ -0,0 +1,301 @@
+#include "../interfaces/codec.h"
+#include <tau/tau.h>
+
+TAU_MAIN()
+
+#define RM24_CFG \
+  "RM_m\1 4\1" \
+  "RM_r\1 2\1" \
+  "border_node_mask\1 111111\1" \
+  "border_node_lsize\1 4\1" \
+  "permutations\1{\1" \
+  "2\1" "3\1" "0\1" "1\1" \
+  "1\1" "3\1" "0\1" "2\1" \
+  "1\1" "2\1" "0\1" "3\1" \
+  "0\1" "3\1" "1\1" "2\1" \
+  "0\1" "2\1" "1\1" "3\1" \
+  "0\1" "1\1" "2\1" "3\1" \
+  "}"
+
+TEST(basic_init, cdc_init_ok) {
+  void *cdc;
+  char config[] = RM24_CFG;
+  int rc = cdc_init(config, &cdc);
+  REQUIRE_EQ(rc, 0);
+  REQUIRE_EQ(cdc_get_n(cdc), 16);
+  REQUIRE_EQ(cdc_get_k(cdc), 11);
+  cdc_close(cdc);
+}
+
+TEST(basic_init, cdc_init_badGroups) {
+  void *cdc;
+  char config[] = RM24_CFG "\1permutation_groups\1 0";
+  int rc = cdc_init(config, &cdc);
+  REQUIRE_NE(rc, 0);
+}
+
+static void dec_check(char *config) {
+  void *cdc;
+  int x[11], xd[11], xg[11];
+  double y[16];
+
+  int rc = cdc_init(config, &cdc);
+  REQUIRE_EQ(rc, 0);
+  cdc_set_sg(cdc, 1.0);
+  cdc_set_csnrn(cdc, 0);
+
+  for (int u = 0; u < 64; u++) {
+    for (int j = 0; j < 11; j++) x[j] = ((u * 37 + 11) >> (j % 7)) & 1;
+    enc_bpsk(cdc, x, y);
+    dec_bpsk(cdc, y, xd);
+    for (int i = 0; i < 11; i++) REQUIRE_EQ(xd[i], x[i]);
+    // One flipped symbol is always corrected (d = 4).
+    y[u % 16] = -y[u % 16];
+    dec_bpsk(cdc, y, xg);
+    for (int i = 0; i < 11; i++) REQUIRE_EQ(xg[i], x[i]);
+  }
+  cdc_close(cdc);
+}
+
+TEST(cdc_face, dec_bpsk_globalList) {
+  char config[] = RM24_CFG;
+  dec_check(config);
+}
+
+TEST(cdc_face, dec_bpsk_permutationGroups) {
+  char config[] = RM24_CFG "\1permutation_groups\1 3";
+  dec_check(config);
+}
+
+TEST(cdc_face, dec_bpsk_permutationGroupsVarList) {
+  char config[] = RM24_CFG "\1permutation_groups\1 4\1"
+    "use_variable_list\1on\1"
+    "distance_threshold\1{\1" "1\1" "4\1" "4\1" "1e9\1" "}";
+  dec_check(config);
+}
+
+#define RM24_NOPERM_CFG \
+  "RM_m\1 4\1" \
+  "RM_r\1 2\1" \
+  "border_node_mask\1 111111\1" \
+  "border_node_lsize\1 4"
+
+TEST(basic_init, cdc_init_badPrune) {
+  void *cdc;
+  char config[] = RM24_CFG "\1prune_margin\1 -1";
+  int rc = cdc_init(config, &cdc);
+  REQUIRE_NE(rc, 0);
+}
+
+TEST(cdc_face, dec_bpsk_prune) {
+  char config[] = RM24_CFG "\1prune_margin\1 8";
+  dec_check(config);
+}
+
+TEST(cdc_face, dec_bpsk_pruneListSize) {
+  void *cdc;
+  char config_pr[] = RM24_NOPERM_CFG "\1prune_margin\1 6";
+  char config_all[] = RM24_NOPERM_CFG "\1prune_margin\1 1e9";
+  int x[11], xd[11];
+  double y[16];
+  int rc;
+
+  // Strong input: only the best path survives.
+  rc = cdc_init(config_pr, &cdc);
+  REQUIRE_EQ(rc, 0);
+  cdc_set_sg(cdc, 0.5);
+  cdc_set_csnrn(cdc, 0);
+  for (int u = 0; u < 64; u++) {
+    for (int j = 0; j < 11; j++) x[j] = ((u * 37 + 11) >> (j % 7)) & 1;
+    enc_bpsk(cdc, x, y);
+    dec_bpsk(cdc, y, xd);
+    for (int i = 0; i < 11; i++) REQUIRE_EQ(xd[i], x[i]);
+    REQUIRE_EQ(cdc_get_lsiz(cdc), 1);
+  }
+  cdc_close(cdc);
+
+  // Nothing is pruned: the list gets full.
+  rc = cdc_init(config_all, &cdc);
+  REQUIRE_EQ(rc, 0);
+  cdc_set_sg(cdc, 0.5);
+  cdc_set_csnrn(cdc, 0);
+  enc_bpsk(cdc, x, y);
+  dec_bpsk(cdc, y, xd);
+  REQUIRE_EQ(cdc_get_lsiz(cdc), 4);
+  cdc_close(cdc);
+}
+
+TEST(basic_init, cdc_init_badAdaptive) {
+  void *cdc;
+  char config_not[] = RM24_CFG "\1adaptive_list\1on";
+  char config_var[] = RM24_CFG "\1adaptive_list\1on\1adaptive_threshold\1 2\1"
+    "use_variable_list\1on\1distance_threshold\1{\1 1\1 2\1 4\1 1e9\1}";
+  REQUIRE_NE(cdc_init(config_not, &cdc), 0);
+  REQUIRE_NE(cdc_init(config_var, &cdc), 0);
+}
+
+TEST(cdc_face, dec_bpsk_adaptive) {
+  void *cdc;
+  char config[] = RM24_CFG "\1adaptive_list\1on\1adaptive_threshold\1 2";
+  int x[11], xd[11];
+  double y[16];
+
+  dec_check(config);
+
+  // L = 1 is enough for the input at distance 0, a flipped symbol
+  // (distance 4) needs all the stages up to L = 4.
+  REQUIRE_EQ(cdc_init(config, &cdc), 0);
+  cdc_set_sg(cdc, 1.0);
+  cdc_set_csnrn(cdc, 0);
+  for (int j = 0; j < 11; j++) x[j] = j & 1;
+  enc_bpsk(cdc, x, y);
+  dec_bpsk(cdc, y, xd);
+  REQUIRE_EQ(cdc_get_lsiz(cdc), 1);
+  y[3] = -y[3];
+  dec_bpsk(cdc, y, xd);
+  REQUIRE_EQ(cdc_get_lsiz(cdc), 4);
+  for (int i = 0; i < 11; i++) REQUIRE_EQ(xd[i], x[i]);
+  cdc_close(cdc);
+}
+
+TEST(basic_init, cdc_init_badCascade) {
+  void *cdc;
+  char config_not[] = RM24_CFG "\1cascade_list_size\1 8";
+  char config_adaptive[] = RM24_CFG "\1cascade_list_size\1 8\1cascade_threshold\1 2\1"
+    "adaptive_list\1on\1adaptive_threshold\1 2";
+  REQUIRE_NE(cdc_init(config_not, &cdc), 0);
+  REQUIRE_NE(cdc_init(config_adaptive, &cdc), 0);
+}
+
+TEST(cdc_face, dec_bpsk_cascade) {
+  void *cdc;
+  char config[] = RM24_CFG "\1cascade_list_size\1 8\1cascade_threshold\1 2";
+  int x[11], xd[11];
+  double y[16];
+
+  dec_check(config);
+
+  // The input at distance 0 is decoded by the first stage, a flipped
+  // symbol (distance 4) by the second one.
+  REQUIRE_EQ(cdc_init(config, &cdc), 0);
+  cdc_set_sg(cdc, 1.0);
+  cdc_set_csnrn(cdc, 0);
+  for (int j = 0; j < 11; j++) x[j] = j & 1;
+  enc_bpsk(cdc, x, y);
+  dec_bpsk(cdc, y, xd);
+  REQUIRE_EQ(cdc_get_stage(cdc), 1);
+  REQUIRE_EQ(cdc_get_lsiz(cdc), 4);
+  y[3] = -y[3];
+  dec_bpsk(cdc, y, xd);
+  REQUIRE_EQ(cdc_get_stage(cdc), 2);
+  REQUIRE_EQ(cdc_get_lsiz(cdc), 8);
+  for (int i = 0; i < 11; i++) REQUIRE_EQ(xd[i], x[i]);
+  cdc_close(cdc);
+}
+
+TEST(basic_init, cdc_init_badRm1List) {
+  void *cdc;
+  char config_neg[] = RM24_CFG "\1rm1_list_size\1 -1";
+  char config_big[] = RM24_CFG "\1rm1_list_size\1 65";
+  REQUIRE_NE(cdc_init(config_neg, &cdc), 0);
+  REQUIRE_NE(cdc_init(config_big, &cdc), 0);
+}
+
+TEST(cdc_face, dec_bpsk_rm1List) {
+  char config[] = RM24_CFG "\1rm1_list_size\1 4";
+  dec_check(config);
+}
+
+TEST(cdc_face, dec_bpsk_rm1ListPrune) {
+  char config[] = RM24_CFG "\1rm1_list_size\1 4\1prune_margin\1 8";
+  dec_check(config);
+}
+
+// With the list size 2^k both decoders are ML: the same decisions.
+TEST(cdc_face, dec_bpsk_rm1ListML) {
+  void *cdc_r, *cdc_f;
+  char config_r[] = "RM_m\1 4\1RM_r\1 2\1border_node_mask\1 111111\1border_node_lsize\1 2048";
+  char config_f[] = "RM_m\1 4\1RM_r\1 2\1border_node_mask\1 111111\1border_node_lsize\1 2048\1"
+    "rm1_list_size\1 16";
+  int x[11], xr[11], xf[11];
+  double y[16];
+  unsigned int seed = 12345;
+
+  REQUIRE_EQ(cdc_init(config_r, &cdc_r), 0);
+  REQUIRE_EQ(cdc_init(config_f, &cdc_f), 0);
+  cdc_set_sg(cdc_r, 0.8);
+  cdc_set_csnrn(cdc_r, 0);
+  cdc_set_sg(cdc_f, 0.8);
+  cdc_set_csnrn(cdc_f, 0);
+  for (int u = 0; u < 64; u++) {
+    for (int j = 0; j < 11; j++) x[j] = ((u * 37 + 11) >> (j % 7)) & 1;
+    enc_bpsk(cdc_r, x, y);
+    for (int i = 0; i < 16; i++) {
+      seed = seed * 1103515245 + 12345;
+      y[i] += 1.6 * ((double)(seed >> 8) / (1 << 24) - 0.5);
+    }
+    dec_bpsk(cdc_r, y, xr);
+    dec_bpsk(cdc_f, y, xf);
+    for (int i = 0; i < 11; i++) REQUIRE_EQ(xf[i], xr[i]);
+  }
+  cdc_close(cdc_r);
+  cdc_close(cdc_f);
+}
+
+TEST(basic_init, cdc_init_badListThreads) {
+  void *cdc;
+  char config_zero[] = RM24_CFG "\1list_threads\1 0";
+  char config_big[] = RM24_CFG "\1list_threads\1 65";
+  char config_grp[] = RM24_CFG "\1list_threads\1 2\1permutation_groups\1 2";
+  REQUIRE_NE(cdc_init(config_zero, &cdc), 0);
+  REQUIRE_NE(cdc_init(config_big, &cdc), 0);
+  REQUIRE_NE(cdc_init(config_grp, &cdc), 0);
+}
+
+// The per-path loops split between threads: the same decisions as with one thread.
+static void list_threads_check(char *config_1, char *config_t) {
+  void *cdc_1, *cdc_t;
+  int x[42], x1[42], xt[42];
+  double y[64];
+  unsigned int seed = 12345;
+
+  REQUIRE_EQ(cdc_init(config_1, &cdc_1), 0);
+  REQUIRE_EQ(cdc_init(config_t, &cdc_t), 0);
+  REQUIRE_EQ(cdc_get_k(cdc_1), 42);
+  cdc_set_sg(cdc_1, 0.8);
+  cdc_set_csnrn(cdc_1, 0);
+  cdc_set_sg(cdc_t, 0.8);
+  cdc_set_csnrn(cdc_t, 0);
+  for (int u = 0; u < 16; u++) {
+    for (int j = 0; j < 42; j++) x[j] = ((u * 37 + 11) >> (j % 7)) & 1;
+    enc_bpsk(cdc_1, x, y);
+    for (int i = 0; i < 64; i++) {
+      seed = seed * 1103515245 + 12345;
+      y[i] += 2.0 * ((double)(seed >> 8) / (1 << 24) - 0.5);
+    }
+    dec_bpsk(cdc_1, y, x1);
+    dec_bpsk(cdc_t, y, xt);
+    for (int i = 0; i < 42; i++) REQUIRE_EQ(xt[i], x1[i]);
+  }
+  cdc_close(cdc_1);
+  cdc_close(cdc_t);
+}
+
+// RM(3, 6), L = 256: 256 * 32 LLRs at the root is above TEAM_MIN_WORK.
+#define RM36_L256_CFG \
+  "RM_m\1 6\1" \
+  "RM_r\1 3\1" \
+  "border_node_mask\1 11111111111111111111\1" \
+  "border_node_lsize\1 256"
+
+TEST(cdc_face, dec_bpsk_listThreads) {
+  char config_1[] = RM36_L256_CFG;
+  char config_t[] = RM36_L256_CFG "\1list_threads\1 4";
+  list_threads_check(config_1, config_t);
+}
+
+TEST(cdc_face, dec_bpsk_listThreadsRm1List) {
+  char config_1[] = RM36_L256_CFG "\1rm1_list_size\1 8";
+  char config_t[] = RM36_L256_CFG "\1rm1_list_size\1 8\1list_threads\1 4";
+  list_threads_check(config_1, config_t);
+}
@@ -0,0 +1,128 @@
+#include <math.h>
+#include <tau/tau.h>
+#include "../common/std_defs.h"
+#include "../formats/fast_math.h"
+
+TAU_MAIN()
+
+TEST(fast_math, exp) {
+  double x, r;
+
+  for (x = -700.0; x <= 700.0; x += 0.0137) {
+    r = fm_exp(x) / exp(x) - 1.0;
+    REQUIRE_LT(fabs(r), 1e-8);
+  }
+  REQUIRE_EQ(fm_exp(0.0), 1.0);
+  // Clamped to e^-708 and e^708.
+  REQUIRE_LT(fm_exp(-1000.0), 1e-300);
+  REQUIRE_GT(fm_exp(1000.0), 1e300);
+}
+
+TEST(fast_math, log) {
+  double x;
+
+  for (x = 1e-300; x < 1e300; x *= 1.0173) {
+    REQUIRE_LT(fabs(fm_log(x) - log(x)), 1e-9);
+  }
+  // Around 1, where m is next to the sqrt(2) border and 1 + e of eps5 lives.
+  for (x = 0.5; x < 2.0; x += 1e-4) {
+    REQUIRE_LT(fabs(fm_log(x) - log(x)), 1e-9);
+  }
+  REQUIRE_EQ(fm_log(1.0), 0.0);
+}
+
+TEST(fast_math, log1p) {
+  double x;
+
+  // Small arguments keep the relative precision.
+  for (x = 1e-20; x < 0.25; x *= 1.0173) {
+    REQUIRE_LT(fabs(fm_log1p(x) / log1p(x) - 1.0), 1e-9);
+    REQUIRE_LT(fabs(fm_log1p(-x) / log1p(-x) - 1.0), 1e-9);
+  }
+  for (x = 0.25; x < 1e10; x *= 1.0173) {
+    REQUIRE_LT(fabs(fm_log1p(x) - log1p(x)), 1e-9);
+  }
+}
+
+TEST(fast_math, log1pf) {
+  float x;
+
+  // 1 + x is rounded off in float, the result is not.
+  for (x = 1e-20f; x < 1e10f; x *= 1.0173f) {
+    REQUIRE_LT(fabs(fm_log1pf(x) / log1p(x) - 1.0), 1e-6);
+  }
+  for (x = 1e-20f; x < 0.999f; x *= 1.0173f) {
+    REQUIRE_LT(fabs(fm_log1pf(-x) / log1p(-x) - 1.0), 1e-6);
+  }
+}
+
+TEST(fast_math, expm1) {
+  double x;
+
+  // Small arguments keep the relative precision.
+  for (x = 1e-20; x < 0.25; x *= 1.0173) {
+    REQUIRE_LT(fabs(fm_expm1(x) / expm1(x) - 1.0), 1e-9);
+    REQUIRE_LT(fabs(fm_expm1(-x) / expm1(-x) - 1.0), 1e-9);
+  }
+  for (x = 0.25; x < 700.0; x += 0.0137) {
+    REQUIRE_LT(fabs(fm_expm1(-x) - expm1(-x)), 1e-8);
+  }
+  REQUIRE_EQ(fm_expm1(0.0), 0.0);
+}
+
+// ln(1 + e^-x) as in the path metrics of the LLR formats.
+TEST(fast_math, softplus) {
+  double x;
+
+  for (x = 0.0; x < 50.0; x += 0.001) {
+    REQUIRE_LT(fabs(fm_log1p(fm_exp(-x)) / log1p(exp(-x)) - 1.0), 1e-8);
+  }
+}
+
+TEST(fast_math, log_lin) {
+  double x, err, err_max = 0.0;
+
+  for (x = 1e-300; x < 1e300; x *= 1.0173) {
+    err = fabs(fm_log_lin(x) - log(x));
+    if (err > err_max) err_max = err;
+  }
+  REQUIRE_LT(err_max, 0.03);
+  // Centered: the max error is reached on both sides.
+  REQUIRE_GT(err_max, 0.029);
+  REQUIRE_LT(fabs(fm_log_lin(1.0)), 0.03);
+}
+
+// The XOR of the rho1 LLRs: 2 atanh(tanh(y1 / 2) tanh(y2 / 2)).
+// Weak estimates: 1 - e^-y has the absolute error of e^-y.
+TEST(fast_math, xor_llr) {
+  double y1, y2, r, tol;
+
+  for (y1 = -12.0; y1 < 12.0; y1 += 0.0731) {
+    for (y2 = 1e-12; y2 < 12.0; y2 *= 1.37) {
+      r = 2.0 * atanh(tanh(0.5 * y1) * tanh(0.5 * y2));
+      tol = 1e-7 * fabs(r) + 1e-15 * MAX(fabs(y1), y2);
+      REQUIRE_LT(fabs(fm_xor_llr(y1, y2) - r), tol);
+      REQUIRE_LT(fabs(fm_xor_llr(-y2, y1) + r), tol);
+      REQUIRE_EQ(fm_xor_llr(y1, y2) > 0.0, r > 0.0);
+    }
+  }
+  // No overflow for the strong estimates.
+  REQUIRE_LT(fabs(fm_xor_llr(1000.0, -1200.0) + 1000.0), 1e-9);
+  REQUIRE_LT(fabs(fm_xor_llr(-1000.0, -1000.0) - (1000.0 - log(2.0))), 1e-9);
+}
+
+TEST(fast_math, xor_llrf) {
+  float y1, y2;
+  double r;
+
+  for (y1 = -12.0f; y1 < 12.0f; y1 += 0.0731f) {
+    for (y2 = 1e-6f; y2 < 12.0f; y2 *= 1.37f) {
+      r = 2.0 * atanh(tanh(0.5 * y1) * tanh(0.5 * y2));
+      REQUIRE_LT(fabs(fm_xor_llrf(y1, y2) - r), 1e-5 * fabs(r) + 1e-7 * MAX(fabsf(y1), y2));
+      REQUIRE_EQ(fm_xor_llrf(y1, y2) > 0.0f, r > 0.0);
+    }
+  }
+  // No overflow of expf() for the strong estimates.
+  REQUIRE_LT(fabsf(fm_xor_llrf(1000.0f, -1200.0f) + 1000.0f), 1e-3f);
+  REQUIRE_LT(fabsf(fm_xor_llrf(100.0f, 100.5f) - (100.0f - logf(1.0f + expf(-0.5f)))), 1e-4f);
+}
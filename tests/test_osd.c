@@ -0,0 +1,125 @@
+#include <stdlib.h>
+#include <math.h>
+#include "../common/std_defs.h"
+#include "../common/srm_utils.h"
+#include "../interfaces/codec.h"
+#include <tau/tau.h>
+
+TAU_MAIN()
+
+static char config_rm0204_osd2[] =
+  "RM_m\1 4\1"
+  "RM_r\1 2\1"
+  "osd_order\1 2";
+
+TEST(basic_init, cdc_init_noRMr) {
+  void *cdc;
+  int rc = cdc_init("RM_m\1 4\1", &cdc);
+  REQUIRE_EQ(rc, RC_ERROR);
+}
+
+TEST(basic_init, cdc_init_badOrder) {
+  void *cdc;
+  char config[] =
+    "RM_m\1 4\1"
+    "RM_r\1 2\1"
+    "osd_order\1 -1";
+  int rc = cdc_init(config, &cdc);
+  REQUIRE_EQ(rc, RC_ERROR);
+}
+
+TEST(cdc_face, cdc_getNandK) {
+  void *cdc;
+
+  int rc = cdc_init(config_rm0204_osd2, &cdc);
+  REQUIRE_EQ(rc, RC_OK);
+  REQUIRE_EQ(cdc_get_n(cdc), 16);
+  REQUIRE_EQ(cdc_get_k(cdc), 11);
+  cdc_close(cdc);
+}
+
+TEST(cdc_face, dec_bpsk_noNoise) {
+  void *cdc;
+  int x[11], xd[11];
+  double y[16];
+  int rc;
+
+  rc = cdc_init(config_rm0204_osd2, &cdc);
+  REQUIRE_EQ(rc, RC_OK);
+
+  for (int u = 0; u < 2048; u++) {
+    for (int j = 0; j < 11; j++) x[j] = (u >> j) & 1;
+    enc_bpsk(cdc, x, y);
+    rc = dec_bpsk(cdc, y, xd);
+    REQUIRE_EQ(rc, RC_OK);
+    // The hard decision is a codeword: stops at order 0.
+    REQUIRE_EQ(cdc_get_lsiz(cdc), 1);
+    for (int i = 0; i < 11; i++) {
+      REQUIRE_EQ(xd[i], x[i]);
+    }
+  }
+  cdc_close(cdc);
+}
+
+TEST(cdc_face, dec_bpsk_withNoise_corrected) {
+  void *cdc;
+  int x[11], xd[11];
+  double y[16];
+  int rc;
+
+  rc = cdc_init(config_rm0204_osd2, &cdc);
+  REQUIRE_EQ(rc, RC_OK);
+
+  // d = 4: a single error is always corrected.
+  for (int u = 0; u < 2048; u++) {
+    for (int j = 0; j < 11; j++) x[j] = (u >> j) & 1;
+    enc_bpsk(cdc, x, y);
+    y[u % 16] = -0.5 * y[u % 16];
+    rc = dec_bpsk(cdc, y, xd);
+    REQUIRE_EQ(rc, RC_OK);
+    for (int i = 0; i < 11; i++) {
+      REQUIRE_EQ(xd[i], x[i]);
+    }
+  }
+  cdc_close(cdc);
+}
+
+// Correlation of the codeword of x with y.
+static double corr(void *cdc, int *x, double *y) {
+  double c[16], s = 0.0;
+  enc_bpsk(cdc, x, c);
+  for (int i = 0; i < 16; i++) s += c[i] * y[i];
+  return s;
+}
+
+TEST(cdc_face, dec_bpsk_fullOrderIsML) {
+  void *cdc;
+  char config[] =
+    "RM_m\1 4\1"
+    "RM_r\1 2\1"
+    "osd_order\1 8";
+  int x[11], xd[11];
+  double y[16];
+  int rc;
+
+  rc = cdc_init(config, &cdc);
+  REQUIRE_EQ(rc, RC_OK);
+
+  srand(1);
+  for (int t = 0; t < 200; t++) {
+    for (int j = 0; j < 11; j++) x[j] = rand() & 1;
+    enc_bpsk(cdc, x, y);
+    for (int i = 0; i < 16; i++) y[i] += 2.0 * ((double)rand() / RAND_MAX - 0.5);
+    rc = dec_bpsk(cdc, y, xd);
+    REQUIRE_EQ(rc, RC_OK);
+
+    // Brute force ML.
+    double s_best = -HUGE_VAL;
+    for (int u = 0; u < 2048; u++) {
+      for (int j = 0; j < 11; j++) x[j] = (u >> j) & 1;
+      s_best = MAX(s_best, corr(cdc, x, y));
+    }
+    REQUIRE_LT(fabs(corr(cdc, xd, y) - s_best), 1e-9);
+  }
+  cdc_close(cdc);
+}
@@ -0,0 +1,105 @@
+#include <stdlib.h>
+#include <math.h>
+#include "../common/srm_utils.h"
+#include "../formats/formats.h"
+#include "../rm1_ml/rm1_ml.h"
+#include <tau/tau.h>
+
+TAU_MAIN()
+
+#define M 6
+#define N (1 << M)
+
+// BPSK codeword of RM(1, M) with some noise as LLRs.
+static void noisy_llr(int *x, double *llr, int seed, double sg) {
+  int c[N];
+  srand(seed);
+  for (int i = 0; i <= M; i++) x[i] = rand() & 1;
+  mrm_enc_bsc(M, 1, x, c);
+  for (int i = 0; i < N; i++) {
+    double noise = sg * ((double)rand() / RAND_MAX - 0.5);
+    llr[i] = 2.0 * ((c[i] ? -1.0 : 1.0) + noise);
+  }
+}
+
+TEST(rm1_fht, fht_twiceIsScaledIdentity) {
+  double v[N], v0[N];
+  for (int i = 0; i < N; i++) v[i] = v0[i] = (double)((i * 37) % 11) - 5.0;
+  rm1_fht(M, v);
+  rm1_fht(M, v);
+  for (int i = 0; i < N; i++) {
+    REQUIRE_LT(fabs(v[i] - N * v0[i]), 1e-9);
+  }
+}
+
+TEST(rm1_fht, dec_fht_noNoise) {
+  int x[M + 1], xd[M + 1];
+  double llr[N];
+  for (int u = 0; u < 50; u++) {
+    noisy_llr(x, llr, u, 0.0);
+    rm1_dec_fht(M, llr, xd);
+    for (int i = 0; i <= M; i++) {
+      REQUIRE_EQ(xd[i], x[i]);
+    }
+  }
+}
+
+TEST(rm1_fht, dec_fht_sameAsTreeDecoder) {
+  int x[M + 1], xd[M + 1], xd_ref[M + 1];
+  double llr[N], y[N];
+  for (int u = 0; u < 200; u++) {
+    noisy_llr(x, llr, u, 3.0);
+    // Channel output format is ln(P(1) / P(0)).
+    for (int i = 0; i < N; i++) y[i] = -llr[i];
+    VY_TO_FORMAT(y, y, N);
+    rm1_dec_sh_finp(M, y, xd_ref);
+    rm1_dec_fht(M, llr, xd);
+    for (int i = 0; i <= M; i++) {
+      REQUIRE_EQ(xd[i], xd_ref[i]);
+    }
+  }
+}
+
+TEST(rm1_fht, dec_fht_lst_sortedAndBestFirst) {
+  int x[M + 1], xd[M + 1], xl[8 * (M + 1)];
+  double llr[N], llr2[N], sl[8], s;
+  int len;
+  for (int u = 0; u < 50; u++) {
+    noisy_llr(x, llr, u, 3.0);
+    for (int i = 0; i < N; i++) llr2[i] = llr[i];
+    s = rm1_dec_fht(M, llr, xd);
+    len = rm1_dec_fht_lst(M, llr2, 8, xl, sl);
+    REQUIRE_EQ(len, 8);
+    REQUIRE_LT(fabs(sl[0] - s), 1e-9);
+    for (int i = 0; i <= M; i++) {
+      REQUIRE_EQ(xl[i], xd[i]);
+    }
+    for (int j = 1; j < len; j++) {
+      REQUIRE_GE(sl[j - 1], sl[j]);
+    }
+  }
+}
+
+TEST(rm1_fht, dec_fht_lst_thPrefixOfList) {
+  int xl[16 * (M + 1)], xt[16 * (M + 1)];
+  double llr[N], llr2[N], sl[16], st[16], s_min;
+  int x[M + 1];
+  int len, len_t;
+  for (int u = 0; u < 50; u++) {
+    noisy_llr(x, llr, u, 3.0);
+    for (int i = 0; i < N; i++) llr2[i] = llr[i];
+    len = rm1_dec_fht_lst(M, llr, 16, xl, sl);
+    // Threshold between the 5th and 6th candidates.
+    s_min = 0.5 * (sl[4] + sl[5]);
+    len_t = rm1_dec_fht_lst_th(M, llr2, 16, s_min, xt, st);
+    REQUIRE_EQ(len, 16);
+    if (sl[4] == sl[5]) continue;
+    REQUIRE_EQ(len_t, 5);
+    for (int j = 0; j < len_t; j++) {
+      REQUIRE_EQ(st[j], sl[j]);
+    }
+  }
+  // Nothing above the threshold.
+  noisy_llr(x, llr, 0, 3.0);
+  REQUIRE_EQ(rm1_dec_fht_lst_th(M, llr, 16, 1e9, xt, st), 0);
+}
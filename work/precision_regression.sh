@@ -0,0 +1,80 @@
+#!/bin/sh
+#==============================================================================
+# Precision regression: simulates a configuration with the double, float,
+# mixed (float reliabilities, double path metrics) and fast math (double,
+# polynomial exp/log) builds of a simulator and prints the WER curves side by
+# side.
+# All the builds get the same noise (-nr), so the differences are due to the
+# precision only.
+#
+# Usage (from the work directory):
+#   ./precision_regression.sh <simulator> <config.spf> [<config.spf> ...]
+# e.g.
+#   ./precision_regression.sh ca_polar_scl_bg bg_polar10_ca11_k523_L8.spf
+#
+# CMAKE_ARGS (environment) is passed to all the builds, e.g.
+# CMAKE_ARGS="-DECC_FORMAT=rho5". The builds are kept in PREC_BUILD_DIR
+# (../_prec_build by default); results go to results/prec_<precision>_*.srf.
+#
+# Copyright 2019 and onwards Kirill Shabunov
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#==============================================================================
+
+set -e
+
+if [ $# -lt 2 ]; then
+  echo "Usage: $0 <simulator> <config.spf> [<config.spf> ...]"
+  exit 1
+fi
+
+SIM=$1
+shift
+BUILD_DIR=${PREC_BUILD_DIR:-../_prec_build}
+PRECISIONS="double float mixed fast"
+
+for p in $PRECISIONS; do
+  if [ "$p" = fast ]; then
+    args="-DECC_PRECISION=double -DFAST_MATH=ON"
+  else
+    args="-DECC_PRECISION=$p -DFAST_MATH=OFF"
+  fi
+  cmake -S .. -B "$BUILD_DIR/$p" -DCMAKE_BUILD_TYPE=Release $args $CMAKE_ARGS > /dev/null
+  cmake --build "$BUILD_DIR/$p" --target "$SIM" > /dev/null
+done
+
+# WER values of a results file, one per line.
+wer() {
+  sed -n 's/^WER {\(.*\)}/\1/p' "$1" | tr -s ' ' '\n' | sed '/^$/d'
+}
+
+for cfg in "$@"; do
+  name=$(basename "$cfg" .spf)
+  for p in $PRECISIONS; do
+    # The configuration with the results file replaced.
+    sed "s|^res_file .*|res_file results/prec_${p}_${name}.srf|" "$cfg" > "prec_${p}_${name}.spf"
+    "$BUILD_DIR/$p/$SIM" "prec_${p}_${name}.spf" -nr > /dev/null
+    rm -f "prec_${p}_${name}.spf"
+  done
+
+  echo "$name"
+  echo "  SNR      WER double  WER float   WER mixed   WER fast"
+  sed -n 's/^SNR {\(.*\)}/\1/p' "results/prec_double_${name}.srf" | tr -s ' ' '\n' | sed '/^$/d' > "prec_snr.tmp"
+  wer "results/prec_double_${name}.srf" > "prec_d.tmp"
+  wer "results/prec_float_${name}.srf" > "prec_f.tmp"
+  wer "results/prec_mixed_${name}.srf" > "prec_m.tmp"
+  wer "results/prec_fast_${name}.srf" > "prec_x.tmp"
+  paste prec_snr.tmp prec_d.tmp prec_f.tmp prec_m.tmp prec_x.tmp | \
+    awk '{printf("  %-8s %-11s %-11s %-11s %-11s\n", $1, $2, $3, $4, $5)}'
+  rm -f prec_snr.tmp prec_d.tmp prec_f.tmp prec_m.tmp prec_x.tmp
+done